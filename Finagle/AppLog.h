@@ -35,7 +35,7 @@ namespace Finagle {
 
 class AppLog {
 public:
-  AppLog( void ) : _guard() {}
+  AppLog( void ) : _guard( "AppLog" ) {}
   AppLog &operator <<( XML::Element const &msg );
   AppLog &operator +=( XML::Element const &msg );
 
@@ -19,13 +19,28 @@
 ** at http://www.gnu.org/copyleft/lesser.html .
 */
 
-#include <algorithm>  // for find()
-#include <sys/socket.h>
+#include "config.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+
+#ifdef HAVE_SYS_TIMERFD_H
+#include <sys/timerfd.h>
+#endif
 
 #include "AppLoop.h"
 #include "Timer.h"
 #include "AppLog.h"
 #include "FileDescWatcher.h"
+#include "Proactor.h"
+#include "Reactor.h"
 #include "ThreadFunc.h"
 #include "Util.h"
 
@@ -35,8 +50,12 @@ using namespace Finagle;
 /*! \namespace Finagle::AppLoop
 ** \brief Provides the main application loop.
 **
-** The application loop provides support for asynchronous file access (via FileDescWatcher and \c select(2)) as well
+** The application loop provides support for asynchronous file access (via FileDescWatcher and Reactor) as well
 ** as high-precision (i.e. video) timing via Timer.
+**
+** Each Loop owns its own watchers and timers, and is processed by a single thread, so an application may run one loop
+** per worker thread (see LoopThread).  The free functions (exec(), process(), etc.) operate on the calling thread's
+** loop, which is the main loop for any thread which isn't running a loop of its own.
 ** \sa FileDescWatcher, Timer
 */
 
@@ -46,52 +65,527 @@ namespace AppLoop {
   //! Maximum time to wait for file descriptors
   Time ProcessTime = 0.03; // Suitable for 30fps video app
 
-  //! Emitted when there are no pending alarms are file descriptors.
-  boost::signal< void() > idle;
+  //! Emitted (by the main loop) when there are no pending alarms are file descriptors.
+  boost::signal< void(), IdleSlots > idle;
 
-  bool Exit = false;
-  int  ExitCode = 0;
+} };
 
-  Thread::ID MainThreadId = Thread::self_id();
 
-} };
+static class LoopData {
+public:
+  LoopData( void ) {
+    PTHREAD_ASSERT( pthread_key_create( &threadLoop, 0 ) );
+  }
+
+  ~LoopData( void ) {
+    PTHREAD_ASSERT( pthread_key_delete( threadLoop ) );
+  }
+
+  void setCurrent( AppLoop::Loop *cur ) {
+    PTHREAD_ASSERT( pthread_setspecific( threadLoop, cur ) );
+  }
+
+  AppLoop::Loop *getCurrent( void ) {
+    return (AppLoop::Loop *) pthread_getspecific( threadLoop );
+  }
+
+public:
+  static pthread_key_t threadLoop;
+} __loopData;
+
+pthread_key_t LoopData::threadLoop;
+
+
+//! Makes a loop current for the calling thread, for the lifetime of the binding.
+class LoopBinding {
+public:
+  LoopBinding( AppLoop::Loop *loop, unsigned &running )
+  : _prev( __loopData.getCurrent() ), _running( running )
+  {
+    __loopData.setCurrent( loop );
+    _running++;
+  }
+
+  ~LoopBinding( void )
+  {
+    _running--;
+    __loopData.setCurrent( _prev );
+  }
+
+protected:
+  AppLoop::Loop *_prev;
+  unsigned &_running;
+};
+
+
+/*! \brief Wakes a loop from another thread, via an \c eventfd(2) (or a pipe, where unavailable).
+**
+** Writes are coalesced by the kernel, so any number of wake() calls before the loop next waits cost one wakeup.
+*/
+class AppLoop::Loop::Waker : public FileDescWatchable {
+public:
+  Waker( Loop &loop );
+ ~Waker( void );
+
+  void wake( void ) const;
+
+protected:
+  int      watchFD( void ) const;
+  unsigned watchEvents( void ) const;
+  void     onEvents( unsigned events ) const;
+
+protected:
+  int _readFD, _writeFD;
+};
+
+
+AppLoop::Loop::Waker::Waker( Loop &loop )
+: FileDescWatchable( loop ), _readFD( -1 ), _writeFD( -1 )
+{
+#ifdef HAVE_SYS_EVENTFD_H
+  _readFD = _writeFD = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+  if ( _readFD == -1 )
+    LOG_WARN << "Unable to create eventfd, falling back to a pipe: " << SystemEx::sysErrStr();
+#endif
+
+  if ( _readFD == -1 ) {
+    int fds[2];
+    if ( pipe( fds ) == -1 ) {
+      LOG_ERROR << "Unable to create loop wakeup pipe: " << SystemEx::sysErrStr();
+      return;
+    }
+
+    for ( unsigned i = 0; i < 2; ++i ) {
+      fcntl( fds[i], F_SETFL, fcntl( fds[i], F_GETFL ) | O_NONBLOCK );
+      fcntl( fds[i], F_SETFD, FD_CLOEXEC );
+    }
+
+    _readFD = fds[0];
+    _writeFD = fds[1];
+  }
+
+  enable();
+}
+
+
+AppLoop::Loop::Waker::~Waker( void )
+{
+  disable();
+
+  if ( _writeFD != _readFD )
+    ::close( _writeFD );
+  if ( _readFD != -1 )
+    ::close( _readFD );
+}
+
+
+//! Makes the wakeup descriptor readable (may be called from any thread).
+void AppLoop::Loop::Waker::wake( void ) const
+{
+#ifdef HAVE_SYS_EVENTFD_H
+  if ( _writeFD == _readFD ) {
+    eventfd_write( _writeFD, 1 );
+    return;
+  }
+#endif
+
+  // A full pipe is already readable, so EAGAIN is fine here.
+  char c = 0;
+  while ( (::write( _writeFD, &c, 1 ) == -1) && (errno == EINTR) )
+    ;
+}
+
+
+int AppLoop::Loop::Waker::watchFD( void ) const
+{
+  return _readFD;
+}
+
+
+unsigned AppLoop::Loop::Waker::watchEvents( void ) const
+{
+  return Read;
+}
+
+
+//! Resets the wakeup descriptor, then runs the loop's posted tasks.
+void AppLoop::Loop::Waker::onEvents( unsigned ) const
+{
+#ifdef HAVE_SYS_EVENTFD_H
+  if ( _writeFD == _readFD ) {
+    eventfd_t count;
+    eventfd_read( _readFD, &count );
+  } else
+#endif
+  {
+    char buf[256];
+    while ( ::read( _readFD, buf, sizeof(buf) ) > 0 )
+      ;
+  }
+
+  _loop->runPosted();
+}
+
+
+/*! \brief Wakes a loop exactly when its next timer is due, via a \c timerfd(2).
+**
+** The reactor's timeout only has millisecond resolution (and is rounded up, so that it never wakes early), so on its
+** own the loop could oversleep a timer by up to a millisecond.  The deadline is only re-armed when it changes.
+*/
+class AppLoop::Loop::Deadline : public FileDescWatchable {
+public:
+  Deadline( Loop &loop );
+ ~Deadline( void );
+
+  bool valid( void ) const;
+  void arm( Time alarm );
+  void disarm( void );
+
+protected:
+  int      watchFD( void ) const;
+  unsigned watchEvents( void ) const;
+  void     onEvents( unsigned events ) const;
+
+protected:
+  int _fd;
+  mutable Time _armed;
+};
+
+
+AppLoop::Loop::Deadline::Deadline( Loop &loop )
+: FileDescWatchable( loop ), _fd( -1 )
+{
+#ifdef HAVE_SYS_TIMERFD_H
+  // Time::now() is the real-time clock
+  _fd = timerfd_create( CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC );
+  if ( _fd == -1 ) {
+    LOG_WARN << "Unable to create timerfd, timers may fire up to 1 ms late: " << SystemEx::sysErrStr();
+    return;
+  }
+
+  enable();
+#endif
+}
+
+
+AppLoop::Loop::Deadline::~Deadline( void )
+{
+  disable();
+
+  if ( _fd != -1 )
+    ::close( _fd );
+}
+
+
+//! Returns \c true if the deadline timer is available.
+bool AppLoop::Loop::Deadline::valid( void ) const
+{
+  return _fd != -1;
+}
+
+
+//! Makes the descriptor readable at (absolute) time \a alarm.
+void AppLoop::Loop::Deadline::arm( Time alarm )
+{
+#ifdef HAVE_SYS_TIMERFD_H
+  if ( alarm == _armed )
+    return;
+
+  itimerspec spec;
+  memset( &spec, 0, sizeof(spec) );
+  spec.it_value.tv_sec = time_t( alarm );
+  spec.it_value.tv_nsec = long( (alarm - double( spec.it_value.tv_sec )) * 1e9 );
+  if ( !spec.it_value.tv_sec && !spec.it_value.tv_nsec )
+    spec.it_value.tv_nsec = 1;
+
+  if ( timerfd_settime( _fd, TFD_TIMER_ABSTIME, &spec, 0 ) == -1 ) {
+    LOG_ERROR << "Error in timerfd_settime(2): " << SystemEx::sysErrStr();
+    return;
+  }
+
+  _armed = alarm;
+#endif
+}
+
+
+//! Cancels the deadline, if it's armed.
+void AppLoop::Loop::Deadline::disarm( void )
+{
+#ifdef HAVE_SYS_TIMERFD_H
+  if ( !_armed.isValid() )
+    return;
+
+  itimerspec spec;
+  memset( &spec, 0, sizeof(spec) );
+  timerfd_settime( _fd, 0, &spec, 0 );
+  _armed = 0.0;
+#endif
+}
+
+
+int AppLoop::Loop::Deadline::watchFD( void ) const
+{
+  return _fd;
+}
+
+
+unsigned AppLoop::Loop::Deadline::watchEvents( void ) const
+{
+  return Read;
+}
+
+
+//! Resets the expired deadline (the loop then triggers the due timers).
+void AppLoop::Loop::Deadline::onEvents( unsigned ) const
+{
+  uint64_t expirations;
+  while ( (::read( _fd, &expirations, sizeof(expirations) ) == -1) && (errno == EINTR) )
+    ;
+
+  _armed = 0.0;
+}
+
+
+/*! \class Finagle::AppLoop::Loop
+** \brief An application loop, with its own watchers and timers.
+**
+** A loop belongs to the thread which created it, until it's processed (via exec(), process() or wait()) by another.
+** While a loop is being processed, it's the current() loop for that thread, so Timers and FileDescWatchers created by
+** its handlers are bound to it.
+**
+** Watchers and timers must only be manipulated by the loop's own thread.  To hand a watcher to another loop, use
+** FileDescWatchable::moveTo() (which calls adopt()).  To run code on the loop's thread (e.g. to deliver a worker
+** thread's results), use post(), which wakes the loop immediately rather than on its next ProcessTime poll.
+**
+** \sa LoopThread, Timer and FileDescWatcher.
+*/
+
+//! Creates a loop, belonging to the calling thread.
+AppLoop::Loop::Loop( void )
+: _waker( 0 ), _deadline( 0 ), _proactor( 0 ), _clock( &Clock::system() ), _exit( false ), _exitCode( 0 ),
+  _threadId( Thread::self_id() ), _running( 0 ), _instrumented( false ), _load( 0 )
+{
+  _waker = new Waker( *this );
+  _waker->ref();
+
+  _deadline = new Deadline( *this );
+  _deadline->ref();
+  if ( !_deadline->valid() ) {
+    if ( _deadline->deref() )
+      delete _deadline;
+    _deadline = 0;
+  }
+}
+
+
+//! Releases any watchables still waiting to be adopted (and discards any posted tasks and outstanding I/O).
+AppLoop::Loop::~Loop( void )
+{
+  delete _proactor;
+  _proactor = 0;
+
+  if ( _waker->deref() )
+    delete _waker;
+  _waker = 0;
+
+  if ( _deadline && _deadline->deref() )
+    delete _deadline;
+  _deadline = 0;
+
+  Lock lock( _pendingLock );
+  for ( Array<FileDescWatchable const *>::ConstIterator i = _pending.begin(); i != _pending.end(); ++i ) {
+    if ( (*i)->deref() )
+      delete *i;
+  }
+  _pending.clear();
+}
+
+
+//! Returns the main (default) loop.
+AppLoop::Loop &AppLoop::Loop::main( void )
+{
+  return MainLoop();
+}
+
 
+//! Returns the loop being processed by the calling thread (or the main loop, if there is none).
+AppLoop::Loop &AppLoop::Loop::current( void )
+{
+  Loop *loop = __loopData.getCurrent();
+  return loop ? *loop : main();
+}
 
-/*! \fn int Finagle::AppLoop::exec( void )
-** Runs the application loop.
+
+/*! \brief Runs the loop until exit() is called.
 **
-** Returns the \a ExitCode.
-** \sa exit().
+** Returns the \a exitCode passed to exit().
 */
-int AppLoop::exec( void )
+int AppLoop::Loop::exec( void )
 {
-  Exit = false;
-  ExitCode = 0;
+  _exit = false;
+  _exitCode = 0;
 
-  while ( !Exit )
+  while ( !_exit )
     process( ProcessTime );
 
-  return ExitCode;
+  return _exitCode;
 }
 
 
-void AppLoop::wait( Time wait )
+//! Processes the loop for \a wait seconds if it belongs to the calling thread (otherwise just sleeps).
+void AppLoop::Loop::wait( Time wait )
 {
-  if ( Thread::self_id() == MainThreadId )
+  if ( isCurrent() )
     process( wait );
   else
     sleep( wait );
 }
 
 
-void AppLoop::exit( int exitCode )
+//! Causes exec() to return \a exitCode (may be called from any thread).
+void AppLoop::Loop::exit( int exitCode )
 {
-  AppLoop::ExitCode = exitCode;
-  AppLoop::Exit = true;
+  _exitCode = exitCode;
+  __sync_synchronize();  // publish the code before the flag
+  _exit = true;
+
+  if ( !isCurrent() )
+    wake();
 }
 
 
-/*! \fn void Finagle::AppLoop::process( Time )
+/*! \brief Makes the loop (and its timers) read the time from \a clock.
+**
+** With a VirtualClock, the loop runs in simulated time: instead of blocking until its next timer is due (or until
+** process() should return), it polls its watchers and advances the clock.  The clock may only be changed while no
+** timers are scheduled.
+*/
+void AppLoop::Loop::setClock( Clock &clock )
+{
+  if ( !_timers.empty() ) {
+    LOG_ERROR << "Unable to change the clock of a loop with scheduled timers";
+    return;
+  }
+
+  _clock = &clock;
+  _timers.reset( clock.now() );
+}
+
+
+/*! \brief Returns the loop's Proactor, for completion-based I/O (creating it on first use).
+**
+** Uses \c io_uring(7) if the kernel supports it, or the loop's own watchers otherwise.  Must be called from the loop's
+** thread.
+*/
+Proactor &AppLoop::Loop::io( void )
+{
+  if ( !_proactor )
+    _proactor = new Proactor( *this );
+
+  return *_proactor;
+}
+
+
+//! Submits the I/O queued by each of the loop's proactors.
+void AppLoop::Loop::flushIO( void )
+{
+  for ( Array<Proactor *>::Iterator i = _proactors.begin(); i != _proactors.end(); ++i )
+    (*i)->flush();
+}
+
+
+//! Returns the (approximate) number of watchers registered with, or waiting to be adopted by, this loop.
+unsigned AppLoop::Loop::load( void )
+{
+  Lock lock( _pendingLock );
+  return _load + _pending.size();
+}
+
+
+/*! \brief Enables (or disables) collection of the loop's stats().
+**
+** While enabled, notifications which take longer than \a slowThreshold seconds (if non-zero) are logged.  While
+** disabled, the loop's only overhead is a flag test per iteration.
+*/
+void AppLoop::Loop::instrument( bool enable, Time slowThreshold )
+{
+  _instrumented = enable;
+  _stats.slowThreshold = slowThreshold;
+}
+
+
+/*! \brief Runs \a task on the loop's thread, as soon as possible (may be called from any thread).
+**
+** Tasks run in the order in which they were posted.  Posting doesn't lock; only the first task posted since the loop
+** last ran its tasks wakes the loop, so bursts of posts are handled in a single batch.
+*/
+void AppLoop::Loop::post( Task const &task )
+{
+  if ( _posted.push( task ) )
+    wake();
+}
+
+
+//! Interrupts the loop's wait for events, if it's waiting (may be called from any thread).
+void AppLoop::Loop::wake( void )
+{
+  _waker->wake();
+}
+
+
+//! Runs the tasks posted since the last call.
+void AppLoop::Loop::runPosted( void )
+{
+  Array<Task> tasks;
+  _posted.popAll( tasks );
+
+  for ( Array<Task>::Iterator t = tasks.begin(); t != tasks.end(); ++t )
+    (*t)();
+}
+
+
+/*! \brief Hands \a watchable to this loop, which enables it on its next iteration (may be called from any thread).
+**
+** The loop holds a reference to \a watchable until then.
+*/
+void AppLoop::Loop::adopt( FileDescWatchable const *watchable )
+{
+  {
+    Lock lock( _pendingLock );
+    watchable->ref();
+    _pending.push_back( watchable );
+  }
+
+  wake();
+}
+
+
+//! Binds and enables any watchables handed over by adopt().
+void AppLoop::Loop::adoptPending( void )
+{
+  Array<FileDescWatchable const *> pending;
+  {
+    Lock lock( _pendingLock );
+    // Not counting the waker and deadline (if they could be registered)
+    _load = _watchers.size() - (_watchers.contains( _waker ) ? 1 : 0) -
+            ((_deadline && _watchers.contains( _deadline )) ? 1 : 0);
+    if ( _pending.empty() )
+      return;
+
+    pending.swap( _pending );
+  }
+
+  for ( Array<FileDescWatchable const *>::ConstIterator i = pending.begin(); i != pending.end(); ++i ) {
+    (*i)->_loop = this;
+    (*i)->enable();
+
+    if ( (*i)->deref() )
+      delete *i;
+  }
+}
+
+
+/*! \fn void Finagle::AppLoop::Loop::process( Time )
 ** Processes a single iteration of the application loop.
 **
 ** This does the grunt work of processing the application loop.  It handles
@@ -99,102 +593,127 @@ void AppLoop::exit( int exitCode )
 ** after \a maxTime seconds.
 ** \sa Timer and FileDescWatcher.
 */
-void AppLoop::process( Time maxTime )
+void AppLoop::Loop::process( Time maxTime )
 {
-  Time startTime = Time::now();
+  if ( !isCurrent() ) {
+    _threadId = Thread::self_id();
+    __sync_synchronize();
+  }
+  LoopBinding binding( this, _running );
+
+  Time endTime = _clock->now() + maxTime;
 
   while ( true ) {
-    if ( Exit )
+    if ( _exit )
       return;
 
-    Time Now = Time::now();
+    adoptPending();
 
-    Timer::Ptr NextTimer = 0;
+    LoopStats *stats = _instrumented ? &_stats : 0;
+    if ( stats )
+      stats->iterations++;
 
-    // Make sure any pending alarms get triggered immediately
-    while ( !Timers().empty() && (NextTimer = Timers().front()) ) {
-      if ( NextTimer->nextAlarm() > Now )
-        break;
+    Time Now = _clock->now();
 
-      NextTimer->trigger();
-      if ( Exit )
-        return;
-    }
+    // Make sure any pending alarms get triggered immediately
+    if ( !_timers.trigger( Now, _exit, stats ) )
+      return;
 
     // Is there an alarm within the processing interval?
-    if ( NextTimer && ((NextTimer->nextAlarm() - Now) > maxTime) )
-      NextTimer = 0;
-
-    // Run select() on file description watchers
-    fd_set ReadFDs, WriteFDs, ExceptFDs;
-    FD_ZERO( &ReadFDs );
-    FD_ZERO( &WriteFDs );
-    FD_ZERO( &ExceptFDs );
-
-    Set<FileDescWatchable const *> active;
-    int maxFD = -1;
-    for ( Set<FileDescWatchable const *>::ConstIterator i = FileDescWatchable::Active.begin(); i != FileDescWatchable::Active.end(); ++i ) {
-      int fd = (*i)->fds( ReadFDs, WriteFDs, ExceptFDs );
-      if ( fd == -1 )
-        continue;
-
-      maxFD = max( maxFD, fd );
-      active.insert( *i );
+    Time Remaining = (endTime > Now) ? (endTime - Now) : 0.0;
+    Time NextAlarm = _timers.nextAlarm();
+    if ( NextAlarm.isValid() && ((NextAlarm - Now) > Remaining) )
+      NextAlarm = 0;
+
+    // Submit any I/O queued since the last iteration
+    flushIO();
+
+    // First, poll watchers to see if there's anything waiting (no timeout).
+    int res = _watchers.wait( 0.0 );
+    if ( res == -1 ) {
+      LOG_ERROR << "Error waiting for file descriptors: " << SystemEx::sysErrStr();
+      return;
     }
 
-    // First, poll sockets to see if there's anything waiting (no timeout).
-    int res = 0;
-    if ( maxFD != -1 ) {
-      timeval Timeout = { 0, 0 };
-      res = select( (int) maxFD + 1, &ReadFDs, &WriteFDs, &ExceptFDs, &Timeout );
+    // Nothing ready, so run idle handlers and wait again
+    if ( res == 0 ) {
+      Time idleStart = stats ? Time::now() : Time();
+      idle();
+      if ( this == &main() )
+        AppLoop::idle();
+      _idleTasks.run( stats );
+      if ( stats )
+        stats->idle( idleStart );
+
+      // The idle handlers may have queued I/O
+      flushIO();
+
+      // Now wait with timeout <= time until next timer alarm
+      double WaitTime = NextAlarm.isValid() ? (NextAlarm - Now) : (double) Remaining;
+      Time waitStart = stats ? Time::now() : Time();
+      Time block = _clock->elapse( WaitTime );
+      if ( _deadline ) {
+        if ( NextAlarm.isValid() && (block > 0.0) )
+          _deadline->arm( NextAlarm );
+        else
+          _deadline->disarm();
+      }
 
+      res = _watchers.wait( block );
+      if ( stats )
+        stats->wait.add( Time::now() - waitStart );
       if ( res == -1 ) {
-        LOG_ERROR << "Error in select(2): " << SystemEx::sysErrStr();
+        LOG_ERROR << "Error waiting for file descriptors: " << SystemEx::sysErrStr();
         return;
       }
     }
 
-    // No sockets ready, so run idle handlers and select again
     if ( res == 0 ) {
-      idle();
-
-      // Now poll/sleep with timeout <= time until next timer alarm
-      double WaitTime = NextTimer ? (NextTimer->nextAlarm() - Now) : (double) maxTime;
-      if ( maxFD != -1 ) {
-        timeval Timeout = { unsigned( WaitTime ), unsigned( (WaitTime - unsigned( WaitTime )) * 1000000.0 ) };
-        res = select( (int) maxFD + 1, &ReadFDs, &WriteFDs, &ExceptFDs, &Timeout );
-
-        if ( res == -1 ) {
-          LOG_ERROR << "Error in select(2): " << SystemEx::sysErrStr();
-          return;
-        }
-      } else
-        sleep( WaitTime );
-    }
-
-    if ( res == 0 ) {
-      // Still no result.  Check timer and exit flag
-      if ( NextTimer ) {
-        NextTimer->trigger();
-        NextTimer = 0;
-
-        if ( Exit )
-          return;
-      }
+      // Still no result.  Check timers and exit flag
+      if ( NextAlarm.isValid() && !_timers.trigger( _clock->now(), _exit, stats ) )
+        return;
     } else {
-      // Examine select() results and notify appropriate FileDescWatchables.
-      for ( Set<FileDescWatchable const *>::Iterator i = active.begin(); i != active.end(); ++i ) {
-        FileDescWatchable::ConstPtr w = *i;
-        w->onSelect( ReadFDs, WriteFDs, ExceptFDs );
-
-        if ( Exit )
-          return;
-      }
+      // Notify only those watchers which are ready.
+      if ( !_watchers.dispatch( _exit, stats ) )
+        return;
     }
 
     // Have we processed enough, or should we quit?
-    maxTime -= (Now - startTime);
-    if ( (double) maxTime <= 0.0 )
+    if ( _clock->now() >= endTime )
       break;
   }
 }
+
+
+/*! \class Finagle::AppLoop::LoopThread
+** \brief A Thread which runs its own application Loop, until stopped or the loop exits.
+**
+** Example: \code
+** AppLoop::LoopThread worker;
+** worker.start();
+** socket->moveTo( worker.loop() );
+** \endcode
+**
+** To run one loop per core, start each with Thread::Options::forCore().
+*/
+
+//! Stops the loop and waits for the thread to exit.
+AppLoop::LoopThread::~LoopThread( void )
+{
+  _loop.exit();
+  stop();
+}
+
+
+int AppLoop::LoopThread::exec( void )
+{
+  _loop._threadId = Thread::self_id();
+  __sync_synchronize();
+  _loop._exit = false;
+  _loop._exitCode = 0;
+
+  while ( running() && !_loop._exit )
+    _loop.process( ProcessTime );
+
+  return _loop._exitCode;
+}
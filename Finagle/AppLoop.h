@@ -22,18 +22,270 @@
 #ifndef FINAGLE_APPLOOP_H
 #define FINAGLE_APPLOOP_H
 
+#include <boost/function.hpp>
 #include <boost/signals.hpp>
+#include <Finagle/Array.h>
+#include <Finagle/Clock.h>
 #include <Finagle/DateTime.h>
+#include <Finagle/IdleScheduler.h>
+#include <Finagle/LoopStats.h>
+#include <Finagle/MPSCQueue.h>
+#include <Finagle/Mutex.h>
+#include <Finagle/Reactor.h>
+#include <Finagle/Singleton.h>
+#include <Finagle/Thread.h>
+#include <Finagle/TimerWheel.h>
 
 namespace Finagle {
+
+class FileDescWatchable;
+class Proactor;
+
 namespace AppLoop {
 
-  extern boost::signal< void() > idle;
+  //! Combiner for the idle signals, which times each slot while the current loop is instrumented (see LoopStats::idleSlots)
+  struct IdleSlots {
+    typedef void result_type;
+
+    template <typename InputIterator>
+    void operator()( InputIterator first, InputIterator last ) const;
+  };
+
+  extern Time ProcessTime;
+  extern boost::signal< void(), IdleSlots > idle;
+
+  //! A unit of work posted to a loop (see Loop::post())
+  typedef boost::function< void() > Task;
+
+  //! An application loop: a set of watchers and timers, processed by a single thread.
+  class Loop {
+  public:
+    Loop( void );
+   ~Loop( void );
+
+    static Loop &main( void );
+    static Loop &current( void );
+
+    int  exec( void );
+    void process( Time maxTime = 0.0 );
+    void wait( Time wait = 0.1 );
+    void exit( int exitCode = 0 );
+
+    bool running( void ) const;
+    bool isCurrent( void ) const;
+    unsigned load( void );
+
+    Reactor &watchers( void );
+    TimerWheel &timers( void );
+    IdleScheduler &idleTasks( void );
+    Proactor &io( void );
+
+    Clock &clock( void ) const;
+    void setClock( Clock &clock );
+
+    void instrument( bool enable = true, Time slowThreshold = 0.0 );
+    bool instrumented( void ) const;
+    LoopStats const &stats( void ) const;
+    void resetStats( void );
+
+    void adopt( FileDescWatchable const *watchable );
+    void post( Task const &task );
+    void wake( void );
+
+  public:
+    boost::signal< void(), IdleSlots > idle;  //!< Emitted when there are no pending alarms or file descriptors (see also idleTasks()).
+
+  protected:
+    class Waker;
+    class Deadline;
+
+    void adoptPending( void );
+    void runPosted( void );
+    LoopStats *recording( void );
+    void flushIO( void );
+
+  protected:
+    Reactor _watchers;
+    TimerWheel _timers;
+    IdleScheduler _idleTasks;
+    MPSCQueue<Task> _posted;
+    Waker *_waker;
+    Deadline *_deadline;
+    Proactor *_proactor;
+    Array<Proactor *> _proactors;
+    Clock *_clock;
+
+    bool volatile _exit;          //!< Set (by any thread) by exit()
+    int  volatile _exitCode;
+    Thread::ID volatile _threadId;  //!< The thread processing the loop (\c 0 for a LoopThread's loop, until it starts)
+    unsigned _running;
+
+    bool _instrumented;
+    LoopStats _stats;
+
+    Mutex _pendingLock;
+    Array<FileDescWatchable const *> _pending;
+    unsigned _load;
+
+    friend class LoopThread;
+    friend class Finagle::Proactor;
+    friend struct IdleSlots;
+  };
+
+  //! A Thread which runs its own application Loop.
+  class LoopThread : public Thread {
+  public:
+    LoopThread( void ) {  _loop._threadId = 0;  }
+    LoopThread( Thread::Options const &options ) : Thread( options ) {  _loop._threadId = 0;  }
+   ~LoopThread( void );
+
+    Loop &loop( void );
+
+  protected:
+    int exec( void );
+
+  protected:
+    Loop _loop;
+  };
 
   int  exec( void );
   void process( Time MaxTime = 0.0 );
   void wait( Time Wait = 0.1 );
   void exit( int ExitCode = 0 );
+  void post( Task const &task );
+
+  Reactor &Watchers( void );
+  TimerWheel &Timers( void );
+
+  static Singleton<Loop> MainLoop;
+
+// INLINE/TEMPLATE IMPLEMENTATION *************************************************************************************************
+
+  //! Calls each slot in [\a first, \a last), timing each one if the current loop is instrumented.
+  template <typename InputIterator>
+  void IdleSlots::operator()( InputIterator first, InputIterator last ) const
+  {
+    LoopStats *stats = Loop::current().recording();
+    for ( ; first != last; ++first ) {
+      if ( !stats ) {
+        *first;
+        continue;
+      }
+
+      Time start = Time::now();
+      *first;
+      stats->idleSlot( start );
+    }
+  }
+
+
+  //! Returns \c true iff the loop is being processed (by any thread).
+  inline bool Loop::running( void ) const
+  {
+    return _running != 0;
+  }
+
+  //! Returns \c true iff the loop belongs to the calling thread.
+  inline bool Loop::isCurrent( void ) const
+  {
+    return pthread_equal( _threadId, Thread::self_id() );
+  }
+
+  //! Returns the watchers registered with this loop.
+  inline Reactor &Loop::watchers( void )
+  {
+    return _watchers;
+  }
+
+  //! Returns the timers scheduled on this loop.
+  inline TimerWheel &Loop::timers( void )
+  {
+    return _timers;
+  }
+
+  //! Returns the background tasks run (within a time budget) while the loop is idle.
+  inline IdleScheduler &Loop::idleTasks( void )
+  {
+    return _idleTasks;
+  }
+
+  //! Returns the clock from which the loop (and its timers) read the time.
+  inline Clock &Loop::clock( void ) const
+  {
+    return *_clock;
+  }
+
+  //! Returns \c true iff the loop is collecting stats().
+  inline bool Loop::instrumented( void ) const
+  {
+    return _instrumented;
+  }
+
+  //! Returns the loop's latency and stall counters (only collected while instrumented()).
+  inline LoopStats const &Loop::stats( void ) const
+  {
+    return _stats;
+  }
+
+  //! Returns the counters to record into, or \c 0 if the loop isn't instrumented.
+  inline LoopStats *Loop::recording( void )
+  {
+    return _instrumented ? &_stats : 0;
+  }
+
+  //! Clears the loop's counters.
+  inline void Loop::resetStats( void )
+  {
+    _stats.reset();
+  }
+
+  //! Returns the thread's loop.
+  inline Loop &LoopThread::loop( void )
+  {
+    return _loop;
+  }
+
+  //! Runs the current loop (see Loop::exec()).
+  inline int exec( void )
+  {
+    return Loop::current().exec();
+  }
+
+  //! Processes a single iteration of the current loop (see Loop::process()).
+  inline void process( Time maxTime )
+  {
+    Loop::current().process( maxTime );
+  }
+
+  //! Processes the current loop for \a wait seconds (see Loop::wait()).
+  inline void wait( Time wait )
+  {
+    Loop::current().wait( wait );
+  }
+
+  //! Causes the current loop to exit, returning \a exitCode (see Loop::exit()).
+  inline void exit( int exitCode )
+  {
+    Loop::current().exit( exitCode );
+  }
+
+  //! Posts \a task to the current loop (see Loop::post()).
+  inline void post( Task const &task )
+  {
+    Loop::current().post( task );
+  }
+
+  //! Returns the watchers registered with the current loop.
+  inline Reactor &Watchers( void )
+  {
+    return Loop::current().watchers();
+  }
+
+  //! Returns the timers scheduled on the current loop.
+  inline TimerWheel &Timers( void )
+  {
+    return Loop::current().timers();
+  }
 
 } };
 
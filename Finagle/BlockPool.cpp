@@ -0,0 +1,74 @@
+/*!
+** \file BlockPool.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Sat Oct 17 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+
+#include <new>
+
+#include "BlockPool.h"
+#include "SpinMutex.h"
+
+using namespace std;
+using namespace Finagle;
+
+//! A recycled block
+static struct FreeBlock {
+  FreeBlock *next;
+} *FreeBlocks[BlockPool::Sizes];
+
+static SpinMutex FreeLock;  // held only to push or pop a block
+
+
+//! Allocates \a size bytes from the pool.
+void *BlockPool::allocate( size_t size )
+{
+  size_t bucket = (size - 1) / Grain;
+  if ( bucket >= Sizes )
+    return ::operator new( size );
+
+  {
+    SpinLock lock( FreeLock );
+    if ( FreeBlock *block = FreeBlocks[bucket] ) {
+      FreeBlocks[bucket] = block->next;
+      return block;
+    }
+  }
+
+  return ::operator new( (bucket + 1) * Grain );
+}
+
+//! Returns \a ptr (allocated for \a size bytes) to the pool.
+void BlockPool::release( void *ptr, size_t size )
+{
+  if ( !ptr )
+    return;
+
+  size_t bucket = (size - 1) / Grain;
+  if ( bucket >= Sizes ) {
+    ::operator delete( ptr );
+    return;
+  }
+
+  FreeBlock *block = (FreeBlock *) ptr;
+  SpinLock lock( FreeLock );
+  block->next = FreeBlocks[bucket];
+  FreeBlocks[bucket] = block;
+}
@@ -0,0 +1,53 @@
+/*!
+** \file BlockPool.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Sat Oct 17 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#ifndef FINAGLE_BLOCKPOOL_H
+#define FINAGLE_BLOCKPOOL_H
+
+#include <cstddef>
+
+namespace Finagle {
+
+/*! \brief Recycles the memory of small objects which are created and destroyed at a high rate (e.g. shared future
+** state, and coroutines).
+**
+** Blocks are kept on a free list per size class (a multiple of #Grain bytes), shared by all threads; larger blocks are
+** allocated and freed directly.  Memory is never returned to the system, so the pool holds as many blocks of each size
+** as were ever in use at once.  A class opts in via its own \c operator \c new and \c operator \c delete:
+** \code
+** static void *operator new( size_t size ) {  return BlockPool::allocate( size );  }
+** static void  operator delete( void *ptr, size_t size ) {  BlockPool::release( ptr, size );  }
+** \endcode
+*/
+class BlockPool {
+public:
+  static const size_t Grain = 32;  //!< Granularity of the pooled block sizes
+  static const size_t Sizes = 32;  //!< Number of pooled block sizes
+
+public:
+  static void *allocate( size_t size );
+  static void  release( void *ptr, size_t size );
+};
+
+}
+
+#endif
@@ -0,0 +1,53 @@
+/*!
+** \file Clock.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include "Clock.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::Clock
+** \brief Source of the current time for application loops, Timers and Velocimeters.
+**
+** Each AppLoop::Loop reads the time from its clock (by default, the system clock), as do the Timers scheduled on it.
+** Giving a loop a VirtualClock (see AppLoop::Loop::setClock()) runs it in simulated time: rather than blocking until
+** the next timer is due, the loop advances the clock straight to it.  Whole workloads of timers and rate meters then
+** run at CPU speed, with repeatable results, which makes for fast, deterministic tests and benchmarks.
+**
+** Durations which measure the CPU itself (e.g. LoopStats callback times) always use the system clock.
+*/
+
+/*! \class Finagle::VirtualClock
+** \brief A simulated clock.
+**
+** A virtual clock only moves when it's set() or advance()d, or when a loop using it would otherwise block (see
+** elapse()).  It isn't thread-safe, so should only be used by a single loop (and its thread).
+*/
+
+const double VirtualClock::Epoch = 1000000.0;
+
+
+//! Returns the system's real-time clock.
+Clock &Clock::system( void )
+{
+  static SystemClock clock;
+  return clock;
+}
@@ -0,0 +1,114 @@
+/*!
+** \file Clock.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#ifndef FINAGLE_CLOCK_H
+#define FINAGLE_CLOCK_H
+
+#include <Finagle/DateTime.h>
+
+namespace Finagle {
+
+//! Source of the current time for application loops, Timers and Velocimeters.
+class Clock {
+public:
+  virtual ~Clock( void ) {}
+
+  //! Returns the current time.
+  virtual Time now( void ) const = 0;
+
+  //! Lets \a timeout seconds pass while waiting; returns how long the caller should actually block.
+  virtual Time elapse( Time timeout ) = 0;
+
+  static Clock &system( void );
+};
+
+//! The system's real-time clock
+class SystemClock : public Clock {
+public:
+  Time now( void ) const;
+  Time elapse( Time timeout );
+};
+
+//! A simulated clock, which only moves when it's told to (or when a loop using it would otherwise wait).
+class VirtualClock : public Clock {
+public:
+  static const double Epoch;  //!< Default starting time
+
+public:
+  VirtualClock( Time start = Epoch );
+
+  Time now( void ) const;
+  Time elapse( Time timeout );
+
+  void set( Time now );
+  void advance( Time secs );
+
+protected:
+  Time _now;
+};
+
+// INLINE IMPLEMENTATION **********************************************************************************************************
+
+inline Time SystemClock::now( void ) const
+{
+  return Time::now();
+}
+
+//! Waiting takes real time, so the caller blocks for the full \a timeout.
+inline Time SystemClock::elapse( Time timeout )
+{
+  return timeout;
+}
+
+
+//! Creates a virtual clock, starting at time \a start.
+inline VirtualClock::VirtualClock( Time start )
+: _now( start )
+{}
+
+inline Time VirtualClock::now( void ) const
+{
+  return _now;
+}
+
+//! Advances the clock by \a timeout seconds, so that the caller needn't block at all.
+inline Time VirtualClock::elapse( Time timeout )
+{
+  advance( timeout );
+  return 0.0;
+}
+
+//! Sets the current time to \a now.
+inline void VirtualClock::set( Time now )
+{
+  _now = now;
+}
+
+//! Moves the clock forward by \a secs seconds.
+inline void VirtualClock::advance( Time secs )
+{
+  if ( secs > 0.0 )
+    _now += secs;
+}
+
+}
+
+#endif
@@ -0,0 +1,222 @@
+/*!
+** \file Coroutine.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include <boost/bind.hpp>
+
+#include "Coroutine.h"
+#include "FileDescWatcher.h"
+#include "Proactor.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::Coroutine
+** \brief A stackless coroutine, resumed by its application loop as each awaited operation completes.
+**
+** Protocol code which would otherwise be a chain of callbacks can instead be written as a single run() method, which
+** suspends at each CO_AWAIT until the awaited operation completes, and is then resumed (by the loop's thread) just
+** after it:
+** \code
+** class Echo : public Coroutine {
+** public:
+**   Echo( Socket::Ptr sock ) : _sock( sock ) {}
+**
+** protected:
+**   void run( void ) {
+**     CO_BEGIN;
+**     while ( true ) {
+**       CO_AWAIT( recv( *_sock, _buf, sizeof(_buf) ) );
+**       if ( result() <= 0 )
+**         break;
+**
+**       CO_AWAIT( send( *_sock, _buf, result() ) );
+**       CO_AWAIT( sleepFor( 0.5 ) );
+**     }
+**     CO_END;
+**   }
+**
+**   Socket::Ptr _sock;
+**   char _buf[512];
+** };
+**
+** (new Echo( sock ))->start();
+** \endcode
+**
+** Since the coroutine is stackless (it returns from run() at each suspension), local variables don't survive a
+** CO_AWAIT: anything needed after one must be a member.  Likewise, CO_AWAIT may not appear within a nested \c switch.
+**
+** Socket and file operations are submitted via the loop's Proactor (see AppLoop::Loop::io()); their result (a byte
+** count or descriptor, or \c -errno) is then available from result().  Other asynchronous operations may be awaited
+** via their completion signal, e.g. for a Transfer::Request:
+** \code
+** _req->perform();
+** CO_AWAIT( wait( _req->recvBodyDone ) );
+** \endcode
+**
+** Coroutine objects are allocated from a pool of recycled blocks, and the awaitables (other than wait(), which must
+** connect a slot) re-use the same operation, timer and handler each time, so a coroutine in its steady state makes no
+** heap allocations.  A started coroutine holds a reference to itself until run() completes, at which point
+** #finished is emitted.
+**
+** This is the C++98 equivalent of a C++20 coroutine task; the resume point is kept in a member, rather than a
+** compiler-generated frame.
+*/
+
+//! Creates a coroutine, resumed by \a loop (by default, the calling thread's).
+Coroutine::Coroutine( AppLoop::Loop &loop )
+: _line( 0 ), _result( 0 ), _suspended( false ), _loop( &loop )
+{}
+
+
+Coroutine::~Coroutine( void )
+{
+  _signal.disconnect();
+  if ( _timer )
+    _timer->stop();
+}
+
+
+//! Runs the coroutine (from the loop's thread) until its first suspension.
+void Coroutine::start( void )
+{
+  if ( _line || _suspended )
+    return;
+
+  ref();
+  step();
+}
+
+
+//! Resumes the coroutine after an awaited operation completes with \a result.
+void Coroutine::resume( int result )
+{
+  if ( !_suspended )
+    return;
+
+  _result = result;
+  step();
+}
+
+
+//! Runs the body from its resume point, and releases the coroutine if it completes.
+void Coroutine::step( void )
+{
+  _suspended = false;
+  run();
+  if ( _suspended )
+    return;
+
+  _line = -1;
+  finished();
+
+  if ( deref() )
+    delete this;
+}
+
+
+//! Awaits a delay of \a delay seconds.
+bool Coroutine::sleepFor( Time delay )
+{
+  if ( !_timer ) {
+    _timer = new Timer( delay, false, *_loop );
+    _timer->connect( boost::bind( &Coroutine::onTimer, this ) );
+  } else {
+    _timer->stop();
+    _timer->start( delay );
+  }
+
+  return suspend();
+}
+
+
+//! Awaits the receipt of up to \a len bytes from socket \a fd into \a buf.
+bool Coroutine::recv( int fd, void *buf, unsigned len )
+{
+  _loop->io().recv( fd, buf, len, Resume( this ) );
+  return suspend();
+}
+
+
+//! Awaits the receipt of up to \a len bytes from socket \a sock into \a buf.
+bool Coroutine::recv( FileDescWatcher const &sock, void *buf, unsigned len )
+{
+  return recv( sock.fd(), buf, len );
+}
+
+
+//! Awaits sending \a len bytes from \a buf to socket \a fd.
+bool Coroutine::send( int fd, void const *buf, unsigned len )
+{
+  _loop->io().send( fd, buf, len, Resume( this ) );
+  return suspend();
+}
+
+
+//! Awaits sending \a len bytes from \a buf to socket \a sock.
+bool Coroutine::send( FileDescWatcher const &sock, void const *buf, unsigned len )
+{
+  return send( sock.fd(), buf, len );
+}
+
+
+//! Awaits reading up to \a len bytes from file \a fd, at \a offset, into \a buf.
+bool Coroutine::read( int fd, void *buf, unsigned len, off_t offset )
+{
+  _loop->io().read( fd, buf, len, offset, Resume( this ) );
+  return suspend();
+}
+
+
+//! Awaits writing \a len bytes from \a buf to file \a fd, at \a offset.
+bool Coroutine::write( int fd, void const *buf, unsigned len, off_t offset )
+{
+  _loop->io().write( fd, buf, len, offset, Resume( this ) );
+  return suspend();
+}
+
+
+//! Awaits a connection on listening socket \a fd; result() is then the new socket's descriptor.
+bool Coroutine::accept( int fd )
+{
+  _loop->io().accept( fd, Resume( this ) );
+  return suspend();
+}
+
+
+//! Awaits the next emission of \a signal (e.g. Transfer::Request::recvBodyDone).
+bool Coroutine::wait( boost::signal< void() > &signal )
+{
+  _signal = signal.connect( boost::bind( &Coroutine::onSignal, this ) );
+  return suspend();
+}
+
+
+void Coroutine::onTimer( void )
+{
+  resume( 0 );
+}
+
+
+void Coroutine::onSignal( void )
+{
+  _signal.disconnect();
+  resume( 0 );
+}
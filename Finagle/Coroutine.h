@@ -0,0 +1,145 @@
+/*!
+** \file Coroutine.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#ifndef FINAGLE_COROUTINE_H
+#define FINAGLE_COROUTINE_H
+
+#include <cstddef>
+#include <sys/types.h>
+#include <boost/signals.hpp>
+#include <Finagle/AppLoop.h>
+#include <Finagle/BlockPool.h>
+#include <Finagle/ObjectPtr.h>
+#include <Finagle/Timer.h>
+
+namespace Finagle {
+
+class FileDescWatcher;
+
+//! Begins the body of Coroutine::run()
+#define CO_BEGIN        switch ( _line ) {  case 0:
+
+//! Suspends the coroutine until the awaitable \a op (e.g. \c sleepFor(0.5)) completes
+#define CO_AWAIT( op )  do {  _line = __LINE__;  if ( op ) return;  case __LINE__: ;  } while ( 0 )
+
+//! Ends the body of Coroutine::run()
+#define CO_END          }
+
+//! A stackless coroutine, resumed by its application loop as each awaited operation completes.
+class Coroutine : public ReferenceCount {
+public:
+  typedef ObjectPtr<Coroutine> Ptr;
+
+public:
+  Coroutine( AppLoop::Loop &loop = AppLoop::Loop::current() );
+  virtual ~Coroutine( void );
+
+  void start( void );
+
+  bool running( void ) const;
+  bool done( void ) const;
+  int  result( void ) const;
+  AppLoop::Loop &loop( void ) const;
+
+  static void *operator new( size_t size ) {  return BlockPool::allocate( size );  }
+  static void  operator delete( void *ptr, size_t size ) {  BlockPool::release( ptr, size );  }
+
+public:
+  boost::signal< void() > finished;  //!< Emitted when run() returns without suspending
+
+protected:
+  //! The coroutine's body, between CO_BEGIN and CO_END
+  virtual void run( void ) = 0;
+
+  bool sleepFor( Time delay );
+  bool recv( int fd, void *buf, unsigned len );
+  bool recv( FileDescWatcher const &sock, void *buf, unsigned len );
+  bool send( int fd, void const *buf, unsigned len );
+  bool send( FileDescWatcher const &sock, void const *buf, unsigned len );
+  bool read( int fd, void *buf, unsigned len, off_t offset );
+  bool write( int fd, void const *buf, unsigned len, off_t offset );
+  bool accept( int fd );
+  bool wait( boost::signal< void() > &signal );
+
+  void resume( int result );
+
+protected:
+  //! Completion handler which resumes a coroutine (small enough for \c boost::function to store in place)
+  struct Resume {
+    Resume( Coroutine *c ) : co( c ) {}
+    void operator ()( int res ) const {  co->resume( res );  }
+    Coroutine *co;
+  };
+
+  bool suspend( void );
+  void step( void );
+  void onTimer( void );
+  void onSignal( void );
+
+protected:
+  int  _line;       //!< Resume point (\c 0 before starting, \c -1 when done)
+  int  _result;
+  bool _suspended;
+  AppLoop::Loop *_loop;
+  Timer::Ptr _timer;
+  boost::signals::connection _signal;
+
+private:
+  Coroutine( Coroutine const & );
+  Coroutine &operator =( Coroutine const & );
+};
+
+// INLINE IMPLEMENTATION **********************************************************************************************************
+
+//! Returns \c true iff the coroutine has started, and is suspended in an awaited operation.
+inline bool Coroutine::running( void ) const
+{
+  return _suspended;
+}
+
+//! Returns \c true iff the coroutine has run to completion.
+inline bool Coroutine::done( void ) const
+{
+  return _line == -1;
+}
+
+//! Returns the result of the last awaited operation (a byte count or descriptor, or \c -errno on failure).
+inline int Coroutine::result( void ) const
+{
+  return _result;
+}
+
+//! Returns the application loop which resumes the coroutine.
+inline AppLoop::Loop &Coroutine::loop( void ) const
+{
+  return *_loop;
+}
+
+//! Marks the coroutine as suspended, and returns \c true (for CO_AWAIT).
+inline bool Coroutine::suspend( void )
+{
+  _suspended = true;
+  return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,260 @@
+/*!
+** \file Epoch.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include "Epoch.h"
+#include "Mutex.h"
+#include "PThreadEx.h"
+#include "SpinMutex.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::Epoch
+** \brief Epoch-based deferred reclamation, for structures which are read without locks.
+**
+** Readers on any thread traverse a shared structure while holding an Epoch::Guard, which pins them to the current
+** (global) epoch.  A writer unlinks an object, so no new reader can reach it, then retires it; it's reclaimed once
+** every thread which was pinned when it was retired has left its guard.  The epoch advances only when every pinned
+** thread has seen it, so an object retired in epoch \e e is safe to reclaim once the epoch reaches <em>e</em> + 2.
+**
+** Each thread keeps its own retired objects, in the order it retired them (and so in epoch order), so collect()
+** reclaims from the front of the list until it reaches an object which isn't yet safe, or its budget is spent: each
+** object costs O(1), however many are waiting.  retire() collects by itself, every #CollectInterval retirements (twice
+** as many as it retired), and a thread's leftovers are adopted by the other threads when it exits.
+**
+** Example: \code
+** // Reader (any thread)
+** {
+**   Epoch::Guard _;
+**   for ( Route const *r = routes; r; r = r->next )
+**     ...
+** }
+**
+** // Writer (serialized with other writers)
+** Route *old = routes;
+** routes = replacement;
+** Epoch::retire( old );
+** \endcode
+**
+** A guard should be short-lived: while any thread is pinned, the epoch can't advance, and nothing retired since it was
+** pinned can be reclaimed.
+*/
+
+unsigned long volatile Epoch::_epoch = 0;
+Epoch::Participant * volatile Epoch::_participants = 0;
+
+namespace Finagle {
+  //! Holds the thread-specific key for each thread's Participant (whose destructor releases it).
+  class EpochData {
+  public:
+    EpochData( void ) {
+      PTHREAD_ASSERT( pthread_key_create( &key, &Epoch::release ) );
+    }
+
+    static pthread_key_t key;
+  };
+
+  pthread_key_t EpochData::key;
+}
+
+static EpochData __epochData;
+
+//! Objects retired by threads which have exited
+struct Epoch::Orphans {
+  SpinMutex guard;
+  deque<Retired> retired;
+};
+
+//! Returns the objects retired by threads which have exited (created on first use, and never destroyed).
+Epoch::Orphans &Epoch::orphans( void )
+{
+  static Orphans *o = new Orphans;
+  return *o;
+}
+
+
+//! Pins the calling thread to the current epoch (see Guard).  May be nested.
+void Epoch::enter( void )
+{
+  Participant &p = self();
+  if ( p.depth++ )
+    return;
+
+  p.epoch = _epoch;
+  p.active = 1;
+  __sync_synchronize();  // announce before reading anything shared
+}
+
+
+//! Unpins the calling thread (once it has left as many times as it entered).
+void Epoch::leave( void )
+{
+  Participant &p = self();
+  if ( --p.depth )
+    return;
+
+  __sync_synchronize();  // finish reading before announcing
+  p.active = 0;
+}
+
+
+//! Returns \c true iff the calling thread is pinned (i.e. has an Epoch::Guard).
+bool Epoch::pinned( void )
+{
+  return self().depth != 0;
+}
+
+
+//! Advances the global epoch, if every pinned thread has seen it; returns \c true iff it advanced.
+bool Epoch::advance( void )
+{
+  __sync_synchronize();
+  unsigned long epoch = _epoch;
+  for ( Participant *p = _participants; p; p = p->next )
+    if ( p->active && (p->epoch != epoch) )
+      return false;
+
+  return __sync_bool_compare_and_swap( &_epoch, epoch, epoch + 1 );
+}
+
+
+/*! \brief Reclaims \a obj, by calling \a reclaim( \a obj ), once no thread can still be reading it.
+**
+** The object must already be unreachable by new readers.
+*/
+void Epoch::retire( void *obj, void (*reclaim)( void * ) )
+{
+  Participant &p = self();
+  __sync_synchronize();  // readers must see obj unlinked before we read the epoch it's tagged with
+  p.retired.push_back( Retired( _epoch, obj, reclaim ) );
+
+  // Reclaim faster than we retire, so a backlog drains
+  if ( ++p.retirements >= CollectInterval )
+    collect( 2 * CollectInterval );
+}
+
+
+/*! \brief Tries to advance the epoch, then reclaims up to \a budget objects which are safe to reclaim.
+**
+** Reclaims the calling thread's retired objects first, then any left by threads which have exited.  Returns the number
+** reclaimed.
+*/
+unsigned Epoch::collect( unsigned budget )
+{
+  Participant &p = self();
+  if ( p.collecting )
+    return 0;
+
+  p.collecting = true;
+  p.retirements = 0;
+
+  // Two advances (if no thread is pinned) make everything retired before now safe
+  if ( advance() )
+    advance();
+
+  unsigned count = reclaim( p.retired, budget );
+
+  Orphans &o = orphans();
+  if ( (count < budget) && o.guard.tryLock() ) {
+    deque<Retired> ready;
+    while ( !o.retired.empty() && (o.retired.front().epoch + 2 <= _epoch) && (ready.size() < budget - count) ) {
+      ready.push_back( o.retired.front() );
+      o.retired.pop_front();
+    }
+    o.guard.unlock();
+
+    count += reclaim( ready, budget - count );
+  }
+
+  p.collecting = false;
+  return count;
+}
+
+
+//! Returns the number of retired objects awaiting reclamation (by the calling thread, or left by exited threads).
+unsigned Epoch::pending( void )
+{
+  unsigned count = self().retired.size();
+
+  Orphans &o = orphans();
+  SpinLock _( o.guard );
+  return count + o.retired.size();
+}
+
+
+//! Reclaims up to \a budget objects from the front of \a retired, until one isn't yet safe; returns the number reclaimed.
+unsigned Epoch::reclaim( deque<Retired> &retired, unsigned budget )
+{
+  unsigned count = 0;
+  while ( (count < budget) && !retired.empty() && (retired.front().epoch + 2 <= _epoch) ) {
+    Retired r = retired.front();
+    retired.pop_front();  // before reclaiming, which may retire more
+    r.reclaim( r.obj );
+    count++;
+  }
+
+  return count;
+}
+
+
+//! Returns the calling thread's Participant, claiming one if necessary.
+Epoch::Participant &Epoch::self( void )
+{
+  Participant *p = (Participant *) pthread_getspecific( EpochData::key );
+  if ( p )
+    return *p;
+
+  // Reuse the record of a thread which has exited, or add a new one
+  for ( p = _participants; p; p = p->next )
+    if ( !p->inUse && __sync_bool_compare_and_swap( &p->inUse, 0, 1 ) )
+      break;
+
+  if ( !p ) {
+    p = new Participant;
+    do
+      p->next = _participants;
+    while ( !__sync_bool_compare_and_swap( &_participants, p->next, p ) );
+  }
+
+  PTHREAD_ASSERT( pthread_setspecific( EpochData::key, p ) );
+  return *p;
+}
+
+
+//! Releases an exiting thread's Participant, handing its retired objects to the other threads.
+void Epoch::release( void *participant )
+{
+  Participant *p = (Participant *) participant;
+  p->active = 0;
+  p->depth = 0;
+  p->retirements = 0;
+
+  if ( !p->retired.empty() ) {
+    Orphans &o = orphans();
+    SpinLock _( o.guard );
+    o.retired.insert( o.retired.end(), p->retired.begin(), p->retired.end() );
+    p->retired.clear();
+  }
+
+  __sync_synchronize();
+  p->inUse = 0;
+}
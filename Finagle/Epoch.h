@@ -0,0 +1,125 @@
+/*!
+** \file Epoch.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#ifndef FINAGLE_EPOCH_H
+#define FINAGLE_EPOCH_H
+
+#include <deque>
+
+namespace Finagle {
+
+//! Epoch-based deferred reclamation, for structures which are read without locks.
+class Epoch {
+public:
+  static const unsigned DefaultBudget = 64;     //!< Default number of objects reclaimed per collect()
+  static const unsigned CollectInterval = 128;  //!< Retirements between the collections done by retire() itself
+
+  //! Pins the calling thread to the current epoch while in scope, so nothing it can reach is reclaimed
+  class Guard {
+  public:
+    Guard( void ) {  enter();  }
+   ~Guard( void ) {  leave();  }
+
+  private:
+    Guard( Guard const & );
+    Guard &operator =( Guard const & );
+  };
+
+public:
+  static void enter( void );
+  static void leave( void );
+  static bool pinned( void );
+
+  static unsigned long current( void );
+  static bool advance( void );
+
+  static void retire( void *obj, void (*reclaim)( void * ) );
+  template <typename Type>
+  static void retire( Type *obj );
+
+  static unsigned collect( unsigned budget = DefaultBudget );
+  static unsigned pending( void );
+
+protected:
+  //! An object awaiting reclamation, and the epoch in which it was retired
+  struct Retired {
+    Retired( unsigned long e, void *o, void (*r)( void * ) ) : epoch( e ), obj( o ), reclaim( r ) {}
+    unsigned long epoch;
+    void *obj;
+    void (*reclaim)( void * );
+  };
+
+  //! A thread's announcement of whether it's pinned (and to which epoch), and its retired objects
+  struct Participant {
+    Participant( void ) : epoch( 0 ), active( 0 ), inUse( 1 ), depth( 0 ), retirements( 0 ), collecting( false ), next( 0 ) {}
+
+    unsigned long volatile epoch;
+    int volatile active;
+    int volatile inUse;     //!< Claimed by a live thread (records are reused, never freed)
+    unsigned depth;         //!< Nested Guards
+    unsigned retirements;   //!< Since the last collection
+    bool collecting;        //!< In collect() (so objects retired while reclaiming don't recurse)
+    std::deque<Retired> retired;
+    Participant *next;
+  };
+
+  struct Orphans;
+
+  template <typename Type>
+  static void destroy( void *obj );
+
+  static Participant &self( void );
+  static Orphans &orphans( void );
+  static void release( void *participant );
+  static unsigned reclaim( std::deque<Retired> &retired, unsigned budget );
+
+protected:
+  static unsigned long volatile _epoch;
+  static Participant * volatile _participants;
+
+  friend class EpochData;
+};
+
+// INLINE/TEMPLATE IMPLEMENTATION *************************************************************************************************
+
+//! Returns the global epoch.
+inline unsigned long Epoch::current( void )
+{
+  return _epoch;
+}
+
+//! Deletes \a obj once no thread can still be reading it (i.e. once every pinned thread has moved on).
+template <typename Type>
+inline void Epoch::retire( Type *obj )
+{
+  retire( obj, &Epoch::destroy<Type> );
+}
+
+template <typename Type>
+void Epoch::destroy( void *obj )
+{
+  delete (Type *) obj;
+}
+
+}
+
+#endif
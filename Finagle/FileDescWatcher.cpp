@@ -23,56 +23,127 @@
 
 using namespace Finagle;
 
-Set<FileDescWatchable const *> FileDescWatchable::Active;
 
+/*! \class Finagle::FileDescWatchable
+** \brief Base class for objects which are notified of file descriptor events by the application loop.
+**
+** A watchable either provides a single descriptor and event mask (watchFD() and watchEvents()), which the Reactor
+** registers once and notifies via onEvents(), or fills in \c fd_sets each iteration (fds() and onSelect()), for those
+** objects (e.g. Transfer::Processor) which can't provide a single descriptor.  Whenever the descriptor or event mask
+** changes, call update().
+**
+** Each watchable is bound to a single AppLoop::Loop (by default, the loop of the thread which created it), and is
+** notified by that loop's thread.  Use moveTo() to hand it to another loop.  Since a watchable (e.g. a newly accepted
+** Socket) may be handed between threads, its reference count is atomic (see AtomicReferenceCount).
+**
+** \sa Reactor and AppLoop.
+*/
 
 FileDescWatchable::~FileDescWatchable( void )
 {
   disable();
 }
 
+/*! \brief Binds the watchable to \a loop (which may belong to another thread).
+**
+** If the watchable is enabled, it's unregistered from its current loop (so this must be called from that loop's
+** thread), and \a loop registers it on its next iteration (see AppLoop::Loop::adopt()).
+*/
+void FileDescWatchable::moveTo( AppLoop::Loop &loop ) const
+{
+  if ( &loop == _loop )
+    return;
+
+  if ( !enabled() ) {
+    _loop = &loop;
+    return;
+  }
+
+  disable();
+  loop.adopt( this );
+}
+
+
+//! Returns the descriptor to watch, or \c -1 if the watchable uses fds() and onSelect() instead.
+int FileDescWatchable::watchFD( void ) const
+{
+  return -1;
+}
+
+//! Returns the events (see FileDescWatchable::Event) to watch for on watchFD().
+unsigned FileDescWatchable::watchEvents( void ) const
+{
+  return 0;
+}
+
+//! Called when one or more of the watched \a events have occurred on watchFD().
+void FileDescWatchable::onEvents( unsigned ) const
+{}
+
+//! Adds the watched descriptors to the given sets, and returns the highest descriptor (or \c -1 for none).
+int FileDescWatchable::fds( fd_set &, fd_set &, fd_set & ) const
+{
+  return -1;
+}
+
+//! Called with the results of \c select(2), after fds() returned a descriptor.
+void FileDescWatchable::onSelect( fd_set &, fd_set &, fd_set & ) const
+{}
+
 
 /*! \class Finagle::FileDescWatcher
-** \brief Watches a file descriptor for a change in status (via \c select(2)).
+** \brief Watches a file descriptor for a change in status (via \c epoll(7) or \c select(2)).
 **
-** This class watches (using \c select(2)) a particular file descriptor for
-** changes in status, i.e. readable, writable, or an exception occured.  It
-** is intended to be used for sockets, but could be used for any operating
-** system object which provides a file descriptor.
+** This class watches a particular file descriptor for changes in status, i.e. readable, writable, or an exception
+** occured.  It is intended to be used for sockets, but could be used for any operating system object which provides a
+** file descriptor.  Only those events with connected slots are watched for.
 **
-** \sa AppLoop, Socket and ServerSocket.
+** \sa AppLoop, Reactor, Socket and ServerSocket.
 */
 
 void FileDescWatcher::fd( int fileDesc )
 {
-  if ( (fileDesc != -1) && (_fd == -1) )
+  if ( fileDesc == _fd )
+    return;
+
+  int oldFD = _fd;
+  _fd = fileDesc;
+
+  if ( (fileDesc != -1) && (oldFD == -1) )
     enable();
   else
-  if ( (fileDesc == -1) && (_fd != -1) )
+  if ( (fileDesc == -1) && (oldFD != -1) )
     disable();
-
-  _fd = fileDesc;
+  else
+    update();
 }
 
 
-int FileDescWatcher::fds( fd_set &readFDs, fd_set &writeFDs, fd_set &exceptFDs ) const
+int FileDescWatcher::watchFD( void ) const
 {
-  if ( _fd == -1 )  return -1;
+  return _fd;
+}
 
-  bool r = !readable.empty(), w = !writable.empty(), e = !exception.empty();
-  if ( !(r || w || e) )  return -1;
 
-  if ( r )  FD_SET( _fd, &readFDs );
-  if ( w )  FD_SET( _fd, &writeFDs );
-  if ( e )  FD_SET( _fd, &exceptFDs );
+unsigned FileDescWatcher::watchEvents( void ) const
+{
+  if ( _fd == -1 )  return 0;
 
-  return _fd;
+  return (readable.empty()  ? 0 : Read) |
+         (writable.empty()  ? 0 : Write) |
+         (exception.empty() ? 0 : Except);
 }
 
 
-void FileDescWatcher::onSelect( fd_set &readFDs, fd_set &writeFDs, fd_set &exceptFDs ) const
+void FileDescWatcher::onEvents( unsigned events ) const
 {
-  if ( FD_ISSET( _fd, &exceptFDs ) )  exception();
-  if ( FD_ISSET( _fd, &readFDs   ) )  readable();
-  if ( FD_ISSET( _fd, &writeFDs  ) )  writable();
+  // Slots may have been disconnected since we registered; if so, stop watching for those events.
+  if ( events & ~watchEvents() )
+    update();
+
+  if ( (events & Except) && !exception.empty() )  exception();
+  if ( _fd == -1 )  return;
+  if ( (events & Read)   && !readable.empty()  )  readable();
+  if ( _fd == -1 )  return;
+  if ( (events & Write)  && !writable.empty()  )  writable();
 }
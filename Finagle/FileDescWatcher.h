@@ -24,53 +24,77 @@
 
 #include <boost/signals.hpp>
 #include <Finagle/ObjectPtr.h>
-#include <Finagle/Set.h>
-#include <Finagle/Singleton.h>
+#include <Finagle/AppLoop.h>
 
 namespace Finagle {
 
-namespace AppLoop {
-  extern void process( Time );
-}
-
-class FileDescWatchable : public ReferenceCount {
+class FileDescWatchable : public AtomicReferenceCount {
 public:
   typedef ObjectPtr<FileDescWatchable const> ConstPtr;
 
+  //! Event flags, as returned by watchEvents() and passed to onEvents()
+  enum Event {  Read = 1, Write = 2, Except = 4  };
+
 public:
   virtual ~FileDescWatchable( void );
 
+  bool enabled( void ) const;
   void enable( void ) const;
   void disable( void ) const;
+  void update( void ) const;
+
+  AppLoop::Loop &loop( void ) const;
+  void moveTo( AppLoop::Loop &loop ) const;
 
 protected:
-  FileDescWatchable( void ) {}
-  virtual int  fds( fd_set &readFDs, fd_set &writeFDs, fd_set &exceptFDs ) const = 0;
-  virtual void onSelect( fd_set &readFDs, fd_set &writeFDs, fd_set &exceptFDs ) const = 0;
+  FileDescWatchable( AppLoop::Loop &loop = AppLoop::Loop::current() );
 
-  friend void AppLoop::process( Time );
+  virtual int      watchFD( void ) const;
+  virtual unsigned watchEvents( void ) const;
+  virtual void     onEvents( unsigned events ) const;
+
+  virtual int  fds( fd_set &readFDs, fd_set &writeFDs, fd_set &exceptFDs ) const;
+  virtual void onSelect( fd_set &readFDs, fd_set &writeFDs, fd_set &exceptFDs ) const;
 
 protected:
-  static Set<FileDescWatchable const *> Active;
+  mutable AppLoop::Loop *_loop;
+
+  friend class Reactor;
+  friend class AppLoop::Loop;
 };
 
 class FileDescWatcher : public FileDescWatchable {
 public:
   typedef ObjectPtr<FileDescWatcher> Ptr;
 
+  //! Signal which re-registers the watcher's interest when a slot is connected
+  class Signal : public boost::signal<void ()> {
+  public:
+    Signal( FileDescWatcher const &watcher ) : _watcher( watcher ) {}
+
+    template <typename Slot>
+    boost::signals::connection connect( Slot const &slot );
+    template <typename Group, typename Slot>
+    boost::signals::connection connect( Group const &group, Slot const &slot );
+
+  protected:
+    FileDescWatcher const &_watcher;
+  };
+
 public:
-  FileDescWatcher( int fileDesc = -1 );
+  FileDescWatcher( int fileDesc = -1, AppLoop::Loop &loop = AppLoop::Loop::current() );
  ~FileDescWatcher( void );
 
   int fd( void ) const;
   void fd( int fileDesc );
 
 public:
-  mutable boost::signal<void ()> readable, writable, exception;
+  mutable Signal readable, writable, exception;
 
 protected:
-  int  fds( fd_set &readFDs, fd_set &writeFDs, fd_set &exceptFDs ) const;
-  void onSelect( fd_set &readFDs, fd_set &writeFDs, fd_set &exceptFDs ) const;
+  int      watchFD( void ) const;
+  unsigned watchEvents( void ) const;
+  void     onEvents( unsigned events ) const;
 
 protected:
   int _fd;
@@ -78,19 +102,77 @@ protected:
 
 // INLINE IMPLEMENTATION ******************************************************
 
+//! Binds the watchable to \a loop (by default, the calling thread's loop).
+inline FileDescWatchable::FileDescWatchable( AppLoop::Loop &loop )
+: _loop( &loop )
+{}
+
+//! Returns \c true if the watchable is registered with its application loop.
+inline bool FileDescWatchable::enabled( void ) const
+{
+  return _loop->watchers().contains( this );
+}
+
+//! Registers the watchable with its application loop.
 inline void FileDescWatchable::enable( void ) const
 {
-  Active.insert( this );
+  _loop->watchers().add( this );
 }
 
+//! Unregisters the watchable from its application loop.
 inline void FileDescWatchable::disable( void ) const
 {
-  Active.erase( this );
+  _loop->watchers().remove( this );
+}
+
+//! Re-registers the watchable's descriptor and events (e.g. after watchEvents() has changed).
+inline void FileDescWatchable::update( void ) const
+{
+  _loop->watchers().update( this );
+}
+
+//! Returns the application loop to which the watchable is bound.
+inline AppLoop::Loop &FileDescWatchable::loop( void ) const
+{
+  return *_loop;
+}
+
+
+//! Connects \a slot, and watches for the signal's event; if the watcher can't be re-registered, disconnects and rethrows.
+template <typename Slot>
+inline boost::signals::connection FileDescWatcher::Signal::connect( Slot const &slot )
+{
+  boost::signals::connection conn = boost::signal<void ()>::connect( slot );
+  try {
+    _watcher.update();
+  }
+  catch ( ... ) {
+    conn.disconnect();
+    throw;
+  }
+
+  return conn;
+}
+
+//! Connects \a slot in \a group (see above).
+template <typename Group, typename Slot>
+inline boost::signals::connection FileDescWatcher::Signal::connect( Group const &group, Slot const &slot )
+{
+  boost::signals::connection conn = boost::signal<void ()>::connect( group, slot );
+  try {
+    _watcher.update();
+  }
+  catch ( ... ) {
+    conn.disconnect();
+    throw;
+  }
+
+  return conn;
 }
 
 
-inline FileDescWatcher::FileDescWatcher( int fileDesc )
-: _fd( -1 )
+inline FileDescWatcher::FileDescWatcher( int fileDesc, AppLoop::Loop &loop )
+: FileDescWatchable( loop ), readable( *this ), writable( *this ), exception( *this ), _fd( -1 )
 {
   fd( fileDesc );
 }
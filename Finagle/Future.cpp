@@ -0,0 +1,141 @@
+/*!
+** \file Future.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <new>
+
+#include "Future.h"
+
+using namespace std;
+using namespace Finagle;
+
+FutureBase::Continuation FutureBase::State::Completed = FutureBase::Continuation( FutureBase::Callback() );
+
+//! Discards any continuations (of a result which was never set).
+FutureBase::State::~State( void )
+{
+  Continuation *c = _continuations;
+  while ( c && (c != &Completed) ) {
+    Continuation *next = c->next;
+    delete c;
+    c = next;
+  }
+}
+
+
+//! Calls \a callback once the result is ready (on the completing thread), or immediately if it's already ready.
+void FutureBase::State::subscribe( Callback const &callback )
+{
+  Continuation *c = new Continuation( callback );
+  while ( true ) {
+    Continuation *head = _continuations;
+    if ( head == &Completed ) {
+      delete c;
+      callback();
+      return;
+    }
+
+    c->next = head;
+    if ( __sync_bool_compare_and_swap( &_continuations, head, c ) )
+      return;
+  }
+}
+
+//! Marks the result ready, wakes all threads waiting for it, and runs its continuations (in the order they were added).
+void FutureBase::State::complete( void )
+{
+  __sync_synchronize();
+  done = 1;
+  parking.notifyAll();
+
+  Continuation *head;
+  do {
+    head = _continuations;
+  } while ( !__sync_bool_compare_and_swap( &_continuations, head, &Completed ) );
+
+  if ( head == &Completed )
+    return;
+
+  Continuation *ordered = 0;
+  while ( head ) {
+    Continuation *next = head->next;
+    head->next = ordered;
+    ordered = head;
+    head = next;
+  }
+
+  while ( ordered ) {
+    Continuation *next = ordered->next;
+    ordered->callback();
+    delete ordered;
+    ordered = next;
+  }
+}
+
+
+//! Creates a gather with no futures, held open (against completion) until seal() is called.
+FutureBase::AllGather::AllGather( void )
+: _remaining( 1 ), _failed( 0 )
+{}
+
+//! Adds another future to wait for (before subscribing to it).
+void FutureBase::AllGather::expect( void )
+{
+  __sync_add_and_fetch( &_remaining, 1 );
+}
+
+//! Notes that a future is ready (with the given \a error, if it failed), and completes the gather if it was the last.
+void FutureBase::AllGather::arrive( String const *error )
+{
+  if ( !error->empty() && __sync_bool_compare_and_swap( &_failed, 0, 1 ) )
+    _error = *error;
+
+  seal();
+}
+
+//! Notes that no more futures will be added, and completes the gather if they're all ready.
+void FutureBase::AllGather::seal( void )
+{
+  if ( __sync_sub_and_fetch( &_remaining, 1 ) )
+    return;
+
+  if ( _failed )
+    promise.setError( _error );
+  else
+    promise.setValue();
+}
+
+
+FutureBase::AnyGather::AnyGather( void )
+: _won( 0 )
+{}
+
+//! Completes the gather with future \a index (or its \a error, if it failed), if it's the first to be ready.
+void FutureBase::AnyGather::arrive( unsigned index, String const *error )
+{
+  if ( !__sync_bool_compare_and_swap( &_won, 0, 1 ) )
+    return;
+
+  if ( error->empty() )
+    promise.setValue( index );
+  else
+    promise.setError( *error );
+}
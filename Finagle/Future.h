@@ -0,0 +1,505 @@
+/*!
+** \file Future.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#ifndef FINAGLE_FUTURE_H
+#define FINAGLE_FUTURE_H
+
+#include <cstddef>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/utility/result_of.hpp>
+#include <Finagle/BlockPool.h>
+#include <Finagle/Exception.h>
+#include <Finagle/ObjectPtr.h>
+#include <Finagle/RingQueue.h>
+#include <Finagle/TextString.h>
+
+namespace Finagle {
+
+template <typename Type> class Future;
+template <typename Type> class Promise;
+
+//! Non-template parts of Future and Promise
+class FutureBase {
+public:
+  //! Stands in for the value of a \c Future<void>
+  struct Void {};
+
+  //! The value type stored for results of type \a Type (Void, for \c void)
+  template <typename Type>
+  struct Value {
+    typedef Type Stored;
+    static Type const &get( Stored const &val ) {  return val;  }
+  };
+
+  //! Called once a result is ready
+  typedef boost::function< void() > Callback;
+
+  class AllGather;
+  class AnyGather;
+
+protected:
+  //! Base for objects shared between threads: reference-counted atomically, and allocated from a pool
+  class Shared : public AtomicReferenceCount {
+  public:
+    virtual ~Shared( void ) {}
+
+    static void *operator new( size_t size ) {  return BlockPool::allocate( size );  }
+    static void  operator delete( void *ptr, size_t size ) {  BlockPool::release( ptr, size );  }
+  };
+
+  //! A callback waiting for a result, in a lock-free stack
+  struct Continuation {
+    Continuation( Callback const &cb ) : next( 0 ), callback( cb ) {}
+
+    static void *operator new( size_t size ) {  return BlockPool::allocate( size );  }
+    static void  operator delete( void *ptr, size_t size ) {  BlockPool::release( ptr, size );  }
+
+    Continuation *next;
+    Callback callback;
+  };
+
+  //! State shared between a Promise and its Futures
+  class State : public Shared {
+  public:
+    State( void ) : done( 0 ), _continuations( 0 ) {}
+   ~State( void );
+
+    bool wait( Time timeout ) const;
+    void subscribe( Callback const &callback );
+    void complete( void );
+
+  public:
+    int volatile done;  //!< Set (once the value or error is stored) when the result is ready
+    String error;       //!< Description of the failure, if the result is an error
+    mutable RingQueueBase::Parking parking;
+
+  protected:
+    static Continuation Completed;  //!< Replaces the stack of continuations once they've been run
+
+    Continuation *volatile _continuations;
+  };
+
+  //! Checks whether a result is ready, for RingQueueBase::await()
+  struct Ready {
+    Ready( State const &s ) : state( s ) {}
+    bool operator()( void ) const {  return state.done;  }
+    State const &state;
+  };
+
+  //! Posts a continuation to an executor (anything with a \c post(Callback) method, e.g. AppLoop::Loop or ThreadPool)
+  template <typename Executor, typename Job>
+  struct Post {
+    Post( Executor &e, Job const &j ) : executor( &e ), job( j ) {}
+    void operator()( void );
+    Executor *executor;
+    Job job;
+  };
+};
+
+template <>
+struct FutureBase::Value<void> {
+  typedef Void Stored;
+  static void get( Stored const & ) {}
+};
+
+/*! \brief The result of an asynchronous operation, which may not have completed yet
+**
+** A Future is obtained from a Promise (e.g. via ThreadPool::submit(), or Transfer::Request::perform()), and may be
+** copied freely; all copies refer to the same result.  get() blocks until the result is ready, then returns it (or
+** throws it, if the operation failed).  \c Future<void> signals only completion (or failure).
+**
+** Rather than blocking, a continuation may be attached with then(), which is called with the (ready) future, and
+** returns a future for the continuation's own result.  The continuation runs on the chosen executor (e.g. an
+** AppLoop::Loop, or a ThreadPool); without one, it runs on whichever thread completes the future (or, if it's
+** already complete, immediately).  If the continuation calls get() on a failed future, its exception fails the
+** continuation's future in turn.
+**
+** Example: \code
+** Future<unsigned> count = pool.submit( boost::bind( &Index::count, &index, term ) );
+** count.then( AppLoop::Loop::main(), boost::bind( &Window::showCount, window, _1 ) );
+** \endcode
+**
+** The state shared by a promise and its futures, and the continuations waiting on it, are allocated from a pool of
+** recycled blocks.
+*/
+template <typename Type>
+class Future : public FutureBase {
+public:
+  Future( void );
+
+  bool valid( void ) const;
+  bool ready( void ) const;
+  bool failed( void ) const;
+  String const &error( void ) const;
+
+  bool wait( Time timeout = Time() ) const;
+  typename Value<Type>::Stored const &value( void ) const;
+  Type get( void ) const;
+
+  template <typename Func>
+  Future<typename boost::result_of<Func( Future<Type> )>::type> then( Func func ) const;
+
+  template <typename Executor, typename Func>
+  Future<typename boost::result_of<Func( Future<Type> )>::type> then( Executor &executor, Func func ) const;
+
+  void subscribe( Callback const &callback ) const;
+
+protected:
+  class TypedState : public State {
+  public:
+    typename Value<Type>::Stored value;
+  };
+
+  //! Runs a continuation, fulfilling its promise
+  template <typename Result, typename Func>
+  struct Continue {
+    Continue( Future const &a, Promise<Result> const &p, Func const &f ) : antecedent( a ), promise( p ), func( f ) {}
+    void operator()( void ) {  promise.run( boost::bind( &Continue::apply, this ) );  }
+    Result apply( void ) {  return func( antecedent );  }
+    Future antecedent;
+    Promise<Result> promise;
+    Func func;
+  };
+
+  Future( ObjectPtr<TypedState> const &state );
+
+protected:
+  ObjectPtr<TypedState> _state;
+
+  friend class Promise<Type>;
+};
+
+/*! \brief The producing side of a Future
+**
+** The producer of a result sets it once, with setValue() (or setError()), completing every Future obtained from
+** future().  Copies of a Promise refer to the same result.
+*/
+template <typename Type>
+class Promise : public FutureBase {
+public:
+  Promise( void );
+
+  Future<Type> future( void ) const;
+  bool done( void ) const;
+
+  void setValue( typename Value<Type>::Stored const &val = typename Value<Type>::Stored() );
+  void setError( String const &error );
+
+  template <typename Func>
+  void run( Func func );
+
+protected:
+  typedef typename Future<Type>::TypedState TypedState;
+  ObjectPtr<TypedState> _state;
+};
+
+//! Completes a whenAll() future once all of its futures are ready
+class FutureBase::AllGather : public FutureBase::Shared {
+public:
+  typedef ObjectPtr<AllGather> Ptr;
+
+  //! Called as each future is ready
+  struct Arrive {
+    Arrive( Ptr const &g, String const &e ) : gather( g ), error( &e ) {}
+    void operator()( void ) {  gather->arrive( error );  }
+    Ptr gather;
+    String const *error;
+  };
+
+public:
+  AllGather( void );
+  void expect( void );
+  void arrive( String const *error );
+  void seal( void );
+
+public:
+  Promise<void> promise;
+
+protected:
+  int volatile _remaining;
+  int volatile _failed;
+  String _error;  //!< The first failure
+};
+
+//! Completes a whenAny() future once any of its futures is ready
+class FutureBase::AnyGather : public FutureBase::Shared {
+public:
+  typedef ObjectPtr<AnyGather> Ptr;
+
+  //! Called as each future is ready
+  struct Arrive {
+    Arrive( Ptr const &g, unsigned i, String const &e ) : gather( g ), index( i ), error( &e ) {}
+    void operator()( void ) {  gather->arrive( index, error );  }
+    Ptr gather;
+    unsigned index;
+    String const *error;
+  };
+
+public:
+  AnyGather( void );
+  void arrive( unsigned index, String const *error );
+
+public:
+  Promise<unsigned> promise;
+
+protected:
+  int volatile _won;
+};
+
+template <typename InputIterator>
+Future<void> whenAll( InputIterator begin, InputIterator end );
+
+template <typename InputIterator>
+Future<unsigned> whenAny( InputIterator begin, InputIterator end );
+
+// INLINE/TEMPLATE IMPLEMENTATION *************************************************************************************************
+
+//! Blocks until the result is ready (or for up to \a timeout seconds, if valid); returns \c true iff it's ready.
+inline bool FutureBase::State::wait( Time timeout ) const
+{
+  if ( done )
+    return true;
+
+  return RingQueueBase::await( parking, Ready( *this ), timeout.isValid() ? Time( Time::now() + timeout ) : Time() );
+}
+
+
+template <typename Executor, typename Job>
+void FutureBase::Post<Executor, Job>::operator()( void )
+{
+  try {
+    executor->post( job );
+  }
+  catch ( std::exception &ex ) {
+    job.promise.setError( ex.what() );  // e.g. the pool is shut down
+  }
+}
+
+
+//! Creates an invalid future (not associated with any Promise).
+template <typename Type>
+inline Future<Type>::Future( void )
+{}
+
+template <typename Type>
+inline Future<Type>::Future( ObjectPtr<TypedState> const &state )
+: _state( state )
+{}
+
+//! Returns \c true iff the future is associated with a Promise.
+template <typename Type>
+inline bool Future<Type>::valid( void ) const
+{
+  return _state;
+}
+
+//! Returns \c true iff the result is ready (i.e. get() won't block).
+template <typename Type>
+inline bool Future<Type>::ready( void ) const
+{
+  return _state && _state->done;
+}
+
+//! Returns \c true iff the result is ready, and is an error.
+template <typename Type>
+inline bool Future<Type>::failed( void ) const
+{
+  return ready() && !_state->error.empty();
+}
+
+//! Returns the description of the failure (or an empty string, if the result isn't an error).
+template <typename Type>
+inline String const &Future<Type>::error( void ) const
+{
+  return _state->error;
+}
+
+//! Blocks until the result is ready (or for up to \a timeout seconds, if valid); returns \c true iff it's ready.
+template <typename Type>
+inline bool Future<Type>::wait( Time timeout ) const
+{
+  return _state->wait( timeout );
+}
+
+/*! \brief Waits for the result, and returns a reference to it.
+**
+** \throw Exception if the operation failed.
+*/
+template <typename Type>
+typename FutureBase::Value<Type>::Stored const &Future<Type>::value( void ) const
+{
+  _state->wait( Time() );
+  if ( !_state->error.empty() )
+    throw Exception( _state->error );
+
+  return _state->value;
+}
+
+/*! \brief Waits for the result, and returns it.
+**
+** \throw Exception if the operation failed.
+*/
+template <typename Type>
+inline Type Future<Type>::get( void ) const
+{
+  return Value<Type>::get( value() );
+}
+
+//! Calls \a func with this future once it's ready (on the completing thread), and returns a future for its result.
+template <typename Type> template <typename Func>
+Future<typename boost::result_of<Func( Future<Type> )>::type> Future<Type>::then( Func func ) const
+{
+  typedef typename boost::result_of<Func( Future<Type> )>::type Result;
+
+  Promise<Result> promise;
+  _state->subscribe( Continue<Result, Func>( *this, promise, func ) );
+  return promise.future();
+}
+
+//! Calls \a func with this future once it's ready (via \a executor), and returns a future for its result.
+template <typename Type> template <typename Executor, typename Func>
+Future<typename boost::result_of<Func( Future<Type> )>::type> Future<Type>::then( Executor &executor, Func func ) const
+{
+  typedef typename boost::result_of<Func( Future<Type> )>::type Result;
+
+  Promise<Result> promise;
+  _state->subscribe( Post<Executor, Continue<Result, Func> >( executor, Continue<Result, Func>( *this, promise, func ) ) );
+  return promise.future();
+}
+
+//! Calls \a callback once the result is ready (on the completing thread), or immediately if it's already ready.
+template <typename Type>
+inline void Future<Type>::subscribe( Callback const &callback ) const
+{
+  _state->subscribe( callback );
+}
+
+
+//! Creates a new, unfulfilled promise.
+template <typename Type>
+inline Promise<Type>::Promise( void )
+: _state( new TypedState )
+{}
+
+//! Returns a future for the promised result.
+template <typename Type>
+inline Future<Type> Promise<Type>::future( void ) const
+{
+  return Future<Type>( _state );
+}
+
+//! Returns \c true iff the result has been set.
+template <typename Type>
+inline bool Promise<Type>::done( void ) const
+{
+  return _state->done;
+}
+
+//! Fulfills the promise with \a val (which is ignored, for \c Promise<void>).
+template <typename Type>
+inline void Promise<Type>::setValue( typename Value<Type>::Stored const &val )
+{
+  _state->value = val;
+  _state->complete();
+}
+
+//! Fails the promise, with the description \a error.
+template <typename Type>
+inline void Promise<Type>::setError( String const &error )
+{
+  _state->error = error.empty() ? String( "Unknown error" ) : error;
+  _state->complete();
+}
+
+
+//! Calls \a func, and fulfills the promise with its result (or fails it, with any exception it throws).
+template <typename Type> template <typename Func>
+void Promise<Type>::run( Func func )
+{
+  try {
+    setValue( func() );
+  }
+  catch ( std::exception &ex ) {
+    setError( ex.what() );
+  }
+  catch ( ... ) {
+    setError( "Unknown exception" );
+  }
+}
+
+//! Calls \a func, and completes the promise (or fails it, with any exception it throws).
+template <> template <typename Func>
+void Promise<void>::run( Func func )
+{
+  try {
+    func();
+    setValue();
+  }
+  catch ( std::exception &ex ) {
+    setError( ex.what() );
+  }
+  catch ( ... ) {
+    setError( "Unknown exception" );
+  }
+}
+
+
+/*! \brief Returns a future which completes once all the futures in [\a begin, \a end) are ready.
+**
+** If any of them failed, so does the returned future (with the first failure).  The range is traversed once.
+*/
+template <typename InputIterator>
+Future<void> whenAll( InputIterator begin, InputIterator end )
+{
+  FutureBase::AllGather::Ptr gather( new FutureBase::AllGather );
+  Future<void> all = gather->promise.future();
+  for ( ; begin != end; ++begin ) {
+    gather->expect();
+    begin->subscribe( FutureBase::AllGather::Arrive( gather, begin->error() ) );
+  }
+
+  gather->seal();
+  return all;
+}
+
+/*! \brief Returns a future for the index (from \a begin) of the first of the futures in [\a begin, \a end) to be ready.
+**
+** If that one failed, so does the returned future.  If the range is empty, the returned future fails immediately.
+*/
+template <typename InputIterator>
+Future<unsigned> whenAny( InputIterator begin, InputIterator end )
+{
+  FutureBase::AnyGather::Ptr gather( new FutureBase::AnyGather );
+  Future<unsigned> any = gather->promise.future();
+  if ( begin == end )
+    gather->promise.setError( "No futures to wait for" );
+
+  for ( unsigned i = 0; begin != end; ++begin, ++i )
+    begin->subscribe( FutureBase::AnyGather::Arrive( gather, i, begin->error() ) );
+
+  return any;
+}
+
+}
+
+#endif
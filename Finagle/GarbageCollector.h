@@ -22,65 +22,191 @@
 #ifndef FINAGLE_GARBAGECOLLECTOR_H
 #define FINAGLE_GARBAGECOLLECTOR_H
 
+#include <deque>
+#include <utility>
 #include <boost/bind.hpp>
 #include <boost/signals.hpp>
 #include <Finagle/AppLoop.h>
-#include <Finagle/List.h>
+#include <Finagle/Epoch.h>
 #include <Finagle/ObjectPtr.h>
+#include <Finagle/SpinMutex.h>
 
 namespace Finagle {
 
-//!\brief Provides garbage collection for ObjectPtrs.
+/*! \brief Provides deferred release for ObjectPtrs.
+**
+** Objects added to the collector are held until a grace period has passed (i.e. the Epoch has advanced twice, so no
+** thread which was in an Epoch::Guard when they were added can still be reading them), then released by an idle task
+** on the main loop, oldest first, at most budget() per idle pass.  An object which is still referenced elsewhere once
+** its grace period has passed is kept for another, so the collector's is always the last reference it releases (and
+** #onCollect is only emitted for objects about to be destroyed).  Objects may be added from any thread.
+*/
 template <typename Class>
 class GarbageCollector : public boost::signals::trackable {
 public:
-  GarbageCollector( void );
+  GarbageCollector( unsigned budget = Epoch::DefaultBudget );
  ~GarbageCollector( void );
-  GarbageCollector &operator +=( ObjectPtr<Class> obj );
+  GarbageCollector &operator +=( ObjectPtr<Class> const &obj );
 
-  void collect( void );
+  bool collect( void );
+  unsigned size( void ) const;
+  unsigned budget( void ) const;
 
 public:
-  boost::signal< void( ObjectPtr<Class> ) > onCollect;
+  boost::signal< void( ObjectPtr<Class> ) > onCollect;  //!< Emitted as each object is released
 
 protected:
-  List<ObjectPtr<Class> > _trash;
+  //! The trash, shared with the main loop's idle task (which may run after the collector is destroyed)
+  struct Bin : public AtomicReferenceCount {
+    typedef ObjectPtr<Bin> Ptr;
+    Bin( GarbageCollector *o, unsigned b ) : owner( o ), budget( b ), task( 0 ), scheduled( false ) {}
+
+    mutable SpinMutex guard;
+    std::deque<std::pair<unsigned long, ObjectPtr<Class> > > trash;  //!< Objects, and the epochs they were added in
+    GarbageCollector *owner;  //!< \c 0 once the collector is destroyed
+    unsigned budget;
+    IdleScheduler::ID task;   //!< Only used by the main loop's thread
+    bool scheduled;           //!< The idle task has been (or is about to be) added
+  };
+
+  static void schedule( typename Bin::Ptr bin );
+  static bool run( typename Bin::Ptr bin );
+
+protected:
+  typename Bin::Ptr _bin;
 };
 
 // TEMPLATE IMPLEMENTATION ****************************************************
 
+//! Creates a collector, which releases at most \a budget objects per idle pass.
 template <typename Class>
-GarbageCollector<Class>::GarbageCollector( void )
+GarbageCollector<Class>::GarbageCollector( unsigned budget )
+: _bin( new Bin( this, budget ) )
 {}
 
+//! Releases all objects (whether or not their grace period has passed).
 template <typename Class>
 GarbageCollector<Class>::~GarbageCollector( void )
 {
-  collect();
+  std::deque<std::pair<unsigned long, ObjectPtr<Class> > > trash;
+  {
+    SpinLock _( _bin->guard );
+    _bin->owner = 0;
+    trash.swap( _bin->trash );
+  }
+
+  if ( _bin->task && AppLoop::Loop::main().isCurrent() ) {
+    AppLoop::Loop::main().idleTasks().remove( _bin->task );
+    _bin->task = 0;
+  }
 }
 
+//! Adds \a obj, to be released once its grace period has passed.
 template <typename Class>
-GarbageCollector<Class> &GarbageCollector<Class>::operator +=( ObjectPtr<Class> obj )
+GarbageCollector<Class> &GarbageCollector<Class>::operator +=( ObjectPtr<Class> const &obj )
 {
-  _trash.push_back( obj );
+  __sync_synchronize();  // readers must see obj unlinked before we read the epoch it's tagged with
+
+  bool idle;
+  {
+    SpinLock _( _bin->guard );
+    _bin->trash.push_back( std::make_pair( Epoch::current(), obj ) );
+    idle = !_bin->scheduled;
+    _bin->scheduled = true;
+  }
 
-  if ( _trash.size() == 1 )
-    AppLoop::idle.connect( boost::bind( &GarbageCollector<Class>::collect, this ) );
+  if ( idle ) {
+    AppLoop::Loop &main = AppLoop::Loop::main();
+    if ( main.isCurrent() )
+      schedule( _bin );
+    else
+      main.post( boost::bind( &GarbageCollector<Class>::schedule, _bin ) );
+  }
 
   return *this;
 }
 
+/*! \brief Releases up to budget() objects whose grace period has passed; returns \c true iff any remain.
+**
+** Called by the main loop while idle (and only to be called by the main loop's thread).  Each object costs O(1), as
+** objects are added (and so become releasable) in order; those still referenced elsewhere are re-added, to be checked
+** again after another grace period.
+*/
 template <typename Class>
-void GarbageCollector<Class>::collect( void )
+bool GarbageCollector<Class>::collect( void )
 {
-  for ( typename List<ObjectPtr<Class> >::Iterator obj = _trash.begin(); obj != _trash.end(); ) {
-    if ( (*obj)->refs() > 1 ) {  ++obj;  continue;  }
-    *obj = 0;
-    _trash.erase( obj++ );
+  if ( Epoch::advance() )
+    Epoch::advance();
+
+  std::deque<std::pair<unsigned long, ObjectPtr<Class> > > ready;
+  {
+    SpinLock _( _bin->guard );
+    unsigned long epoch = Epoch::current();
+    while ( !_bin->trash.empty() && (_bin->trash.front().first + 2 <= epoch) && (ready.size() < _bin->budget) ) {
+      ready.push_back( _bin->trash.front() );
+      _bin->trash.pop_front();
+    }
+  }
+
+  std::deque<std::pair<unsigned long, ObjectPtr<Class> > > referenced;
+  for ( unsigned i = 0; i < ready.size(); ++i )
+    if ( ready[i].second->refs() > 1 )
+      referenced.push_back( ready[i] );
+    else
+      onCollect( ready[i].second );
+  ready.clear();
+
+  {
+    SpinLock _( _bin->guard );
+    unsigned long epoch = Epoch::current();
+    for ( unsigned i = 0; i < referenced.size(); ++i )
+      _bin->trash.push_back( std::make_pair( epoch, referenced[i].second ) );
+
+    if ( !_bin->trash.empty() )
+      return true;
+
+    _bin->scheduled = false;
+  }
+
+  if ( _bin->task ) {
+    AppLoop::Loop::main().idleTasks().remove( _bin->task );
+    _bin->task = 0;
   }
+  return false;
+}
+
+//! Returns the number of objects awaiting release.
+template <typename Class>
+unsigned GarbageCollector<Class>::size( void ) const
+{
+  SpinLock _( _bin->guard );
+  return _bin->trash.size();
+}
+
+//! Returns the most objects released per idle pass.
+template <typename Class>
+inline unsigned GarbageCollector<Class>::budget( void ) const
+{
+  return _bin->budget;
+}
+
+//! Adds the idle task which collects \a bin (on the main loop's thread).
+template <typename Class>
+void GarbageCollector<Class>::schedule( typename Bin::Ptr bin )
+{
+  if ( bin->owner && !bin->task )
+    bin->task = AppLoop::Loop::main().idleTasks().add( boost::bind( &GarbageCollector<Class>::run, bin ), -1 );
+}
+
+//! The idle task: collects \a bin, unless its collector has been destroyed.
+template <typename Class>
+bool GarbageCollector<Class>::run( typename Bin::Ptr bin )
+{
+  if ( bin->owner )
+    return bin->owner->collect();
 
-  if ( _trash.empty() )
-    AppLoop::idle.disconnect( this );
+  bin->task = 0;
+  return false;
 }
 
 }
@@ -0,0 +1,147 @@
+/*!
+** \file IdleScheduler.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include <algorithm>
+
+#include "IdleScheduler.h"
+#include "AppLog.h"
+#include "Array.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::IdleScheduler
+** \brief Runs prioritized background tasks while an application loop is idle, within a per-iteration time budget.
+**
+** Each time its loop finds nothing ready, the scheduler runs its tasks in order of priority (highest first), and
+** round-robin within each priority, until the budget() is spent.  A task does a slice of its work each time it's run,
+** returning \c true if it has more to do (and should be run again), or \c false when it's finished (and should be
+** removed).  At least one task is run per iteration, however long it takes.
+**
+** Tasks which don't fit in the budget are passed over until a later iteration.  A task which is passed over for
+** starveLimit() consecutive iterations is logged (as a warning), and counted in LoopStats::starved.
+**
+** Example: \code
+** AppLoop::Loop::current().idleTasks().add( boost::bind( &Index::rebuildSome, &index ), -1 );
+** \endcode
+*/
+
+const double IdleScheduler::DefaultBudget = 0.005;
+
+
+//! Orders tasks by descending priority, then by least recently run.
+struct IdleScheduler::Before {
+  bool operator ()( pair<ID, Entry const *> const &a, pair<ID, Entry const *> const &b ) const
+  {
+    if ( a.second->priority != b.second->priority )
+      return a.second->priority > b.second->priority;
+
+    return a.second->lastRun < b.second->lastRun;
+  }
+};
+
+
+IdleScheduler::IdleScheduler( void )
+: _nextID( 1 ), _sequence( 0 ), _budget( DefaultBudget ), _starveLimit( DefaultStarveLimit )
+{}
+
+
+//! Schedules \a task to run while the loop is idle, at \a priority; returns its ID.
+IdleScheduler::ID IdleScheduler::add( Task const &task, int priority )
+{
+  ID id = _nextID++;
+  if ( !_nextID )
+    _nextID = 1;
+
+  Entry &entry = _tasks.insert( id );
+  entry.task = task;
+  entry.priority = priority;
+  entry.lastRun = 0;
+  entry.skipped = 0;
+  return id;
+}
+
+
+//! Removes task \a id (which may be running); returns \c true iff it was scheduled.
+bool IdleScheduler::remove( ID id )
+{
+  return _tasks.erase( id ) != 0;
+}
+
+
+//! Returns the number of tasks which have been passed over for at least starveLimit() consecutive iterations.
+unsigned IdleScheduler::starving( void ) const
+{
+  unsigned count = 0;
+  for ( Map<ID, Entry>::ConstIterator e = _tasks.begin(); e != _tasks.end(); ++e )
+    if ( e->skipped >= _starveLimit )
+      count++;
+
+  return count;
+}
+
+
+/*! \brief Runs a slice of each task, in priority order, until the budget is spent.
+**
+** Returns the number of tasks run.  Tasks may add or remove tasks (including themselves) while running.
+*/
+unsigned IdleScheduler::run( LoopStats *stats )
+{
+  if ( _tasks.empty() )
+    return 0;
+
+  Array<pair<ID, Entry const *> > order;
+  order.reserve( _tasks.size() );
+  for ( map<ID, Entry>::const_iterator e = _tasks.begin(); e != _tasks.end(); ++e )
+    order.push_back( make_pair( e->first, &e->second ) );
+
+  sort( order.begin(), order.end(), Before() );
+
+  Time start = Time::now();
+  unsigned ran = 0;
+  for ( unsigned i = 0; i < order.size(); ++i ) {
+    map<ID, Entry>::iterator e = _tasks.find( order[i].first );
+    if ( e == _tasks.end() )
+      continue;  // removed by an earlier task
+
+    Entry &entry = e->second;
+    if ( ran && _budget.isValid() && ((Time::now() - start) >= _budget) ) {
+      // Over budget, so pass over this (and any remaining) task
+      if ( ++entry.skipped == _starveLimit ) {
+        LOG_WARN << "Idle task " << e->first << " (priority " << entry.priority << ") starved for " << _starveLimit << " iterations";
+        if ( stats )
+          stats->starved++;
+      }
+      continue;
+    }
+
+    entry.skipped = 0;
+    entry.lastRun = ++_sequence;
+    ran++;
+
+    // Run a copy, since the task may remove itself
+    Task task = entry.task;
+    if ( !task() )
+      _tasks.erase( order[i].first );
+  }
+
+  return ran;
+}
@@ -0,0 +1,126 @@
+/*!
+** \file IdleScheduler.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#ifndef FINAGLE_IDLESCHEDULER_H
+#define FINAGLE_IDLESCHEDULER_H
+
+#include <boost/function.hpp>
+#include <Finagle/DateTime.h>
+#include <Finagle/LoopStats.h>
+#include <Finagle/Map.h>
+
+namespace Finagle {
+
+//! Runs prioritized background tasks while an application loop is idle, within a per-iteration time budget.
+class IdleScheduler {
+public:
+  //! A slice of background work, which returns \c true iff it has more work to do
+  typedef boost::function< bool() > Task;
+
+  //! Identifies a scheduled task (never \c 0)
+  typedef unsigned ID;
+
+  static const double   DefaultBudget;             //!< Default time allowed for tasks per idle iteration, in seconds
+  static const unsigned DefaultStarveLimit = 100;  //!< Default iterations a task may be passed over before it's starved
+
+public:
+  IdleScheduler( void );
+
+  ID add( Task const &task, int priority = 0 );
+  bool remove( ID id );
+  bool contains( ID id ) const;
+
+  bool empty( void ) const;
+  unsigned size( void ) const;
+  unsigned starving( void ) const;
+
+  Time budget( void ) const;
+  void setBudget( Time budget );
+  unsigned starveLimit( void ) const;
+  void setStarveLimit( unsigned iterations );
+
+  unsigned run( LoopStats *stats = 0 );
+
+protected:
+  struct Entry {
+    Task task;
+    int priority;
+    unsigned long lastRun;  //!< Sequence number of the task's last slice (for round-robin within a priority)
+    unsigned skipped;       //!< Consecutive idle iterations in which the task was passed over
+  };
+
+  struct Before;
+
+protected:
+  Map<ID, Entry> _tasks;
+  ID _nextID;
+  unsigned long _sequence;
+  Time _budget;
+  unsigned _starveLimit;
+};
+
+// INLINE IMPLEMENTATION **********************************************************************************************************
+
+//! Returns \c true iff task \a id is scheduled.
+inline bool IdleScheduler::contains( ID id ) const
+{
+  return _tasks.contains( id );
+}
+
+//! Returns \c true iff no tasks are scheduled.
+inline bool IdleScheduler::empty( void ) const
+{
+  return _tasks.empty();
+}
+
+//! Returns the number of scheduled tasks.
+inline unsigned IdleScheduler::size( void ) const
+{
+  return _tasks.size();
+}
+
+//! Returns the time allowed for tasks in each idle iteration, in seconds (\c 0 for unlimited).
+inline Time IdleScheduler::budget( void ) const
+{
+  return _budget;
+}
+
+//! Sets the time allowed for tasks in each idle iteration to \a budget seconds (\c 0 for unlimited).
+inline void IdleScheduler::setBudget( Time budget )
+{
+  _budget = budget;
+}
+
+//! Returns the number of consecutive idle iterations a task may be passed over before it's reported as starved.
+inline unsigned IdleScheduler::starveLimit( void ) const
+{
+  return _starveLimit;
+}
+
+//! Sets the number of consecutive idle iterations a task may be passed over before it's reported as starved.
+inline void IdleScheduler::setStarveLimit( unsigned iterations )
+{
+  _starveLimit = iterations;
+}
+
+}
+
+#endif
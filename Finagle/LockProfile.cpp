@@ -0,0 +1,277 @@
+/*!
+** \file LockProfile.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+#include "LockProfile.h"
+#include "AppLog.h"
+#include "Array.h"
+#include "SpinMutex.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::LockProfile
+** \brief Contention statistics for named mutexes and lock sites.
+**
+** When the library (and everything using it) is built with \c FINAGLE_PROFILE_LOCKS defined (see
+** \c --enable-lock-profiling), every acquisition of a named Mutex (or WaitCondition) is counted against its name, and
+** every BasicLock given a site (e.g. \c LOCK_SITE) is counted against that site, whatever the mutex.  For each, the
+** profile records the acquisitions, those which had to wait for another thread (and the total and longest waits), how
+** long the mutex was held, and how long was spent waiting on a Condition while holding it.  Mutexes with the same name
+** (e.g. every Queue's) share their statistics.
+**
+** Without \c FINAGLE_PROFILE_LOCKS, mutex names and lock sites are ignored, and Mutex, Lock and the conditions are
+** exactly as they would be without them; the profile is simply empty.
+**
+** Example: \code
+** Mutex _guard( "Index" );
+** ...
+** Lock _( _guard, LOCK_SITE );
+** ...
+** LockProfile::log();  // or LockProfile::report( file )
+** \endcode
+*/
+
+//! The statistics for one name, updated atomically (as they're counted while the profiled lock is held).
+class LockProfile::Site {
+public:
+  //! Timings, in nanoseconds
+  struct Timings {
+    Timings( void ) : count( 0 ), total( 0 ), max( 0 ) {}
+
+    void add( Time elapsed );
+    void copy( LoopStats::Counter &counter ) const;
+    void reset( void );
+
+    unsigned volatile count;
+    long long volatile total, max;
+  };
+
+public:
+  Site( char const *n ) : name( n ), acquisitions( 0 ) {}
+
+  Stats stats( void ) const;
+  void reset( void );
+
+public:
+  string const name;
+  unsigned long volatile acquisitions;
+  Timings contended, hold, waits;
+};
+
+namespace {
+  struct Registry {
+    SpinMutex guard;
+    map<string, LockProfile::Site *> byName;
+    map<char const *, LockProfile::Site *> byAddress;  //!< Looked up first, as sites are usually string literals
+  };
+
+  //! Returns the registry of sites (created on first use, since named mutexes may be static, and never destroyed).
+  Registry &registry( void )
+  {
+    static Registry *reg = new Registry;
+    return *reg;
+  }
+
+  //! Orders statistics by descending total wait, then by descending acquisitions.
+  bool hotter( LockProfile::Stats const &a, LockProfile::Stats const &b )
+  {
+    if ( a.contended.total != b.contended.total )
+      return a.contended.total > b.contended.total;
+
+    return a.acquisitions > b.acquisitions;
+  }
+
+  Array<LockProfile::Stats> snapshot( void )
+  {
+    Registry &reg = registry();
+    Array<LockProfile::Stats> all;
+    {
+      SpinLock _( reg.guard );
+      all.reserve( reg.byName.size() );
+      for ( map<string, LockProfile::Site *>::const_iterator s = reg.byName.begin(); s != reg.byName.end(); ++s )
+        all.push_back( s->second->stats() );
+    }
+
+    sort( all.begin(), all.end(), hotter );
+    return all;
+  }
+}
+
+
+//! Counts a timing of \a elapsed seconds.
+void LockProfile::Site::Timings::add( Time elapsed )
+{
+  long long nsecs = (long long) (elapsed * 1e9);
+  __sync_fetch_and_add( &count, 1 );
+  __sync_fetch_and_add( &total, nsecs );
+
+  for ( long long prev = max; nsecs > prev; ) {
+    long long seen = __sync_val_compare_and_swap( &max, prev, nsecs );
+    if ( seen == prev )
+      break;
+    prev = seen;
+  }
+}
+
+//! Copies the timings into \a counter (in seconds).
+void LockProfile::Site::Timings::copy( LoopStats::Counter &counter ) const
+{
+  counter.count = count;
+  counter.total = total / 1e9;
+  counter.max = max / 1e9;
+}
+
+//! Clears the timings (losing any counted concurrently).
+void LockProfile::Site::Timings::reset( void )
+{
+  count = 0;
+  total = max = 0;
+}
+
+
+//! Returns a copy of the statistics.
+LockProfile::Stats LockProfile::Site::stats( void ) const
+{
+  Stats s;
+  s.name = name;
+  s.acquisitions = acquisitions;
+  contended.copy( s.contended );
+  hold.copy( s.hold );
+  waits.copy( s.waits );
+  return s;
+}
+
+//! Clears the statistics.
+void LockProfile::Site::reset( void )
+{
+  acquisitions = 0;
+  contended.reset();
+  hold.reset();
+  waits.reset();
+}
+
+
+//! Returns the site named \a name (which should outlive it, e.g. a string literal), creating it if necessary.
+LockProfile::Site *LockProfile::site( char const *name )
+{
+  Registry &reg = registry();
+  SpinLock _( reg.guard );
+
+  map<char const *, Site *>::const_iterator a = reg.byAddress.find( name );
+  if ( a != reg.byAddress.end() )
+    return a->second;
+
+  Site *&site = reg.byName[name];
+  if ( !site )
+    site = new Site( name );
+
+  reg.byAddress[name] = site;
+  return site;
+}
+
+
+//! Counts an acquisition of \a site which didn't wait.
+void LockProfile::acquired( Site *site )
+{
+  __sync_fetch_and_add( &site->acquisitions, 1 );
+}
+
+
+//! Counts an acquisition of \a site which waited \a waited seconds for another thread.
+void LockProfile::contended( Site *site, Time waited )
+{
+  __sync_fetch_and_add( &site->acquisitions, 1 );
+  site->contended.add( waited );
+}
+
+
+//! Counts \a held seconds of holding \a site.
+void LockProfile::held( Site *site, Time held )
+{
+  site->hold.add( held );
+}
+
+
+//! Counts \a waited seconds of waiting on a condition, while holding \a site.
+void LockProfile::waited( Site *site, Time waited )
+{
+  site->waits.add( waited );
+}
+
+
+//! Copies the statistics for \a name into \a stats; returns \c false if nothing has been recorded under that name.
+bool LockProfile::stats( char const *name, Stats &stats )
+{
+  Registry &reg = registry();
+  SpinLock _( reg.guard );
+
+  map<string, Site *>::const_iterator s = reg.byName.find( name );
+  if ( s == reg.byName.end() )
+    return false;
+
+  stats = s->second->stats();
+  return true;
+}
+
+
+//! Clears the statistics for every name (but keeps the names).
+void LockProfile::reset( void )
+{
+  Registry &reg = registry();
+  SpinLock _( reg.guard );
+
+  for ( map<string, Site *>::const_iterator s = reg.byName.begin(); s != reg.byName.end(); ++s )
+    s->second->reset();
+}
+
+
+//! Writes a table of the statistics to \a out, hottest (longest total wait) first, with times in microseconds.
+void LockProfile::report( ostream &out )
+{
+  Array<Stats> all = snapshot();
+
+  out << setw(12) << "locks" << setw(12) << "contended" << setw(12) << "wait (us)" << setw(10) << "max wait"
+      << setw(12) << "hold" << setw(10) << "max hold" << setw(10) << "cond wait" << "  name\n";
+
+  for ( Array<Stats>::const_iterator s = all.begin(); s != all.end(); ++s )
+    out << setw(12) << s->acquisitions << setw(12) << s->contended.count
+        << setw(12) << s->contended.total.usecs() << setw(10) << s->contended.max.usecs()
+        << setw(12) << s->hold.total.usecs() << setw(10) << s->hold.max.usecs()
+        << setw(10) << s->waits.total.usecs() << "  " << s->name << '\n';
+}
+
+
+//! Logs the statistics (as information), one entry per name, hottest first.
+void LockProfile::log( void )
+{
+  Array<Stats> all = snapshot();
+
+  for ( Array<Stats>::const_iterator s = all.begin(); s != all.end(); ++s )
+    LOG_INFO << "Lock " << s->name << ": " << s->acquisitions << " locks, " << s->contended.count << " contended, waited "
+             << s->contended.total.usecs() << " us (max " << s->contended.max.usecs() << " us), held "
+             << s->hold.total.usecs() << " us (max " << s->hold.max.usecs() << " us), condition waits "
+             << s->waits.total.usecs() << " us";
+}
@@ -0,0 +1,107 @@
+/*!
+** \file LockProfile.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#ifndef FINAGLE_LOCKPROFILE_H
+#define FINAGLE_LOCKPROFILE_H
+
+#include <ostream>
+#include <Finagle/DateTime.h>
+#include <Finagle/LoopStats.h>
+
+namespace Finagle {
+
+//! Stringizes the current line (for LOCK_SITE)
+#define FINAGLE_LINE_STRING2( line )  #line
+#define FINAGLE_LINE_STRING( line )   FINAGLE_LINE_STRING2( line )
+
+//! Names the current source line, as the acquisition site of a Lock (e.g. \c Lock \c _( \c guard, \c LOCK_SITE ))
+#define LOCK_SITE  __FILE__ ":" FINAGLE_LINE_STRING( __LINE__ )
+
+//! Contention statistics for named mutexes and lock sites (collected only when built with \c FINAGLE_PROFILE_LOCKS).
+class LockProfile {
+public:
+  //! The statistics for one named mutex or lock site
+  struct Stats {
+    Stats( void );
+
+    std::string name;
+    unsigned long acquisitions;   //!< Locks (including recursive and \c tryLock() locks)
+    LoopStats::Counter contended; //!< Locks which had to wait for another thread, and their waits
+    LoopStats::Counter hold;      //!< Time from each outermost lock to its unlock (less any condition waits)
+    LoopStats::Counter waits;     //!< Condition waits while holding the mutex, and their durations
+  };
+
+  class Site;
+
+public:
+  static bool enabled( void );
+
+  static Site *site( char const *name );
+  static void acquired( Site *site );
+  static void contended( Site *site, Time waited );
+  static void held( Site *site, Time held );
+  static void waited( Site *site, Time waited );
+
+  template <typename MutexType>
+  static Time acquire( MutexType &mutex, Site *site );
+
+  static bool stats( char const *name, Stats &stats );
+  static void reset( void );
+  static void report( std::ostream &out );
+  static void log( void );
+};
+
+// INLINE IMPLEMENTATION **********************************************************************************************************
+
+inline LockProfile::Stats::Stats( void )
+: acquisitions( 0 )
+{}
+
+//! Returns \c true iff the library was built to collect lock statistics.
+inline bool LockProfile::enabled( void )
+{
+#ifdef FINAGLE_PROFILE_LOCKS
+  return true;
+#else
+  return false;
+#endif
+}
+
+//! Locks \a mutex, counting the acquisition (and any wait for it) against \a site; returns the time it was acquired.
+template <typename MutexType>
+inline Time LockProfile::acquire( MutexType &mutex, Site *site )
+{
+  Time start = Time::now();
+  if ( mutex.tryLock() ) {
+    acquired( site );
+    return start;
+  }
+
+  mutex.lock();
+  Time now = Time::now();
+  contended( site, now - start );
+  return now;
+}
+
+}
+
+#endif
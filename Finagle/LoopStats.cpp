@@ -0,0 +1,95 @@
+/*!
+** \file LoopStats.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include <typeinfo>
+
+#include "LoopStats.h"
+#include "AppLog.h"
+#include "FileDescWatcher.h"
+#include "Timer.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::LoopStats
+** \brief Latency and stall counters for an application loop.
+**
+** An instrumented loop (see AppLoop::Loop::instrument()) times its waits for descriptors, each Timer and
+** FileDescWatchable notification, and its idle handlers, and measures how late each timer fires.  Notifications are
+** also broken down by the watchable's class (#watchers), and idle handlers by their position in the signal
+** (#idleSlots, timed by the AppLoop::IdleSlots combiner).  Any notification which takes longer than #slowThreshold is
+** logged (as a warning), along with the class of the offending watcher, the period of the offending timer, or the
+** position of the offending idle handler.
+**
+** The counters belong to the loop's thread; to read them from another thread, use AppLoop::Loop::post().
+*/
+
+//! Records a FileDescWatchable notification which began at \a start.
+void LoopStats::watcher( Time start, FileDescWatchable const *watchable )
+{
+  Time elapsed = Time::now() - start;
+  callbacks.add( elapsed );
+  watchers[typeid(*watchable).name()].add( elapsed );
+
+  if ( isSlow( elapsed ) )
+    LOG_WARN << "Slow watcher callback: " << typeid(*watchable).name() << " took " << elapsed.msecs() << " ms";
+}
+
+
+//! Records a Timer notification which began at \a start.
+void LoopStats::timer( Time start, Timer const *timer )
+{
+  Time elapsed = Time::now() - start;
+  timers.add( elapsed );
+
+  if ( isSlow( elapsed ) )
+    LOG_WARN << "Slow timer callback (period " << timer->period() << " sec) took " << elapsed.msecs() << " ms";
+}
+
+
+//! Records a run of the idle handlers (and idle tasks) which began at \a start, ending the pass.
+void LoopStats::idle( Time start )
+{
+  Time elapsed = Time::now() - start;
+  idles.add( elapsed );
+
+  bool slowSlot = _slowSlot;
+  _idleSlot = 0;
+  _slowSlot = false;
+
+  // Don't count a pass which was slow because of a handler already reported
+  if ( !slowSlot && isSlow( elapsed ) )
+    LOG_WARN << "Slow idle handlers took " << elapsed.msecs() << " ms";
+}
+
+
+//! Records a call to the next idle handler in this pass, which began at \a start.
+void LoopStats::idleSlot( Time start )
+{
+  Time elapsed = Time::now() - start;
+  unsigned slot = _idleSlot++;
+  idleSlots[slot].add( elapsed );
+
+  if ( isSlow( elapsed ) ) {
+    _slowSlot = true;
+    LOG_WARN << "Slow idle handler (#" << slot << ") took " << elapsed.msecs() << " ms";
+  }
+}
@@ -0,0 +1,147 @@
+/*!
+** \file LoopStats.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#ifndef FINAGLE_LOOPSTATS_H
+#define FINAGLE_LOOPSTATS_H
+
+#include <Finagle/Array.h>
+#include <Finagle/DateTime.h>
+#include <Finagle/Map.h>
+#include <Finagle/TextString.h>
+
+namespace Finagle {
+
+class FileDescWatchable;
+class Timer;
+
+//! Latency and stall counters for an application loop (see AppLoop::Loop::instrument()).
+class LoopStats {
+public:
+  //! Accumulates a number of timings
+  class Counter {
+  public:
+    Counter( void );
+
+    void reset( void );
+    void add( Time elapsed );
+    Time average( void ) const;
+
+  public:
+    unsigned count;
+    Time total, max;
+  };
+
+public:
+  LoopStats( void );
+
+  void reset( void );
+
+  void watcher( Time start, FileDescWatchable const *watchable );
+  void timer( Time start, Timer const *timer );
+  void idle( Time start );
+  void idleSlot( Time start );
+
+public:
+  Time slowThreshold;   //!< Callbacks which take longer than this are logged (\c 0 to disable)
+
+  unsigned iterations;  //!< Loop iterations
+  Counter wait;         //!< Time spent waiting for descriptors (in \c epoll_wait(2) or \c select(2))
+  Counter lag;          //!< Delay between each timer's (coalesced) alarm and its notification
+  Counter timers;       //!< Time spent in Timer notifications
+  Counter callbacks;    //!< Time spent in FileDescWatchable notifications
+  Map<String, Counter> watchers;  //!< Time spent in FileDescWatchable notifications, by the watchable's class
+  Counter idles;        //!< Time spent in idle handlers and tasks
+  Array<Counter> idleSlots;       //!< Time spent in each idle handler, in the order called (the loop's, then AppLoop::idle's)
+  unsigned slow;        //!< Callbacks which took longer than #slowThreshold
+  unsigned starved;     //!< Idle tasks passed over for too long (see IdleScheduler::starveLimit())
+
+protected:
+  bool isSlow( Time elapsed );
+
+protected:
+  unsigned _idleSlot;   //!< Index of the next idle handler in this pass
+  bool _slowSlot;       //!< An idle handler in this pass was slow
+};
+
+// INLINE IMPLEMENTATION **********************************************************************************************************
+
+inline LoopStats::Counter::Counter( void )
+{
+  reset();
+}
+
+//! Clears the counter.
+inline void LoopStats::Counter::reset( void )
+{
+  count = 0;
+  total = max = 0.0;
+}
+
+//! Adds a timing of \a elapsed seconds.
+inline void LoopStats::Counter::add( Time elapsed )
+{
+  count++;
+  total += elapsed;
+  if ( elapsed > max )
+    max = elapsed;
+}
+
+//! Returns the average timing (or \c 0, if there are none).
+inline Time LoopStats::Counter::average( void ) const
+{
+  return count ? (total / count) : 0.0;
+}
+
+
+inline LoopStats::LoopStats( void )
+: slowThreshold( 0.0 )
+{
+  reset();
+}
+
+//! Clears all counters (but not #slowThreshold).
+inline void LoopStats::reset( void )
+{
+  iterations = slow = starved = 0;
+  wait.reset();
+  lag.reset();
+  timers.reset();
+  callbacks.reset();
+  watchers.clear();
+  idles.reset();
+  idleSlots.clear();
+  _idleSlot = 0;
+  _slowSlot = false;
+}
+
+//! Returns \c true (and counts a slow callback) if \a elapsed exceeds the slow-callback threshold.
+inline bool LoopStats::isSlow( Time elapsed )
+{
+  if ( !slowThreshold.isValid() || (elapsed <= slowThreshold) )
+    return false;
+
+  slow++;
+  return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*!
+** \file MPSCQueue.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#ifndef FINAGLE_MPSCQUEUE_H
+#define FINAGLE_MPSCQUEUE_H
+
+#include <Finagle/Array.h>
+
+namespace Finagle {
+
+/*! \brief Lock-free, unbounded, multiple-producer/single-consumer queue
+**
+** Any number of threads may push() concurrently, without locking.  A single consumer takes \e every queued item at
+** once, in the order in which they were pushed, via popAll().  push() reports whether the queue was empty, so that a
+** producer need only wake the consumer for the first of a batch of items.
+*/
+template <typename Type>
+class MPSCQueue {
+public:
+  MPSCQueue( void );
+ ~MPSCQueue( void );
+
+  bool empty( void ) const;
+
+  bool push( Type const &el );
+  unsigned popAll( Array<Type> &dest );
+
+protected:
+  struct Node {
+    Node( Type const &el ) : val( el ), next( 0 ) {}
+    Type val;
+    Node *next;
+  };
+
+protected:
+  Node *volatile _head;  //!< Most recently pushed item (i.e. the items are linked newest-first)
+
+private:
+  MPSCQueue( MPSCQueue const & );
+  MPSCQueue &operator =( MPSCQueue const & );
+};
+
+// INLINE/TEMPLATE IMPLEMENTATION *************************************************************************************************
+
+template <typename Type>
+inline MPSCQueue<Type>::MPSCQueue( void )
+: _head( 0 )
+{}
+
+//! Discards any remaining items.
+template <typename Type>
+inline MPSCQueue<Type>::~MPSCQueue( void )
+{
+  for ( Node *n = _head; n; ) {
+    Node *next = n->next;
+    delete n;
+    n = next;
+  }
+}
+
+//! Returns \c true iff the queue is (momentarily) empty.
+template <typename Type>
+inline bool MPSCQueue<Type>::empty( void ) const
+{
+  return _head == 0;
+}
+
+//! Adds \a el to the tail of the queue (from any thread).  Returns \c true iff the queue was empty.
+template <typename Type>
+inline bool MPSCQueue<Type>::push( Type const &el )
+{
+  Node *n = new Node( el );
+  Node *head;
+
+  do {
+    head = _head;
+    n->next = head;
+  } while ( !__sync_bool_compare_and_swap( &_head, head, n ) );
+
+  return head == 0;
+}
+
+//! Appends every queued item to \a dest, oldest first, and returns the number of items (from the consumer thread only).
+template <typename Type>
+unsigned MPSCQueue<Type>::popAll( Array<Type> &dest )
+{
+  Node *n = __sync_lock_test_and_set( &_head, (Node *) 0 );
+  __sync_synchronize();
+
+  // Reverse into push order
+  Node *first = 0;
+  unsigned count = 0;
+  while ( n ) {
+    Node *next = n->next;
+    n->next = first;
+    first = n;
+    n = next;
+    count++;
+  }
+
+  dest.reserve( dest.size() + count );
+  while ( first ) {
+    Node *next = first->next;
+    dest.push_back( first->val );
+    delete first;
+    first = next;
+  }
+
+  return count;
+}
+
+}
+
+#endif
@@ -26,6 +26,9 @@ using namespace Finagle;
 
 /*! \class Finagle::Mutex
 ** \brief Provides a mutually-exclusive synchronization object with recursive locking.
+**
+** A mutex may be given a name, under which its contention is profiled when built with \c FINAGLE_PROFILE_LOCKS (see
+** LockProfile).  Otherwise the name is ignored.
 */
 
 void Mutex::init( void )
@@ -37,13 +40,81 @@ void Mutex::init( void )
   PTHREAD_ASSERT( pthread_mutexattr_destroy( &attr ) );
 }
 
+#ifdef FINAGLE_PROFILE_LOCKS
+
+//! Locks a named mutex, counting the acquisition, and any wait for another thread.
+void Mutex::profiledLock( void )
+{
+  Time start = Time::now();
+  int res = pthread_mutex_trylock( &_mutex );
+  if ( res == EBUSY ) {
+    PTHREAD_ASSERT( pthread_mutex_lock( &_mutex ) );
+    Time now = Time::now();
+    LockProfile::contended( _site, now - start );
+    start = now;
+  } else {
+    PTHREAD_ASSERT( res );
+    LockProfile::acquired( _site );
+  }
+
+  if ( !_depth++ )
+    _acquired = start;
+}
+
+//! Tries to lock a named mutex, counting the acquisition if it succeeds.
+bool Mutex::profiledTryLock( void )
+{
+  int res = pthread_mutex_trylock( &_mutex );
+  if ( res == EBUSY )
+    return false;
+
+  PTHREAD_ASSERT( res );
+  LockProfile::acquired( _site );
+  if ( !_depth++ )
+    _acquired = Time::now();
+
+  return true;
+}
+
+//! Counts the hold time of a named mutex, if this is the owner's outermost lock (before it's unlocked).
+void Mutex::profiledUnlock( void )
+{
+  if ( !--_depth )
+    LockProfile::held( _site, Time::now() - _acquired );
+}
+
+//! Counts the hold time of a named mutex, before it's released to wait on a condition; returns when it was released.
+Time Mutex::suspend( void )
+{
+  Time now = Time::now();
+  if ( _site )
+    LockProfile::held( _site, now - _acquired );
+
+  return now;
+}
+
+//! Counts a condition wait which began at \a suspended, once the mutex has been relocked.
+void Mutex::resume( Time suspended )
+{
+  _acquired = Time::now();
+  if ( _site )
+    LockProfile::waited( _site, _acquired - suspended );
+}
 
-/*! \class Finagle::Lock
-** \brief Provides a lock on a Mutex.
+#endif
+
+
+/*! \class Finagle::BasicLock
+** \brief Provides a lock on a mutex of type \a MutexType.
 **
-** When the Lock is instantiated, it locks the referenced mutex.  When the
+** When the lock is instantiated, it locks the referenced mutex.  When the
 ** lock object falls out of scope, it unlocks the mutex.
 **
+** Each mutex type has its own lock: Lock for a Mutex, SpinLock for a
+** SpinMutex, AdaptiveLock for an AdaptiveMutex, and WriteLock (or ReadLock)
+** for an RWMutex.  Anything else with \c lock() and \c unlock() may be
+** locked with a BasicLock of its own type.
+**
 ** This method of mutex locking is strongly encouraged over calling
 ** Mutex::lock() and Mutex::unlock() as it ensures that no "dangling
 ** mutex locks" will occur.  This can be crucial when, for example, using
@@ -59,6 +130,14 @@ void Mutex::init( void )
 ** \endcode
 */
 
-/*! \fn Lock::Lock( Mutex &LockMutex )
-** \brief Creates a lock on \a LockMutex.
+/*! \fn BasicLock::BasicLock( MutexType &mutex )
+** \brief Creates a lock on \a mutex.
+*/
+
+/*! \fn BasicLock::BasicLock( MutexType &mutex, char const *site )
+** \brief Creates a lock on \a mutex, counted against \a site in the lock profile.
+**
+** When built with \c FINAGLE_PROFILE_LOCKS, the acquisition, any wait for another thread, and the time until the lock
+** is destroyed are counted against \a site (which should be a string literal, e.g. \c LOCK_SITE, which names the
+** current source line), whatever the mutex.  Otherwise, this is the same as BasicLock( MutexType & ).
 */
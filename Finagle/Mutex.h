@@ -24,44 +24,96 @@
 
 #include <Finagle/PThreadEx.h>
 
+#ifdef FINAGLE_PROFILE_LOCKS
+#include <Finagle/LockProfile.h>
+#endif
+
 namespace Finagle {
 
 class Mutex {
 public:
   Mutex( void );
+  Mutex( char const *name );
  ~Mutex( void );
   Mutex( Mutex const & );
   Mutex &operator =( Mutex const & );
 
+  void setName( char const *name );
+
   void lock( void );
+  bool tryLock( void );
   void unlock( void );
 
 protected:
   void init( void );
 
+#ifdef FINAGLE_PROFILE_LOCKS
+  void profiledLock( void );
+  bool profiledTryLock( void );
+  void profiledUnlock( void );
+  Time suspend( void );
+  void resume( Time suspended );
+#endif
+
 protected:
   pthread_mutex_t _mutex;
+
+#ifdef FINAGLE_PROFILE_LOCKS
+  LockProfile::Site *_site;  //!< Where acquisitions are counted (\c 0 if unnamed)
+  unsigned _depth;           //!< Recursive locks held by the owner
+  Time _acquired;            //!< When the owner's outermost lock was taken (or its last condition wait ended)
+#endif
+
+  friend class Condition;
 };
 
-class Lock {
+template <typename MutexType>
+class BasicLock {
 public:
-  Lock( Mutex &mutex );
- ~Lock( void );
+  BasicLock( MutexType &mutex );
+  BasicLock( MutexType &mutex, char const *site );
+ ~BasicLock( void );
 
 protected:
-  Mutex &_mutex;
+  MutexType &_mutex;
+
+#ifdef FINAGLE_PROFILE_LOCKS
+  LockProfile::Site *_site;
+  Time _acquired;
+#endif
+
+private:
+  BasicLock( BasicLock const & );
+  BasicLock &operator =( BasicLock const & );
 };
 
+typedef BasicLock<Mutex> Lock;
+
 // INLINE IMPLEMENTATION ******************************************************
 
 //! Creates the mutex.
 inline Mutex::Mutex( void )
+#ifdef FINAGLE_PROFILE_LOCKS
+: _site( 0 ), _depth( 0 )
+#endif
 {
   init();
 }
 
-//! Copying a Mutex just creates a new Mutex.
-inline Mutex::Mutex( Mutex const & )
+//! Creates the mutex, named \a name (a string literal) in the lock profile (see LockProfile).
+inline Mutex::Mutex( char const *name )
+#ifdef FINAGLE_PROFILE_LOCKS
+: _site( LockProfile::site( name ) ), _depth( 0 )
+#endif
+{
+  init();
+}
+
+//! Copying a Mutex just creates a new Mutex (with the same name).
+inline Mutex::Mutex( Mutex const &that )
+#ifdef FINAGLE_PROFILE_LOCKS
+: _site( that._site ), _depth( 0 )
+#endif
 {
   init();
 }
@@ -79,27 +131,85 @@ inline Mutex::~Mutex( void )
   PTHREAD_ASSERT( pthread_mutex_destroy( &_mutex ) );
 }
 
+//! Names the mutex \a name (a string literal) in the lock profile (see LockProfile); ignored unless profiling.
+inline void Mutex::setName( char const *name )
+{
+#ifdef FINAGLE_PROFILE_LOCKS
+  _site = LockProfile::site( name );
+#endif
+}
+
 //! \brief Locks the mutex.
 inline void Mutex::lock( void )
 {
+#ifdef FINAGLE_PROFILE_LOCKS
+  if ( _site ) {
+    profiledLock();
+    return;
+  }
+#endif
   PTHREAD_ASSERT( pthread_mutex_lock( &_mutex ) );
 }
 
+//! \brief Locks the mutex, if it's not locked by another thread, and returns \c true iff it was locked.
+inline bool Mutex::tryLock( void )
+{
+#ifdef FINAGLE_PROFILE_LOCKS
+  if ( _site )
+    return profiledTryLock();
+#endif
+  int res = pthread_mutex_trylock( &_mutex );
+  if ( res == EBUSY )
+    return false;
+
+  PTHREAD_ASSERT( res );
+  return true;
+}
+
 //! \brief Unlocks the mutex.
 inline void Mutex::unlock( void )
 {
+#ifdef FINAGLE_PROFILE_LOCKS
+  if ( _site )
+    profiledUnlock();
+#endif
   PTHREAD_ASSERT( pthread_mutex_unlock( &_mutex ) );
 }
 
 
-inline Lock::Lock( Mutex &mutex )
+//! Locks \a mutex.
+template <typename MutexType>
+inline BasicLock<MutexType>::BasicLock( MutexType &mutex )
+: _mutex( mutex )
+#ifdef FINAGLE_PROFILE_LOCKS
+, _site( 0 )
+#endif
+{
+  mutex.lock();
+}
+
+//! Locks \a mutex, counting the acquisition against \a site (e.g. \c LOCK_SITE) in the lock profile (see LockProfile).
+template <typename MutexType>
+inline BasicLock<MutexType>::BasicLock( MutexType &mutex, char const *site )
 : _mutex( mutex )
+#ifdef FINAGLE_PROFILE_LOCKS
+, _site( LockProfile::site( site ) )
+{
+  _acquired = LockProfile::acquire( mutex, _site );
+}
+#else
 {
-  _mutex.lock();
+  mutex.lock();
 }
+#endif
 
-inline Lock::~Lock( void )
+template <typename MutexType>
+inline BasicLock<MutexType>::~BasicLock( void )
 {
+#ifdef FINAGLE_PROFILE_LOCKS
+  if ( _site )
+    LockProfile::held( _site, Time::now() - _acquired );
+#endif
   _mutex.unlock();
 }
 
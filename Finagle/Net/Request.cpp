@@ -57,6 +57,9 @@ Request::Request( URL const &url )
 
 Request::~Request( void )
 {
+  if ( !_done.done() )
+    _done.setError( "Request destroyed before completion" );
+
   if ( !_req )  return;
   Proc().remove( *this );
   curl_easy_cleanup( _req );
@@ -74,10 +77,34 @@ unsigned Request::result( void ) const
 }
 
 
-void Request::perform( void )
+/*! \brief Starts the request (processed by the application loop), and returns a future for its result code.
+**
+** The future completes (on the loop's thread) after #recvBodyDone is emitted, or fails if the transfer failed.
+*/
+Future<unsigned> Request::perform( void )
 {
-  if ( !_req )  return;
-  Proc().add( *this );
+  if ( _done.done() )
+    _done = Promise<unsigned>();
+
+  if ( _req )
+    Proc().add( *this );
+  else
+    _done.setError( "Request has no cURL instance" );
+
+  return _done.future();
+}
+
+
+//! Completes the future returned by perform(), with cURL's transfer result \a code.
+void Request::finish( int code )
+{
+  if ( _done.done() )
+    return;
+
+  if ( code == CURLE_OK )
+    _done.setValue( result() );
+  else
+    _done.setError( curl_easy_strerror( CURLcode( code ) ) );
 }
 
 
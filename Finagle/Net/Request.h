@@ -23,6 +23,7 @@
 #define FINAGLE_NET_REQUEST_H
 
 #include <Finagle/Exception.h>
+#include <Finagle/Future.h>
 #include <Finagle/Net/URL.h>
 #include <Finagle/Net/Transfer.h>
 
@@ -47,7 +48,7 @@ public:
   bool succeeded( void ) const;
   bool failed( void ) const;
 
-  void perform( void );
+  Future<unsigned> perform( void );
 
 public:
   boost::signal< void( String const &, size_t ) > recvBodyStart; //!< content type, size
@@ -56,12 +57,14 @@ public:
 
 protected:
   static size_t onBodyFrag( const char *data, size_t membSize, size_t membNum, Request *req );
+  void finish( int code );
 
 protected:
   URL _url;
   void *_req;
   mutable unsigned _res;
   bool _firstFrag;
+  Promise<unsigned> _done;
 
   friend class Processor;
 };
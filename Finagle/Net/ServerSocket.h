@@ -22,6 +22,7 @@
 #ifndef FINAGLE_NET_SERVERSOCKET_H
 #define FINAGLE_NET_SERVERSOCKET_H
 
+#include <Finagle/Array.h>
 #include <Finagle/Net/Socket.h>
 
 namespace Finagle {
@@ -33,30 +34,41 @@ public:
   typedef ObjectPtr<ServerSocket<SockType> > Ptr;
   typedef typename SockType::Addr Addr;
 
+  //! Policies for spreading accepted connections across loops (see distribute())
+  enum Balance {  RoundRobin, LeastLoad  };
+
 public:
   ServerSocket( void );
   ServerSocket( Addr const &addr, int sockDesc = -1 );
  ~ServerSocket( void ) {}
 
+  void distribute( Array<AppLoop::Loop *> const &loops, Balance balance = RoundRobin );
+
 public:
   boost::signal< void( Finagle::Socket::Ptr ) > connected;
 
 protected:
   void onReadable( void );
+  AppLoop::Loop &nextLoop( void );
+
+protected:
+  Array<AppLoop::Loop *> _loops;
+  Balance _balance;
+  unsigned _nextLoop;
 };
 
 // TEMPLATE/INLINE IMPLEMENTATION *************************************************************************************************
 
 template <typename SockType>
 inline ServerSocket<SockType>::ServerSocket( void )
-: SockType()
+: SockType(), _balance( RoundRobin ), _nextLoop( 0 )
 {
   SockType::readable.connect( this, &ServerSocket<SockType>::onReadable );
 }
 
 template <typename SockType>
 inline ServerSocket<SockType>::ServerSocket( Addr const &addr, int sockDesc )
-: SockType( addr, sockDesc )
+: SockType( addr, sockDesc ), _balance( RoundRobin ), _nextLoop( 0 )
 {
   SockType::readable.connect( this, &ServerSocket<SockType>::onReadable );
 }
@@ -85,6 +97,46 @@ void ServerSocket<SockType>::onReadable( void )
 
   delete [] (char *) newSockAddr;
   connected( sock );
+
+  if ( !_loops.empty() )
+    sock->moveTo( nextLoop() );
+}
+
+/*! \brief Spreads accepted connections across \a loops (e.g. those of a set of AppLoop::LoopThreads).
+**
+** Each new socket is bound to the listening socket's loop while #connected is emitted (so handlers should only
+** connect their slots), and is then handed over to the chosen loop, whose thread handles all further events.  With
+** \c LeastLoad, the loop with the fewest watchers is chosen.  Pass an empty array to keep connections on this loop.
+*/
+template <typename SockType>
+void ServerSocket<SockType>::distribute( Array<AppLoop::Loop *> const &loops, Balance balance )
+{
+  _loops = loops;
+  _balance = balance;
+  _nextLoop = 0;
+}
+
+//! Chooses the loop for the next accepted connection.
+template <typename SockType>
+AppLoop::Loop &ServerSocket<SockType>::nextLoop( void )
+{
+  if ( _balance == RoundRobin ) {
+    AppLoop::Loop &loop = *_loops[_nextLoop];
+    _nextLoop = (_nextLoop + 1) % _loops.size();
+    return loop;
+  }
+
+  AppLoop::Loop *best = _loops.front();
+  unsigned bestLoad = best->load();
+  for ( unsigned i = 1; i < _loops.size(); ++i ) {
+    unsigned load = _loops[i]->load();
+    if ( load < bestLoad ) {
+      best = _loops[i];
+      bestLoad = load;
+    }
+  }
+
+  return *best;
 }
 
 }
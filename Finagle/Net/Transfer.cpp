@@ -115,7 +115,12 @@ void Processor::onSelect( fd_set &, fd_set &, fd_set & ) const
     if ( msg->msg != CURLMSG_DONE )  continue;
 
     map<void *, Request *>::const_iterator req = _reqMap.find( msg->easy_handle );
-    if ( req != _reqMap.end() )
-      req->second->recvBodyDone();
+    if ( req == _reqMap.end() )
+      continue;
+
+    CURLcode code = msg->data.result;
+    Request::Ptr done( req->second );  // in case a handler drops the last reference
+    done->recvBodyDone();
+    done->finish( code );
   }
 }
@@ -31,6 +31,7 @@ class RequestTest : public CppUnit::TestFixture, public boost::signals::trackabl
   CPPUNIT_TEST_SUITE( RequestTest );
   CPPUNIT_TEST( testCreateDestroy );
   CPPUNIT_TEST( testFetch );
+  CPPUNIT_TEST( testFuture );
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -38,6 +39,7 @@ public:
 
   void testCreateDestroy( void );
   void testFetch( void );
+  void testFuture( void );
 
 protected:
   void onBodyStart( String const &type, size_t size );
@@ -88,6 +90,21 @@ void RequestTest::testFetch( void )
 }
 
 
+void RequestTest::testFuture( void )
+{
+  URL url;
+  url.host( "www.finagle.org" );
+
+  _req = new Request( url );
+  Future<unsigned> done = _req->perform();
+  done.then( AppLoop::Loop::current(), boost::bind( &AppLoop::exit, 0 ) );
+  AppLoop::exec();
+
+  CPPUNIT_ASSERT( done.ready() );
+  CPPUNIT_ASSERT_EQUAL( 200U, done.get() );
+}
+
+
 void RequestTest::onBodyStart( String const &type, size_t size )
 {
   _type = type;
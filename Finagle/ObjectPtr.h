@@ -23,13 +23,50 @@
 #define FINAGLE_OBJECTPTR_H
 
 #include <exception>
+#include <boost/type_traits/is_convertible.hpp>
 #include <Finagle/ReferenceCount.h>
 #include <Finagle/TextString.h>
 
 namespace Finagle {
 
+template <typename Type, typename RType, typename PType>
+class ObjectPtr;
+
+//! Converts between pointer types: statically if \a Implicit (i.e. an upcast), otherwise with \c dynamic_cast
+template <bool Implicit>
+struct ObjectPtrCast {
+  template <typename ToPtr, typename FromPtr>
+  static ToPtr from( FromPtr ptr ) {  return dynamic_cast<ToPtr>( ptr );  }
+};
+
+template <>
+struct ObjectPtrCast<true> {
+  template <typename ToPtr, typename FromPtr>
+  static ToPtr from( FromPtr ptr ) {  return ptr;  }
+};
+
+//! An ObjectPtr being moved from (see move())
+template <typename Type, typename RType = Type &, typename PType = Type *>
+struct ObjectPtrMove {
+  explicit ObjectPtrMove( ObjectPtr<Type, RType, PType> &p ) : ptr( p ) {}
+  ObjectPtr<Type, RType, PType> &ptr;
+};
+
 /*! \brief Reference-counting smart pointer.
 **
+** Copying an ObjectPtr references the object again, and destroying (or
+** reassigning) one releases its reference.  To hand a reference from one
+** ObjectPtr to another without touching the count (which, for an
+** AtomicReferenceCount, is an atomic operation each way), move() it:
+** \code
+** Socket::Ptr sock = Finagle::move( accepted );  // accepted is now 0
+** \endcode
+**
+** Converting from a pointer to a derived type is a plain (static) conversion;
+** from any other type it uses \c dynamic_cast (yielding \c 0 if the object
+** isn't a \a Type).  Use staticCast() to downcast an object whose type is
+** already known.
+**
 ** \sa ReferenceCount, ObjectPtrIterator and ObjectPtrConstIterator.
 */
 template <typename Type, typename RType = Type &, typename PType = Type *>
@@ -58,11 +95,14 @@ public:
   ObjectPtr( PtrType ptr = 0 );
   ObjectPtr( RefType ref );
   ObjectPtr( ObjectPtr<Type,RType,PType> const &ref );
+  ObjectPtr( ObjectPtrMove<Type,RType,PType> from );
   template <typename OtherType>  explicit ObjectPtr( OtherType *ptr );
   template <typename OtherType>  explicit ObjectPtr( ObjectPtr<OtherType> const &ref );
  ~ObjectPtr( void );
 
-  ObjectPtr &operator =( ObjectPtr<Type,RType,PType> ref );
+  ObjectPtr &operator =( ObjectPtr<Type,RType,PType> const &ref );
+  ObjectPtr &operator =( ObjectPtrMove<Type,RType,PType> from );
+  void swap( ObjectPtr<Type,RType,PType> &ref );
 
   operator bool( void ) const;
   bool operator ==( ObjectPtr<Type,RType,PType> const &ref ) const;
@@ -199,44 +239,86 @@ inline bool ObjectPtr<Type, RType, PType>::operator ==( PtrType ptr ) const
 }
 
 
-/*! \brief Initializes the reference to point to the derived object \a ptr.
+/*! \brief Initializes the reference to point to the related object \a ptr.
 **
-** Uses \c dynamic_cast to convert the object of \a OtherType to \a Type.
+** Converts a derived \a OtherType statically, and any other with \c dynamic_cast (which yields \c 0 if the object isn't a
+** \a Type).
 */
 template <typename Type, typename RType, typename PType>
 template <typename OtherType>
 ObjectPtr<Type, RType, PType>::ObjectPtr( OtherType *ptr )
-: _ptr( dynamic_cast<PtrType>( ptr ) )
+: _ptr( ObjectPtrCast<boost::is_convertible<OtherType *, PtrType>::value>::template from<PtrType>( ptr ) )
 {
   if ( _ptr )  _ptr->ref();
 }
 
-/*! \brief Initializes the reference to point to the derived object \a ref.
+/*! \brief Initializes the reference to point to the related object \a ref.
 **
-** Uses \c dynamic_cast and \c const_cast to convert the object of \a OtherType to \a Type.
+** Converts a derived \a OtherType statically, and any other with \c dynamic_cast (which yields \c 0 if the object isn't a
+** \a Type).
 */
 template <typename Type, typename RType, typename PType>
 template <typename OtherType>
 ObjectPtr<Type, RType, PType>::ObjectPtr( ObjectPtr<OtherType> const &ref )
-: _ptr( dynamic_cast<PtrType>( typename ObjectPtr<OtherType>::PtrType( const_cast<ObjectPtr<OtherType> &>( ref ) ) ) )
+: _ptr( ObjectPtrCast<boost::is_convertible<OtherType *, PtrType>::value>::template from<PtrType>(
+          typename ObjectPtr<OtherType>::PtrType( const_cast<ObjectPtr<OtherType> &>( ref ) ) ) )
 {
   if ( _ptr )  _ptr->ref();
 }
 
-//! Assignment operator
+/*! \brief Assignment operator
+**
+** References the new object before releasing the old one, so assigning an object to itself (or to something it owns) is
+** safe.
+*/
 template <typename Type, typename RType, typename PType>
-ObjectPtr<Type, RType, PType> &ObjectPtr<Type, RType, PType>::operator =( ObjectPtr<Type,RType,PType> ref )
+ObjectPtr<Type, RType, PType> &ObjectPtr<Type, RType, PType>::operator =( ObjectPtr<Type,RType,PType> const &ref )
 {
-  if ( ref._ptr )
-    ref._ptr->ref();
+  PtrType ptr = ref._ptr;
+  if ( ptr )
+    ptr->ref();
 
-  if ( _ptr && _ptr->deref() )
-    delete _ptr;
+  PtrType old = _ptr;
+  _ptr = ptr;
+  if ( old && old->deref() )
+    delete old;
+
+  return *this;
+}
+
+//! Takes over the reference held by \a from (leaving it \c 0), without touching the object's reference count.
+template <typename Type, typename RType, typename PType>
+inline ObjectPtr<Type, RType, PType>::ObjectPtr( ObjectPtrMove<Type,RType,PType> from )
+: _ptr( from.ptr._ptr )
+{
+  from.ptr._ptr = 0;
+}
+
+//! Takes over the reference held by \a from (leaving it \c 0), releasing the old one.
+template <typename Type, typename RType, typename PType>
+ObjectPtr<Type, RType, PType> &ObjectPtr<Type, RType, PType>::operator =( ObjectPtrMove<Type,RType,PType> from )
+{
+  if ( &from.ptr == this )
+    return *this;
+
+  PtrType old = _ptr;
+  _ptr = from.ptr._ptr;
+  from.ptr._ptr = 0;
+  if ( old && old->deref() )
+    delete old;
 
-  _ptr = ref._ptr;
   return *this;
 }
 
+//! Exchanges the objects referenced by this and \a ref (without touching their reference counts).
+template <typename Type, typename RType, typename PType>
+inline void ObjectPtr<Type, RType, PType>::swap( ObjectPtr<Type,RType,PType> &ref )
+{
+  PtrType ptr = _ptr;
+  _ptr = ref._ptr;
+  ref._ptr = ptr;
+}
+
 /*! \brief Returns a const-reference to the object.
 **
 ** Will throw NullRefEx if the object reference is \c 0.
@@ -310,8 +392,39 @@ inline ObjectPtr<Type, RType, PType>::operator PType( void )
   return _ptr;
 }
 
+/*! \brief Marks \a ptr to be moved from, when constructing or assigning another ObjectPtr.
+**
+** The reference is handed over without touching the object's reference count, and \a ptr is left \c 0.
+*/
+template <typename Type, typename RType, typename PType>
+inline ObjectPtrMove<Type, RType, PType> move( ObjectPtr<Type, RType, PType> &ptr )
+{
+  return ObjectPtrMove<Type, RType, PType>( ptr );
+}
+
+/*! \brief Returns \a ref, downcast to \a Type without \c dynamic_cast.
+**
+** The object must be a \a Type (or the result is undefined).
+*/
+template <typename Type, typename OtherType>
+inline ObjectPtr<Type> staticCast( ObjectPtr<OtherType> const &ref )
+{
+  return ObjectPtr<Type>( static_cast<Type *>( (OtherType *) const_cast<ObjectPtr<OtherType> &>( ref ) ) );
+}
+
 // PASS-THROUGH OPERATORS ---------------------------------------------------------------------------------------------------------
 
+//! Exchanges the objects referenced by \a a and \a b (see ObjectPtr::swap()).
+template <typename Type, typename RType, typename PType>
+inline void swap( ObjectPtr<Type, RType, PType> &a, ObjectPtr<Type, RType, PType> &b )
+{
+  a.swap( b );
+}
+
+//! Queues hand ObjectPtrs out by swapping, rather than copying them (and so touching the reference counts)
+template <typename Type, typename RType, typename PType>
+struct QueueSwaps<ObjectPtr<Type, RType, PType> > {  static const bool value = true;  };
+
 //! Pass-through operator
 template <typename Type>
 inline bool operator <( ObjectPtr<Type> const &a, ObjectPtr<Type> const &b )
@@ -0,0 +1,206 @@
+/*!
+** \file Parallel.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+
+#include <unistd.h>
+
+#include "Parallel.h"
+#include "SpinMutex.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::Parallel
+** \brief Non-template parts of the parallel algorithms (parallelFor(), parallelTransform(), parallelReduce(),
+** parallelMapReduce() and parallelSort()).
+**
+** Each algorithm splits its input into equal chunks, which are claimed one at a time by the calling thread and by
+** helpers posted to a ThreadPool (by default, a pool shared by the whole process), so faster threads take more chunks.
+** The calling thread works too, and waits only for chunks which have already been claimed, so the algorithms may be
+** used from a pool's own workers (including within another algorithm's chunk) without deadlocking.
+**
+** Chunks are sized so that each one's elements fit in half the per-core cache (see cacheSize()), but small enough that
+** each thread gets at least #ChunksPerThread of them.  Inputs which are too small to be worth waking the pool for
+** are processed serially, on the calling thread.
+**
+** Example: \code
+** Array<File> files = ...;
+** Array<String> digests;
+** parallelTransform( files, digests, boost::bind( &File::digest, _1 ) );
+** parallelSort( digests );
+** \endcode
+*/
+
+//! The shared state of a run(): the next chunk to claim, and the number finished
+class Parallel::Job : public AtomicReferenceCount {
+public:
+  typedef ObjectPtr<Job> Ptr;
+
+  //! Posted to the pool, to help with the chunks
+  struct Help {
+    Help( Ptr const &j ) : job( j ) {}
+    void operator()( void ) {  job->work();  }
+    Ptr job;
+  };
+
+public:
+  Job( size_t count, size_t grain, Body const &body );
+
+  void work( void );
+
+public:
+  Promise<void> finished;
+
+protected:
+  void fail( String const &error );
+
+protected:
+  size_t _count, _grain, _chunks;
+  Body _body;
+  size_t volatile _next;      //!< The next chunk to claim
+  size_t volatile _done;      //!< Chunks finished (or skipped)
+  int volatile _failed;
+  SpinMutex _guard;           //!< Guards #_error
+  String _error;              //!< The first failure
+};
+
+
+//! Returns the pool shared by the parallel algorithms, with one worker per processor (created on first use, and never destroyed).
+ThreadPool &Parallel::pool( void )
+{
+  static ThreadPool *p = new ThreadPool;
+  return *p;
+}
+
+
+//! Returns the size of each core's (level 2) cache, in bytes.
+size_t Parallel::cacheSize( void )
+{
+  static size_t size = 0;
+  if ( !size ) {
+    long l2 = sysconf( _SC_LEVEL2_CACHE_SIZE );
+    size = (l2 > 0) ? size_t( l2 ) : 256 * 1024;
+  }
+
+  return size;
+}
+
+
+/*! \brief Returns the number of elements per chunk, for \a count elements of \a elementSize bytes each, on \a pool.
+**
+** Returns \a requested, if it's non-zero.  Otherwise, returns \a count (i.e. one chunk, to be run serially) for small
+** inputs, or the smaller of a chunk which fits in half the cache and one which gives each thread #ChunksPerThread
+** chunks.  An \a elementSize of \c 0 means the cost of each element is unknown (e.g. for index ranges), so chunks are
+** sized for balance alone.
+*/
+size_t Parallel::grain( size_t requested, size_t count, size_t elementSize, ThreadPool const &pool )
+{
+  if ( requested )
+    return requested;
+
+  if ( elementSize ? (count * elementSize <= SerialLimit) : (count <= SerialIterations) )
+    return max( count, size_t( 1 ) );
+
+  size_t balanced = max( count / (ChunksPerThread * (pool.size() + 1)), size_t( 1 ) );
+  if ( !elementSize )
+    return balanced;
+
+  size_t cached = max( cacheSize() / (2 * elementSize), size_t( 1 ) );
+  return min( cached, balanced );
+}
+
+
+/*! \brief Calls \a body for each chunk of \a grain (or fewer, for the last) of \a count elements, on the calling thread
+** and on \a pool, and returns once all of them are done.
+**
+** If \a body throws, the remaining chunks are skipped, and an Exception describing the first failure is thrown.
+*/
+void Parallel::run( size_t count, size_t grain, Body const &body, ThreadPool &pool )
+{
+  if ( !count )
+    return;
+
+  size_t chunks = (count + grain - 1) / grain;
+  if ( (chunks == 1) || pool.closed() ) {
+    body( 0, count );
+    return;
+  }
+
+  Job::Ptr job( new Job( count, grain, body ) );
+  Future<void> finished = job->finished.future();
+
+  // Late helpers find nothing left to claim, and return at once
+  unsigned helpers = min( chunks - 1, size_t( pool.size() ) );
+  for ( unsigned i = 0; i < helpers; ++i )
+    pool.post( Job::Help( job ) );
+
+  job->work();
+  finished.wait();
+  if ( finished.failed() )
+    throw Exception( finished.error() );
+}
+
+
+Parallel::Job::Job( size_t count, size_t grain, Body const &body )
+: _count( count ), _grain( grain ), _chunks( (count + grain - 1) / grain ), _body( body ), _next( 0 ), _done( 0 ),
+  _failed( 0 )
+{}
+
+//! Claims and runs chunks until none are left, completing #finished after the last.
+void Parallel::Job::work( void )
+{
+  for ( ;; ) {
+    size_t chunk = __sync_fetch_and_add( &_next, 1 );
+    if ( chunk >= _chunks )
+      return;
+
+    if ( !_failed ) {
+      size_t begin = chunk * _grain;
+      try {
+        _body( begin, min( begin + _grain, _count ) );
+      }
+      catch ( std::exception &ex ) {
+        fail( ex.what() );
+      }
+      catch ( ... ) {
+        fail( "Unknown exception" );
+      }
+    }
+
+    if ( __sync_add_and_fetch( &_done, 1 ) == _chunks ) {
+      if ( _failed )
+        finished.setError( _error );
+      else
+        finished.setValue();
+    }
+  }
+}
+
+//! Records the first failure, so the remaining chunks are skipped.
+void Parallel::Job::fail( String const &error )
+{
+  SpinLock _( _guard );
+  if ( !_failed ) {
+    _error = error;
+    _failed = 1;
+  }
+}
@@ -0,0 +1,282 @@
+/*!
+** \file Parallel.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#ifndef FINAGLE_PARALLEL_H
+#define FINAGLE_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <boost/function.hpp>
+#include <Finagle/Array.h>
+#include <Finagle/ThreadPool.h>
+
+namespace Finagle {
+
+//! Non-template parts of the parallel algorithms (parallelFor(), parallelTransform(), parallelReduce(), parallelSort()).
+class Parallel {
+public:
+  //! Processes the elements (or iterations) [\a begin, \a end) of one chunk
+  typedef boost::function< void( size_t begin, size_t end ) > Body;
+
+  static const size_t   SerialLimit = 32768;      //!< Arrays of up to this many bytes are processed serially
+  static const size_t   SerialIterations = 1024;  //!< Index ranges of up to this many iterations are run serially
+  static const unsigned ChunksPerThread = 4;      //!< Chunks per thread (at least), so faster threads can take more
+
+public:
+  static ThreadPool &pool( void );
+  static size_t cacheSize( void );
+
+  static size_t grain( size_t requested, size_t count, size_t elementSize, ThreadPool const &pool );
+  static void run( size_t count, size_t grain, Body const &body, ThreadPool &pool );
+
+public:
+  // Chunk bodies for the algorithms
+
+  template <typename Func>
+  struct ForIndex {
+    ForIndex( size_t o, Func &f ) : offset( o ), func( f ) {}
+    void operator()( size_t b, size_t e ) {  for ( ; b < e; ++b )  func( offset + b );  }
+    size_t offset;
+    Func &func;
+  };
+
+  template <typename Iterator, typename Func>
+  struct ForEach {
+    ForEach( Iterator i, Func &f ) : it( i ), func( f ) {}
+    void operator()( size_t b, size_t e ) {  std::for_each( it + b, it + e, func );  }
+    Iterator it;
+    Func &func;
+  };
+
+  template <typename InIterator, typename OutIterator, typename Func>
+  struct Transform {
+    Transform( InIterator i, OutIterator o, Func &f ) : in( i ), out( o ), func( f ) {}
+    void operator()( size_t b, size_t e ) {  std::transform( in + b, in + e, out + b, func );  }
+    InIterator in;
+    OutIterator out;
+    Func &func;
+  };
+
+  template <typename Iterator, typename Result, typename Map, typename Reduce>
+  struct MapReduce {
+    MapReduce( Iterator i, Result *p, size_t g, Result const &id, Map &m, Reduce &r )
+    : it( i ), partials( p ), grain( g ), identity( id ), map( m ), reduce( r ) {}
+    void operator()( size_t b, size_t e ) {
+      Result acc = identity;
+      for ( Iterator el = it + b; el != it + e; ++el )
+        acc = reduce( acc, map( *el ) );
+      partials[b / grain] = acc;
+    }
+    Iterator it;
+    Result *partials;
+    size_t grain;
+    Result const &identity;
+    Map &map;
+    Reduce &reduce;
+  };
+
+  //! Stands in for the map of a parallelReduce()
+  template <typename Type>
+  struct Identity {
+    Type const &operator()( Type const &t ) const {  return t;  }
+  };
+
+  template <typename Iterator, typename Compare>
+  struct SortRun {
+    SortRun( Iterator i, Compare &c ) : it( i ), comp( c ) {}
+    void operator()( size_t b, size_t e ) {  std::sort( it + b, it + e, comp );  }
+    Iterator it;
+    Compare &comp;
+  };
+
+  /*! \brief Merges pairs of adjacent sorted runs of \a width elements from \a in into \a out.
+  **
+  ** Each chunk is a range of the output (so even a single pair is merged in parallel), whose inputs are found by binary
+  ** search.
+  */
+  template <typename Iterator, typename Compare>
+  struct MergeRuns {
+    MergeRuns( Iterator i, Iterator o, size_t n, size_t w, Compare &c )
+    : in( i ), out( o ), count( n ), width( w ), comp( c ) {}
+    void operator()( size_t b, size_t e ) {
+      while ( b < e ) {
+        size_t lo = b - b % (2 * width), mid = std::min( lo + width, count ), hi = std::min( lo + 2 * width, count );
+        size_t end = std::min( e, hi ), m = mid - lo, n = hi - mid;
+        size_t i = split( in + lo, m, in + mid, n, b - lo ), j = split( in + lo, m, in + mid, n, end - lo );
+        std::merge( in + lo + i, in + lo + j, in + mid + (b - lo - i), in + mid + (end - lo - j), out + b, comp );
+        b = end;
+      }
+    }
+    //! Returns how many of the first \a k elements merged from runs \a a (of \a m) and \a b (of \a n) come from \a a.
+    size_t split( Iterator a, size_t m, Iterator b, size_t n, size_t k ) const {
+      size_t lo = (k > n) ? k - n : 0, hi = std::min( k, m );
+      while ( lo < hi ) {
+        size_t i = lo + (hi - lo) / 2;
+        if ( comp( b[k - i - 1], a[i] ) )
+          hi = i;
+        else
+          lo = i + 1;
+      }
+      return lo;
+    }
+    Iterator in, out;
+    size_t count, width;
+    Compare &comp;
+  };
+
+protected:
+  class Job;
+};
+
+// TEMPLATE IMPLEMENTATION ********************************************************************************************************
+
+/*! \brief Calls \a func( \e i ) for each \e i in [\a begin, \a end), in parallel on \a pool (and the calling thread).
+**
+** The range is split into chunks of \a grain iterations (or, if \c 0, enough for Parallel::ChunksPerThread per thread),
+** and ranges of up to Parallel::SerialIterations are run serially.  Returns once every iteration has run; if any throws,
+** the remaining chunks are skipped, and a Finagle::Exception describing the first failure is thrown.
+*/
+template <typename Func>
+void parallelFor( size_t begin, size_t end, Func func, ThreadPool &pool = Parallel::pool(), size_t grain = 0 )
+{
+  if ( begin >= end )
+    return;
+
+  size_t count = end - begin;
+  Parallel::run( count, Parallel::grain( grain, count, 0, pool ), Parallel::ForIndex<Func>( begin, func ), pool );
+}
+
+/*! \brief Calls \a func( \e element ) for each element of \a array, in parallel on \a pool (and the calling thread).
+**
+** The array is split into chunks of \a grain elements (or, if \c 0, chunks which fit in the cache; see
+** Parallel::grain()), and arrays of up to Parallel::SerialLimit bytes are processed serially.  Exceptions are handled
+** as for the index version.
+*/
+template <typename Type, typename AllocType, typename Func>
+void parallelFor( Array<Type, AllocType> &array, Func func, ThreadPool &pool = Parallel::pool(), size_t grain = 0 )
+{
+  typedef typename Array<Type, AllocType>::Iterator Iterator;
+
+  size_t count = array.size();
+  grain = Parallel::grain( grain, count, sizeof(Type), pool );
+  Parallel::run( count, grain, Parallel::ForEach<Iterator, Func>( array.begin(), func ), pool );
+}
+
+/*! \brief Sets each element of \a out to \a func( \e element ) of the corresponding element of \a in, in parallel.
+**
+** \a out is resized to match \a in, and may be the same array.  Chunking and exceptions are as for parallelFor().
+*/
+template <typename InType, typename InAlloc, typename OutType, typename OutAlloc, typename Func>
+void parallelTransform( Array<InType, InAlloc> const &in, Array<OutType, OutAlloc> &out, Func func,
+                        ThreadPool &pool = Parallel::pool(), size_t grain = 0 )
+{
+  typedef typename Array<InType, InAlloc>::ConstIterator InIterator;
+  typedef typename Array<OutType, OutAlloc>::Iterator OutIterator;
+
+  size_t count = in.size();
+  out.resize( count );
+  grain = Parallel::grain( grain, count, sizeof(InType) + sizeof(OutType), pool );
+  Parallel::run( count, grain, Parallel::Transform<InIterator, OutIterator, Func>( in.begin(), out.begin(), func ), pool );
+}
+
+/*! \brief Maps each element of \a array, and combines the results, in parallel.
+**
+** Each chunk folds its elements into a copy of \a identity, as \c acc \c = \a reduce( \c acc, \a map( \e element ) ),
+** and the chunks' results are then folded in order, so the result is deterministic as long as \a reduce is
+** associative (it need not be commutative).  Chunking and exceptions are as for parallelFor().
+**
+** Example: \code
+** size_t bytes = parallelMapReduce( files, size_t( 0 ), boost::bind( &File::size, _1 ), std::plus<size_t>() );
+** \endcode
+*/
+template <typename Type, typename AllocType, typename Result, typename Map, typename Reduce>
+Result parallelMapReduce( Array<Type, AllocType> const &array, Result identity, Map map, Reduce reduce,
+                          ThreadPool &pool = Parallel::pool(), size_t grain = 0 )
+{
+  typedef typename Array<Type, AllocType>::ConstIterator Iterator;
+
+  size_t count = array.size();
+  if ( !count )
+    return identity;
+
+  grain = Parallel::grain( grain, count, sizeof(Type), pool );
+  Array<Result> partials( (count + grain - 1) / grain, identity );
+  Parallel::run( count, grain, Parallel::MapReduce<Iterator, Result, Map, Reduce>( array.begin(), &partials.front(), grain,
+                                                                                   identity, map, reduce ), pool );
+
+  Result result = partials.front();
+  for ( typename Array<Result>::ConstIterator p = partials.begin() + 1; p != partials.end(); ++p )
+    result = reduce( result, *p );
+
+  return result;
+}
+
+//! Combines the elements of \a array, as \a reduce( \a reduce( \a identity, \e first ), \e second ) ..., in parallel (see parallelMapReduce()).
+template <typename Type, typename AllocType, typename Reduce>
+Type parallelReduce( Array<Type, AllocType> const &array, Type identity, Reduce reduce,
+                     ThreadPool &pool = Parallel::pool(), size_t grain = 0 )
+{
+  return parallelMapReduce( array, identity, Parallel::Identity<Type>(), reduce, pool, grain );
+}
+
+/*! \brief Sorts \a array, ordered by \a comp, in parallel.
+**
+** Sorts chunks of \a grain elements (see parallelFor()) in parallel with \c std::sort, then merges adjacent runs
+** pairwise until one run is left.  Each round of merging is split into chunks of the output, so even the last round
+** (a single merge of the two halves) runs in parallel.  The merges alternate between \a array and a copy of it.  Like
+** \c std::sort, the sort isn't stable.
+*/
+template <typename Type, typename AllocType, typename Compare>
+void parallelSort( Array<Type, AllocType> &array, Compare comp, ThreadPool &pool = Parallel::pool(), size_t grain = 0 )
+{
+  typedef typename Array<Type, AllocType>::Iterator Iterator;
+
+  size_t count = array.size();
+  grain = Parallel::grain( grain, count, sizeof(Type), pool );
+  Parallel::run( count, grain, Parallel::SortRun<Iterator, Compare>( array.begin(), comp ), pool );
+
+  if ( grain >= count )
+    return;
+
+  Array<Type, AllocType> buffer( array );
+  Array<Type, AllocType> *from = &array, *to = &buffer;
+  for ( size_t width = grain; width < count; width *= 2 ) {
+    Parallel::run( count, grain, Parallel::MergeRuns<Iterator, Compare>( from->begin(), to->begin(), count, width, comp ),
+                   pool );
+    std::swap( from, to );
+  }
+
+  if ( from != &array )
+    array.swap( buffer );
+}
+
+//! Sorts \a array in ascending order, in parallel (see above).
+template <typename Type, typename AllocType>
+void parallelSort( Array<Type, AllocType> &array, ThreadPool &pool = Parallel::pool(), size_t grain = 0 )
+{
+  parallelSort( array, std::less<Type>(), pool, grain );
+}
+
+}
+
+#endif
@@ -19,28 +19,61 @@
 ** at http://www.gnu.org/copyleft/lesser.html .
 */
 
+
 #ifndef FINAGLE_PRIORITYQUEUE_H
 #define FINAGLE_PRIORITYQUEUE_H
 
+#include <algorithm>
+#include <stdint.h>
+#include <Finagle/Array.h>
 #include <Finagle/DateTime.h>
+#include <Finagle/Queue.h>
 #include <Finagle/WaitCondition.h>
-#include <Finagle/MultiMap.h>
 
 namespace Finagle {
 
-//! Generic thread-safe prioritized queue
+/*! \brief Generic thread-safe prioritized queue
+**
+** Items are kept in an array-backed 4-ary heap, so that a push or pop costs no allocation (beyond the array's growth),
+** and O(log n) comparisons within a few cache lines.  Higher priorities are popped first, and items of equal priority
+** in the order in which they were pushed.
+**
+** An item pushed with push_handle() may later be erase()d or reprioritize()d (e.g. to cancel or bump a queued job),
+** also in O(log n).  Handles remain safe to use after their item has been popped: they simply no longer match.
+*/
 template <typename Type, typename PriType = double>
-class PriorityQueue : protected MultiMap<PriType, Type, std::greater<PriType> > {
+class PriorityQueue {
+public:
+  //! Identifies an item pushed with push_handle() (never \c 0)
+  typedef uint64_t Handle;
+
+  static const unsigned Arity = 4;
+
 public:
-  PriorityQueue( void ) {}
+  PriorityQueue( void ) : _pushed( 0 ), _guard( "PriorityQueue" ) {}
 
   bool empty( void ) const;
   unsigned size( void ) const;
 
   void push( Type const &el, PriType const &pri = 0 );
+  void push_swap( Type &el, PriType const &pri = 0 );
   Type pop( void );
   bool pop( Type &dest, Time timeout = 0 );
 
+  template <typename InputIterator>
+  void push_range( InputIterator begin, InputIterator end, PriType const &pri = 0 );
+
+  template <typename Container>
+  unsigned pop_all( Container &dest );
+
+  template <typename Container>
+  unsigned pop_up_to( unsigned max, Container &dest, Time timeout = 0 );
+
+  Handle push_handle( Type const &el, PriType const &pri = 0 );
+  bool contains( Handle handle ) const;
+  bool erase( Handle handle );
+  bool reprioritize( Handle handle, PriType const &pri );
+
 public:
   template <typename Functor>
   void whenNotEmpty( Functor &func );
@@ -49,20 +82,36 @@ public:
   bool ifNotEmpty( Functor &func, Time timeout = 0 );
 
 protected:
-  typedef MultiMap<PriType, Type, std::greater<PriType> > Map;
-  typedef typename Map::ConstIterator ConstIterator;
-  typedef typename Map::Iterator Iterator;
-  typedef typename Map::ConstReverseIterator ConstReverseIterator;
-  typedef typename Map::ReverseIterator ReverseIterator;
+  struct Entry {
+    PriType pri;
+    unsigned seq;   //!< Push order, to keep items of equal priority FIFO
+    unsigned slot;  //!< Index (plus one) of the item's handle slot, or \c 0
+    Type val;
+  };
+
+  //! Tracks the heap position of an item pushed with push_handle()
+  struct Slot {
+    unsigned pos;  //!< Index in #_heap (or \c ~0 if free)
+    unsigned gen;  //!< Incremented each time the slot is freed, to invalidate old handles
+  };
+
+  bool before( Entry const &a, Entry const &b ) const;
+  Entry &insert( PriType const &pri );
+  void popTop( Type &dest );
+  void remove( unsigned pos );
+  static void move( Entry &dest, Entry &src );
+  void place( unsigned pos, Entry &src );
+  void siftUp( unsigned pos );
+  unsigned bestChild( unsigned pos ) const;
+  void siftDown( unsigned pos );
+  unsigned position( Handle handle ) const;
 
 protected:  // functors
   class FrontPopper {
   public:
     FrontPopper( Type &dest ) : _dest(dest) {}
     void operator()( PriorityQueue<Type, PriType> &queue ) {
-      typename Map::Iterator i( queue.begin() );
-      _dest = *i;
-      queue.erase( i );
+      queue.popTop( _dest );
     }
 
   protected:
@@ -70,9 +119,34 @@ protected:  // functors
   };
   friend class FrontPopper;
 
+  template <typename Container>
+  class RangePopper {
+  public:
+    RangePopper( Container &dest, unsigned max ) : count(0), _dest(dest), _max(max) {}
+    void operator()( PriorityQueue<Type, PriType> &queue ) {
+      for ( ; !queue._heap.empty() && (count < _max); ++count ) {
+        _dest.push_back( Type() );
+        queue.popTop( _dest.back() );
+      }
+    }
+
+  public:
+    unsigned count;
+
+  protected:
+    Container &_dest;
+    unsigned _max;
+  };
+  template <typename Container> friend class RangePopper;
+
 protected:
+  Array<Entry> _heap;
+  unsigned _pushed;
+  Array<Slot> _slots;
+  Array<unsigned> _freeSlots;
+
   mutable Mutex _guard;
-  WaitCondition _notEmpty;
+  Condition _notEmpty;  //!< Signalled (under #_guard) as items are added
 };
 
 // INLINE IMPLEMENTATION ******************************************************
@@ -82,7 +156,7 @@ template <typename Type, typename PriType>
 inline bool PriorityQueue<Type, PriType>::empty( void ) const
 {
   Lock _( _guard );
-  return Map::empty();
+  return _heap.empty();
 }
 
 //! Returns the number of items in the queue.
@@ -90,7 +164,7 @@ template <typename Type, typename PriType>
 inline unsigned PriorityQueue<Type, PriType>::size( void ) const
 {
   Lock _( _guard );
-  return Map::size();
+  return _heap.size();
 }
 
 //! Adds an item to the queue
@@ -98,7 +172,19 @@ template <typename Type, typename PriType>
 inline void PriorityQueue<Type, PriType>::push( Type const &el, PriType const &pri )
 {
   Lock _( _guard );
-  Map::insert( pri, el );
+  insert( pri ).val = el;
+  siftUp( _heap.size() - 1 );
+  _notEmpty.signalOne();
+}
+
+//! Adds an item to the queue, by swapping it with \a el (which is left default-constructed), rather than copying it.
+template <typename Type, typename PriType>
+inline void PriorityQueue<Type, PriType>::push_swap( Type &el, PriType const &pri )
+{
+  using std::swap;
+  Lock _( _guard );
+  swap( insert( pri ).val, el );
+  siftUp( _heap.size() - 1 );
   _notEmpty.signalOne();
 }
 
@@ -121,23 +207,128 @@ inline bool PriorityQueue<Type, PriType>::pop( Type &dest, Time timeout )
   return ifNotEmpty( p, timeout );
 }
 
+//! Adds the items in [\a begin, \a end) to the queue, all with priority \a pri, taking the lock once, and waking a waiter
+//! per item.
+template <typename Type, typename PriType>
+template <typename InputIterator>
+void PriorityQueue<Type, PriType>::push_range( InputIterator begin, InputIterator end, PriType const &pri )
+{
+  if ( begin == end )
+    return;
+
+  Lock _( _guard );
+  unsigned count = 0;
+  for ( ; begin != end; ++begin, ++count ) {
+    insert( pri ).val = *begin;
+    siftUp( _heap.size() - 1 );
+  }
+  _notEmpty.signal( count );
+}
+
+//! Moves every item in the queue to the end of \a dest, highest priority first (without blocking).
+//! Returns the number of items moved.
+template <typename Type, typename PriType>
+template <typename Container>
+unsigned PriorityQueue<Type, PriType>::pop_all( Container &dest )
+{
+  RangePopper<Container> p( dest, ~0U );
+  Lock _( _guard );
+  p( *this );
+  return p.count;
+}
+
+//! Moves up to \a max of the highest-priority items to the end of \a dest, waiting up to \a timeout for the first.
+//! Returns the number of items moved.
+template <typename Type, typename PriType>
+template <typename Container>
+unsigned PriorityQueue<Type, PriType>::pop_up_to( unsigned max, Container &dest, Time timeout )
+{
+  RangePopper<Container> p( dest, max );
+  ifNotEmpty( p, timeout );
+  return p.count;
+}
+
+
+//! Adds an item to the queue, and returns a handle with which it may be erase()d or reprioritize()d until it's popped.
+template <typename Type, typename PriType>
+typename PriorityQueue<Type, PriType>::Handle PriorityQueue<Type, PriType>::push_handle( Type const &el, PriType const &pri )
+{
+  Lock _( _guard );
+
+  unsigned slot;
+  if ( _freeSlots.empty() ) {
+    slot = _slots.size();
+    Slot s = { 0, 0 };
+    _slots.push_back( s );
+  } else {
+    slot = _freeSlots.back();
+    _freeSlots.pop_back();
+  }
+
+  Entry &entry = insert( pri );
+  entry.val = el;
+  entry.slot = slot + 1;
+  _slots[slot].pos = _heap.size() - 1;
+  siftUp( _heap.size() - 1 );
+  _notEmpty.signalOne();
+
+  return (Handle( _slots[slot].gen ) << 32) | (slot + 1);
+}
+
+//! Returns \c true iff the item pushed with \a handle is still queued.
+template <typename Type, typename PriType>
+inline bool PriorityQueue<Type, PriType>::contains( Handle handle ) const
+{
+  Lock _( _guard );
+  return position( handle ) != ~0U;
+}
+
+//! Removes the item pushed with \a handle.  Returns \c false if it's no longer queued.
+template <typename Type, typename PriType>
+bool PriorityQueue<Type, PriType>::erase( Handle handle )
+{
+  Lock _( _guard );
+  unsigned pos = position( handle );
+  if ( pos == ~0U )
+    return false;
+
+  remove( pos );
+  return true;
+}
+
+//! Changes the priority of the item pushed with \a handle to \a pri.  Returns \c false if it's no longer queued.
+//! The item is placed after any others already queued with the same priority.
+template <typename Type, typename PriType>
+bool PriorityQueue<Type, PriType>::reprioritize( Handle handle, PriType const &pri )
+{
+  Lock _( _guard );
+  unsigned pos = position( handle );
+  if ( pos == ~0U )
+    return false;
+
+  Entry &entry = _heap[pos];
+  bool raised = pri > entry.pri;
+  entry.pri = pri;
+  entry.seq = _pushed++;
+
+  if ( raised )
+    siftUp( pos );
+  else
+    siftDown( pos );
+  return true;
+}
+
+
 //! Calls functor \a func (passing the queue reference).  If the queue is empty, blocks until an item has been added.
 template <typename Type, typename PriType>
 template <typename Functor>
 void PriorityQueue<Type, PriType>::whenNotEmpty( Functor &func )
 {
-  _guard.lock();
-
-  while ( empty() ) {
-    _notEmpty.lock();
-    _guard.unlock();
-    _notEmpty.wait();
-    _guard.lock();
-    _notEmpty.unlock();
-  }
+  Lock _( _guard );
+  while ( _heap.empty() )
+    _notEmpty.wait( _guard );
 
   func( *this );
-  _guard.unlock();
 }
 
 //! Calls functor \a func (passing the queue reference) if the queue is not empty, or becomes non-empty before \a timeout, and returns \c true.
@@ -146,24 +337,183 @@ template <typename Type, typename PriType>
 template <typename Functor>
 bool PriorityQueue<Type, PriType>::ifNotEmpty( Functor &func, Time timeout )
 {
-  _guard.lock();
+  Lock _( _guard );
+  if ( _heap.empty() && (timeout > 0.0) ) {
+    Time deadline = Time::now() + timeout;
+    while ( _heap.empty() && _notEmpty.wait( _guard, deadline ) )
+      ;
+  }
 
-  if ( empty() ) {
-    _notEmpty.lock();
-    _guard.unlock();
+  if ( _heap.empty() )
+    return false;
 
-    if ( !_notEmpty.wait( timeout ) || empty() ) {
-      _notEmpty.unlock();
-      return false;
-    }
+  func( *this );
+  return true;
+}
+
+
+//! Returns \c true iff \a a should be popped before \a b.
+template <typename Type, typename PriType>
+inline bool PriorityQueue<Type, PriType>::before( Entry const &a, Entry const &b ) const
+{
+  if ( a.pri > b.pri )
+    return true;
+  if ( b.pri > a.pri )
+    return false;
 
-    _guard.lock();
-    _notEmpty.unlock();
+  return int( a.seq - b.seq ) < 0;
+}
+
+//! Appends an entry with priority \a pri to the end of the heap (to be filled in, then sifted up).
+template <typename Type, typename PriType>
+inline typename PriorityQueue<Type, PriType>::Entry &PriorityQueue<Type, PriType>::insert( PriType const &pri )
+{
+  // Grow by moving the entries across (see move()), as a reallocating resize would copy each one
+  if ( _heap.size() == _heap.capacity() ) {
+    Array<Entry> heap;
+    heap.reserve( std::max<size_t>( 2 * _heap.capacity(), 16 ) );
+    heap.resize( _heap.size() );
+    for ( unsigned i = 0; i < _heap.size(); ++i )
+      move( heap[i], _heap[i] );
+    _heap.swap( heap );
   }
 
-  func( *this );
-  _guard.unlock();
-  return true;
+  _heap.resize( _heap.size() + 1 );
+  Entry &entry = _heap.back();
+  entry.pri = pri;
+  entry.seq = _pushed++;
+  entry.slot = 0;
+  return entry;
+}
+
+//! Hands the highest-priority item out to \a dest (see QueueSwaps), and removes it.
+template <typename Type, typename PriType>
+inline void PriorityQueue<Type, PriType>::popTop( Type &dest )
+{
+  QueueTransfer<Type>::take( dest, _heap.front().val );
+  remove( 0 );
+}
+
+//! Removes the entry at \a pos, freeing its handle slot (if any).
+template <typename Type, typename PriType>
+void PriorityQueue<Type, PriType>::remove( unsigned pos )
+{
+  if ( unsigned slot = _heap[pos].slot ) {
+    _slots[slot - 1].pos = ~0U;
+    _slots[slot - 1].gen++;
+    _freeSlots.push_back( slot - 1 );
+  }
+
+  unsigned last = _heap.size() - 1;
+  if ( pos != last )
+    place( pos, _heap[last] );
+  _heap.pop_back();
+
+  if ( pos < last ) {
+    if ( (pos > 0) && before( _heap[pos], _heap[(pos - 1) / Arity] ) )
+      siftUp( pos );
+    else
+      siftDown( pos );
+  }
+}
+
+/*! \brief Moves entry \a src into \a dest, leaving \a src with whatever \a dest held.
+**
+** The item and priority are swapped rather than copied, so moving (e.g.) a String or an ObjectPtr through the heap
+** neither allocates nor touches a reference count; \a src is always a hole, or about to be dropped.
+*/
+template <typename Type, typename PriType>
+inline void PriorityQueue<Type, PriType>::move( Entry &dest, Entry &src )
+{
+  using std::swap;
+  swap( dest.pri, src.pri );
+  swap( dest.val, src.val );
+  dest.seq = src.seq;
+  dest.slot = src.slot;
+}
+
+//! Moves entry \a src into the heap at \a pos (see move()), and updates its handle slot (if any).
+template <typename Type, typename PriType>
+inline void PriorityQueue<Type, PriType>::place( unsigned pos, Entry &src )
+{
+  Entry &dest = _heap[pos];
+  move( dest, src );
+  if ( dest.slot )
+    _slots[dest.slot - 1].pos = pos;
+}
+
+/*! \brief Moves the entry at \a pos towards the root, until its parent comes before it.
+**
+** The entry is lifted out, leaving a hole which each parent it passes moves down into, and is placed once, at the end,
+** so each level moves one entry, rather than exchanging two.
+*/
+template <typename Type, typename PriType>
+void PriorityQueue<Type, PriType>::siftUp( unsigned pos )
+{
+  if ( pos == 0 )
+    return;
+
+  unsigned parent = (pos - 1) / Arity;
+  if ( !before( _heap[pos], _heap[parent] ) )
+    return;
+
+  Entry entry;
+  move( entry, _heap[pos] );
+  do {
+    place( pos, _heap[parent] );
+    pos = parent;
+    parent = (pos - 1) / Arity;
+  } while ( (pos > 0) && before( entry, _heap[parent] ) );
+
+  place( pos, entry );
+}
+
+//! Returns the position of whichever of \a pos's children comes first (or \c 0, if it has none).
+template <typename Type, typename PriType>
+inline unsigned PriorityQueue<Type, PriType>::bestChild( unsigned pos ) const
+{
+  unsigned first = pos * Arity + 1;
+  if ( first >= _heap.size() )
+    return 0;
+
+  unsigned best = first;
+  unsigned end = std::min<unsigned>( first + Arity, _heap.size() );
+  for ( unsigned child = first + 1; child < end; ++child )
+    if ( before( _heap[child], _heap[best] ) )
+      best = child;
+
+  return best;
+}
+
+//! Moves the entry at \a pos towards the leaves, until it comes before all of its children (through a hole, as siftUp()).
+template <typename Type, typename PriType>
+void PriorityQueue<Type, PriType>::siftDown( unsigned pos )
+{
+  unsigned child = bestChild( pos );
+  if ( !child || !before( _heap[child], _heap[pos] ) )
+    return;
+
+  Entry entry;
+  move( entry, _heap[pos] );
+  do {
+    place( pos, _heap[child] );
+    pos = child;
+    child = bestChild( pos );
+  } while ( child && before( _heap[child], entry ) );
+
+  place( pos, entry );
+}
+
+//! Returns the heap position of the queued item pushed with \a handle (or \c ~0, if it's been popped or removed).
+template <typename Type, typename PriType>
+inline unsigned PriorityQueue<Type, PriType>::position( Handle handle ) const
+{
+  unsigned slot = unsigned( handle & 0xffffffff );
+  if ( !slot || (slot > _slots.size()) )
+    return ~0U;
+
+  Slot const &s = _slots[slot - 1];
+  return (s.gen == unsigned( handle >> 32 )) ? s.pos : ~0U;
 }
 
 }
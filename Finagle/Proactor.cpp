@@ -0,0 +1,688 @@
+/*!
+** \file Proactor.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include "config.h"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include <boost/bind.hpp>
+
+#include "Proactor.h"
+#include "AppLog.h"
+#include "AppLoop.h"
+#include "Exception.h"
+#include "FileDescWatcher.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::Proactor
+** \brief Submits I/O operations, and delivers their completions on an application loop.
+**
+** Where the kernel supports it, operations are queued on an \c io_uring(7) submission ring, and submitted in a single
+** system call per loop iteration (see flush(), which the loop calls before it waits), so a receive or send costs no
+** more than its share of that call, rather than a readiness notification plus a \c read(2) or \c write(2).  The ring's
+** descriptor is watched by the loop's Reactor, and completions are reaped and delivered by the loop's thread.
+**
+** Without \c io_uring(7) (or on kernels too old to support the required operations), the proactor falls back, at
+** runtime, to the loop's \c epoll(7) or \c select(2) readiness notifications: socket operations are performed when
+** their descriptor becomes ready, and file operations are performed immediately.  In either case, handlers are only
+** ever called by the loop's thread, and never from within the call which submitted the operation.
+**
+** Operations are recycled once complete, so (given a handler small enough for \c boost::function to store in place)
+** steady-state I/O makes no heap allocations.  Buffers must remain valid until the operation's handler is called.
+**
+** \c epoll(7) allows only one registration per descriptor, so while the fallback has operations queued on a socket, no
+** FileDescWatcher may be watching it for events (e.g. a Socket with slots connected to \c readable).  The fallback
+** stops watching a descriptor as soon as it has nothing queued on it.  Before closing a descriptor with operations still
+** outstanding, cancel() them.
+**
+** \sa AppLoop::Loop::io() and Reactor.
+*/
+
+//! Submission ring size
+static const unsigned RingEntries = 256;
+
+
+//! Watches the ring's descriptor, and reaps completions when it's readable.
+class Proactor::RingWatcher : public FileDescWatchable {
+public:
+  RingWatcher( Proactor &proactor, AppLoop::Loop &loop ) : FileDescWatchable( loop ), _proactor( proactor ) {}
+
+protected:
+  int      watchFD( void ) const             {  return _proactor._ringFD;  }
+  unsigned watchEvents( void ) const         {  return Read;  }
+  void     onEvents( unsigned ) const        {  _proactor.reapRing();  }
+
+protected:
+  Proactor &_proactor;
+};
+
+
+//! Performs the fallback's queued socket operations on a descriptor as it becomes ready.
+class Proactor::FDWatcher : public FileDescWatchable {
+public:
+  FDWatcher( Proactor &proactor, AppLoop::Loop &loop, int fd ) : FileDescWatchable( loop ), _proactor( proactor ), _fd( fd ) {}
+ ~FDWatcher( void );
+
+  void queue( Op *op );
+  void cancel( void );
+
+protected:
+  int      watchFD( void ) const;
+  unsigned watchEvents( void ) const;
+  void     onEvents( unsigned events ) const;
+
+  void perform( deque<Op *> &ops ) const;
+
+protected:
+  Proactor &_proactor;
+  int _fd;
+  mutable deque<Op *> _reads, _writes;
+};
+
+
+Proactor::FDWatcher::~FDWatcher( void )
+{
+  disable();
+
+  for ( deque<Op *>::iterator i = _reads.begin(); i != _reads.end(); ++i )
+    delete *i;
+  for ( deque<Op *>::iterator i = _writes.begin(); i != _writes.end(); ++i )
+    delete *i;
+}
+
+
+void Proactor::FDWatcher::queue( Op *op )
+{
+  ((op->type == Send) ? _writes : _reads).push_back( op );
+  update();
+}
+
+
+//! Delivers every queued operation as cancelled.
+void Proactor::FDWatcher::cancel( void )
+{
+  deque<Op *> ops;
+  ops.swap( _reads );
+  ops.insert( ops.end(), _writes.begin(), _writes.end() );
+  _writes.clear();
+  update();
+
+  for ( deque<Op *>::iterator i = ops.begin(); i != ops.end(); ++i )
+    _proactor.deliver( *i, -ECANCELED );
+}
+
+
+int Proactor::FDWatcher::watchFD( void ) const
+{
+  return _fd;
+}
+
+
+unsigned Proactor::FDWatcher::watchEvents( void ) const
+{
+  return (_reads.empty() ? 0 : Read) | (_writes.empty() ? 0 : Write);
+}
+
+
+void Proactor::FDWatcher::onEvents( unsigned events ) const
+{
+  if ( events & Read )
+    perform( _reads );
+  if ( events & Write )
+    perform( _writes );
+
+  update();
+
+  // The descriptor may be closed (and its number reused) once nothing's queued on it.
+  if ( !watchEvents() )
+    _proactor.release( _fd, this );
+}
+
+
+//! Performs queued operations, in order, until one would block.
+void Proactor::FDWatcher::perform( deque<Op *> &ops ) const
+{
+  while ( !ops.empty() ) {
+    int res = Proactor::perform( ops.front() );
+    if ( (res == -EAGAIN) || (res == -EWOULDBLOCK) )
+      break;
+
+    Op *op = ops.front();
+    ops.pop_front();
+    _proactor.complete( op, res );
+  }
+}
+
+
+/*! \brief Creates a proactor for \a loop, which must belong to the calling thread.
+**
+** If \a useRing is \c false, or \c io_uring(7) is unavailable, uses the readiness-based fallback.
+*/
+Proactor::Proactor( AppLoop::Loop &loop, bool useRing )
+: _loop( loop ), _pending( 0 ), _alive( new Liveness( this ) ), _ringFD( -1 ), _ringWatcher( 0 ), _sqMap( 0 ),
+  _cqMap( 0 ), _sqes( 0 ), _sqMapLen( 0 ), _cqMapLen( 0 ), _sqesLen( 0 ), _sqHead( 0 ), _sqTail( 0 ), _sqMask( 0 ),
+  _sqArray( 0 ), _cqHead( 0 ), _cqTail( 0 ), _cqMask( 0 ), _cqes( 0 ), _sqEntries( 0 ), _unsubmitted( 0 ),
+  _inFlight( 0 )
+{
+  _loop._proactors.push_back( this );
+
+  if ( !useRing || !setupRing( RingEntries ) )
+    return;
+
+  _ringWatcher = new RingWatcher( *this, _loop );
+  _ringWatcher->ref();
+  _ringWatcher->enable();
+}
+
+
+/*! \brief Releases the proactor's resources.
+**
+** Handlers for operations which haven't completed are not called.  Operations in flight on the ring are cancelled, and
+** waited for, so the kernel is finished with their buffers by the time this returns.
+*/
+Proactor::~Proactor( void )
+{
+  _alive->proactor = 0;
+
+  for ( Array<Proactor *>::Iterator i = _loop._proactors.begin(); i != _loop._proactors.end(); ++i ) {
+    if ( *i == this ) {
+      _loop._proactors.erase( i );
+      break;
+    }
+  }
+
+  drainRing();
+  closeRing();
+
+  for ( Map<int, FDWatcher *>::Iterator i = _fdWatchers.begin(); i != _fdWatchers.end(); ++i ) {
+    if ( i.val()->deref() )
+      delete i.val();
+  }
+  _fdWatchers.clear();
+
+  for ( Array<pair<Op *, int> >::Iterator i = _done.begin(); i != _done.end(); ++i )
+    delete i->first;
+  _done.clear();
+
+  for ( Array<Op *>::Iterator i = _spare.begin(); i != _spare.end(); ++i )
+    delete *i;
+  _spare.clear();
+}
+
+
+//! Queues an operation, for submission to the ring or the fallback.
+void Proactor::submit( OpType type, int fd, void *buf, unsigned len, off_t offset, Handler const &done )
+{
+  Op *op;
+  if ( _spare.empty() ) {
+    op = new Op;
+  } else {
+    op = _spare.back();
+    _spare.pop_back();
+  }
+
+  op->type = type;
+  op->fd = fd;
+  op->buf = buf;
+  op->len = len;
+  op->offset = offset;
+  op->done = done;
+  op->cancelling = false;
+
+  _pending++;
+
+  if ( usingRing() ) {
+    if ( !queueRing( op ) )
+      deliver( op, -EAGAIN );
+  } else
+  if ( (op->type == Read) || (op->type == Write) ) {
+    // Regular files are always "ready", so just perform the operation, and deliver it via the loop.
+    deliver( op, perform( op ) );
+  } else {
+    Map<int, FDWatcher *>::Iterator i = _fdWatchers.find( op->fd );
+    FDWatcher *w;
+    if ( i != _fdWatchers.end() ) {
+      w = i.val();
+    } else {
+      w = new FDWatcher( *this, _loop, op->fd );
+      w->ref();
+      w->enable();
+      _fdWatchers.insert( op->fd, w );
+    }
+
+    w->queue( op );
+  }
+}
+
+
+//! Delivers \a op's result, \a res, via the loop (so never from within the call which submitted it).
+void Proactor::deliver( Op *op, int res )
+{
+  _done.push_back( make_pair( op, res ) );
+  if ( _done.size() == 1 )
+    _loop.post( boost::bind( &Proactor::completePosted, _alive ) );
+}
+
+
+/*! \brief Cancels the operations outstanding on descriptor \a fd, whose handlers are passed \c -ECANCELED.
+**
+** An operation which has already completed (or which the kernel can no longer cancel) is delivered as usual.
+*/
+void Proactor::cancel( int fd )
+{
+  if ( usingRing() ) {
+    for ( Op *op = _inFlight; op; op = op->next ) {
+      if ( (op->fd == fd) && !op->cancelling )
+        cancelRing( op );
+    }
+    return;
+  }
+
+  Map<int, FDWatcher *>::Iterator i = _fdWatchers.find( fd );
+  if ( i != _fdWatchers.end() ) {
+    FDWatcher *w = i.val();
+    w->cancel();
+    release( fd, w );
+  }
+}
+
+
+//! Stops watching descriptor \a fd, if \a watcher is (still) the one watching it.
+void Proactor::release( int fd, FDWatcher const *watcher )
+{
+  Map<int, FDWatcher *>::Iterator i = _fdWatchers.find( fd );
+  if ( (i == _fdWatchers.end()) || (i.val() != watcher) )
+    return;
+
+  FDWatcher *w = i.val();
+  _fdWatchers.erase( i );
+  w->disable();
+  if ( w->deref() )
+    delete w;
+}
+
+
+//! Calls the handler for \a op (which is then kept for re-use) with result \a res.
+void Proactor::complete( Op *op, int res )
+{
+  _pending--;
+
+  Handler done;
+  done.swap( op->done );
+  _spare.push_back( op );
+
+  done( res );
+}
+
+
+/*! \brief Delivers the operations which completed immediately.
+**
+** If a handler throws, the remaining operations are delivered on a later iteration, and the exception is rethrown.
+*/
+void Proactor::completeDone( void )
+{
+  Array<pair<Op *, int> > done;
+  done.swap( _done );
+
+  Array<pair<Op *, int> >::Iterator i = done.begin();
+  try {
+    for ( ; i != done.end(); ++i )
+      complete( i->first, i->second );
+  } catch ( ... ) {
+    for ( ++i; i != done.end(); ++i )
+      deliver( i->first, i->second );
+
+    throw;
+  }
+}
+
+
+//! Delivers the operations which completed immediately, unless the proactor has since been destroyed.
+void Proactor::completePosted( ObjectPtr<Liveness> const &alive )
+{
+  if ( alive->proactor )
+    alive->proactor->completeDone();
+}
+
+
+//! Performs \a op (without blocking, for socket operations), and returns its result (or \c -errno).
+int Proactor::perform( Op const *op )
+{
+  ssize_t res;
+  do {
+    switch ( op->type ) {
+      case Recv:    res = ::recv( op->fd, op->buf, op->len, MSG_DONTWAIT );  break;
+      case Send:    res = ::send( op->fd, op->buf, op->len, MSG_DONTWAIT | MSG_NOSIGNAL );  break;
+      case Read:    res = ::pread( op->fd, op->buf, op->len, op->offset );  break;
+      case Write:   res = ::pwrite( op->fd, op->buf, op->len, op->offset );  break;
+      case Accept:  res = ::accept( op->fd, 0, 0 );  break;
+      default:      errno = EINVAL;  res = -1;
+    }
+  } while ( (res == -1) && (errno == EINTR) );
+
+  return (res == -1) ? -errno : int( res );
+}
+
+
+//! Submits any operations queued on the ring since the last flush (done by the loop before each wait).
+void Proactor::flush( void )
+{
+#ifdef HAVE_LINUX_IO_URING_H
+  while ( _unsubmitted ) {
+    int res = syscall( __NR_io_uring_enter, _ringFD, _unsubmitted, 0, 0, (void *) 0, 0 );
+    if ( res == -1 ) {
+      if ( errno == EINTR )
+        continue;
+
+      // The completion queue is full; try again once completions have been reaped.
+      if ( (errno != EAGAIN) && (errno != EBUSY) )
+        LOG_ERROR << "Error in io_uring_enter(2): " << SystemEx::sysErrStr();
+      return;
+    }
+
+    _unsubmitted -= res;
+  }
+#endif
+}
+
+
+//! Creates the \c io_uring(7) instance, and maps its rings.  Returns \c false if unavailable.
+bool Proactor::setupRing( unsigned entries )
+{
+#ifdef HAVE_LINUX_IO_URING_H
+  io_uring_params params;
+  memset( &params, 0, sizeof(params) );
+
+  _ringFD = syscall( __NR_io_uring_setup, entries, &params );
+  if ( _ringFD == -1 ) {
+    LOG_INFO << "io_uring unavailable, falling back to readiness notification: " << SystemEx::sysErrStr();
+    return false;
+  }
+
+  // Fast poll arrived with (i.e. implies) the recv/send/accept/read/write operations.
+  if ( !(params.features & IORING_FEAT_FAST_POLL) ) {
+    LOG_INFO << "io_uring too old, falling back to readiness notification";
+    closeRing();
+    return false;
+  }
+
+  _sqMapLen = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  _cqMapLen = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if ( params.features & IORING_FEAT_SINGLE_MMAP )
+    _sqMapLen = _cqMapLen = max( _sqMapLen, _cqMapLen );
+
+  _sqMap = mmap( 0, _sqMapLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFD, IORING_OFF_SQ_RING );
+  if ( _sqMap == MAP_FAILED ) {
+    _sqMap = 0;
+    LOG_ERROR << "Unable to map io_uring submission ring: " << SystemEx::sysErrStr();
+    closeRing();
+    return false;
+  }
+
+  if ( params.features & IORING_FEAT_SINGLE_MMAP ) {
+    _cqMap = _sqMap;
+  } else {
+    _cqMap = mmap( 0, _cqMapLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFD, IORING_OFF_CQ_RING );
+    if ( _cqMap == MAP_FAILED ) {
+      _cqMap = 0;
+      LOG_ERROR << "Unable to map io_uring completion ring: " << SystemEx::sysErrStr();
+      closeRing();
+      return false;
+    }
+  }
+
+  _sqesLen = params.sq_entries * sizeof(io_uring_sqe);
+  _sqes = mmap( 0, _sqesLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFD, IORING_OFF_SQES );
+  if ( _sqes == MAP_FAILED ) {
+    _sqes = 0;
+    LOG_ERROR << "Unable to map io_uring submission entries: " << SystemEx::sysErrStr();
+    closeRing();
+    return false;
+  }
+
+  char *sq = (char *) _sqMap, *cq = (char *) _cqMap;
+  _sqHead  = (unsigned *) (sq + params.sq_off.head);
+  _sqTail  = (unsigned *) (sq + params.sq_off.tail);
+  _sqMask  = (unsigned *) (sq + params.sq_off.ring_mask);
+  _sqArray = (unsigned *) (sq + params.sq_off.array);
+  _cqHead  = (unsigned *) (cq + params.cq_off.head);
+  _cqTail  = (unsigned *) (cq + params.cq_off.tail);
+  _cqMask  = (unsigned *) (cq + params.cq_off.ring_mask);
+  _cqes    = cq + params.cq_off.cqes;
+  _sqEntries = params.sq_entries;
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+//! Unmaps the rings and closes the \c io_uring(7) instance.
+void Proactor::closeRing( void )
+{
+#ifdef HAVE_LINUX_IO_URING_H
+  if ( _ringWatcher ) {
+    _ringWatcher->disable();
+    if ( _ringWatcher->deref() )
+      delete _ringWatcher;
+    _ringWatcher = 0;
+  }
+
+  if ( _sqes )
+    munmap( _sqes, _sqesLen );
+  if ( _cqMap && (_cqMap != _sqMap) )
+    munmap( _cqMap, _cqMapLen );
+  if ( _sqMap )
+    munmap( _sqMap, _sqMapLen );
+  _sqes = _cqMap = _sqMap = 0;
+
+  if ( _ringFD != -1 )
+    ::close( _ringFD );
+  _ringFD = -1;
+
+  // The kernel cancels anything still in flight.
+  _sqHead = _sqTail = _sqMask = _sqArray = _cqHead = _cqTail = _cqMask = 0;
+  _cqes = 0;
+#endif
+}
+
+
+/*! \brief Cancels every operation in flight on the ring, and waits for the kernel to finish with them.
+**
+** The operations are discarded without calling their handlers.
+*/
+void Proactor::drainRing( void )
+{
+#ifdef HAVE_LINUX_IO_URING_H
+  while ( _inFlight ) {
+    for ( Op *op = _inFlight; op; op = op->next ) {
+      if ( !op->cancelling && !cancelRing( op ) )
+        break;
+    }
+
+    int res = syscall( __NR_io_uring_enter, _ringFD, _unsubmitted, 1, IORING_ENTER_GETEVENTS, (void *) 0, 0 );
+    if ( res == -1 ) {
+      if ( (errno != EINTR) && (errno != EAGAIN) && (errno != EBUSY) ) {
+        LOG_ERROR << "Error in io_uring_enter(2), abandoning in-flight operations: " << SystemEx::sysErrStr();
+        return;
+      }
+    } else
+      _unsubmitted -= res;
+
+    unsigned head = *_cqHead;
+    unsigned tail = __atomic_load_n( _cqTail, __ATOMIC_ACQUIRE );
+    for ( ; head != tail; ++head ) {
+      Op *op = (Op *) (unsigned long) ((io_uring_cqe const *) _cqes)[head & *_cqMask].user_data;
+      if ( !op )
+        continue;
+
+      untrackRing( op );
+      _pending--;
+      delete op;
+    }
+    __atomic_store_n( _cqHead, head, __ATOMIC_RELEASE );
+  }
+#endif
+}
+
+
+//! Returns the next free submission entry, cleared (flushing the ring first, if it's full), or \c 0 if it's still full.
+void *Proactor::claimRing( void )
+{
+#ifdef HAVE_LINUX_IO_URING_H
+  unsigned tail = *_sqTail;
+  if ( (tail - __atomic_load_n( _sqHead, __ATOMIC_ACQUIRE )) >= _sqEntries ) {
+    flush();
+    if ( (tail - __atomic_load_n( _sqHead, __ATOMIC_ACQUIRE )) >= _sqEntries )
+      return 0;
+  }
+
+  unsigned index = tail & *_sqMask;
+  io_uring_sqe *sqe = ((io_uring_sqe *) _sqes) + index;
+  memset( sqe, 0, sizeof(*sqe) );
+  _sqArray[index] = index;
+  return sqe;
+#else
+  return 0;
+#endif
+}
+
+
+//! Adds \a op to the submission ring.  Returns \c false if the ring is full.
+bool Proactor::queueRing( Op *op )
+{
+#ifdef HAVE_LINUX_IO_URING_H
+  io_uring_sqe *sqe = (io_uring_sqe *) claimRing();
+  if ( !sqe )
+    return false;
+
+  sqe->fd = op->fd;
+  sqe->addr = (unsigned long) op->buf;
+  sqe->len = op->len;
+  sqe->user_data = (unsigned long) op;
+
+  switch ( op->type ) {
+    case Recv:    sqe->opcode = IORING_OP_RECV;  break;
+    case Send:    sqe->opcode = IORING_OP_SEND;  sqe->msg_flags = MSG_NOSIGNAL;  break;
+    case Read:    sqe->opcode = IORING_OP_READ;  sqe->off = op->offset;  break;
+    case Write:   sqe->opcode = IORING_OP_WRITE;  sqe->off = op->offset;  break;
+    case Accept:  sqe->opcode = IORING_OP_ACCEPT;  break;
+  }
+
+  __atomic_store_n( _sqTail, *_sqTail + 1, __ATOMIC_RELEASE );
+  _unsubmitted++;
+
+  op->prev = 0;
+  op->next = _inFlight;
+  if ( _inFlight )
+    _inFlight->prev = op;
+  _inFlight = op;
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+//! Removes \a op (once reaped) from the list of operations in flight on the ring.
+void Proactor::untrackRing( Op *op )
+{
+  (op->prev ? op->prev->next : _inFlight) = op->next;
+  if ( op->next )
+    op->next->prev = op->prev;
+}
+
+
+//! Queues a cancellation of \a op (whose own completion is then reaped as usual).  Returns \c false if the ring is full.
+bool Proactor::cancelRing( Op *op )
+{
+#ifdef HAVE_LINUX_IO_URING_H
+  io_uring_sqe *sqe = (io_uring_sqe *) claimRing();
+  if ( !sqe )
+    return false;
+
+  // The cancellation's own completion has no operation.
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = (unsigned long) op;
+  sqe->user_data = 0;
+
+  __atomic_store_n( _sqTail, *_sqTail + 1, __ATOMIC_RELEASE );
+  _unsubmitted++;
+  op->cancelling = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+//! Delivers every completion waiting on the ring.
+void Proactor::reapRing( void )
+{
+#ifdef HAVE_LINUX_IO_URING_H
+  // A handler may run the loop, and so reap again; each call delivers only what it appended to _reaped.
+  size_t first = _reaped.size();
+
+  unsigned head = *_cqHead;
+  unsigned tail = __atomic_load_n( _cqTail, __ATOMIC_ACQUIRE );
+  for ( ; head != tail; ++head ) {
+    io_uring_cqe const &cqe = ((io_uring_cqe const *) _cqes)[head & *_cqMask];
+    Op *op = (Op *) (unsigned long) cqe.user_data;
+    if ( !op )
+      continue;
+
+    untrackRing( op );
+    _reaped.push_back( make_pair( op, cqe.res ) );
+  }
+  __atomic_store_n( _cqHead, head, __ATOMIC_RELEASE );
+
+  // Handlers may submit more operations, so only call them once the ring has been updated.
+  size_t last = _reaped.size(), i = first;
+  try {
+    for ( ; i < last; ++i )
+      complete( _reaped[i].first, _reaped[i].second );
+  } catch ( ... ) {
+    // The rest have already left the ring, so deliver them on a later iteration
+    for ( ++i; i < last; ++i )
+      deliver( _reaped[i].first, _reaped[i].second );
+
+    _reaped.resize( first );
+    throw;
+  }
+  _reaped.resize( first );
+
+  // Submissions may have been deferred while the completion queue was full.
+  flush();
+#endif
+}
@@ -0,0 +1,171 @@
+/*!
+** \file Proactor.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#ifndef FINAGLE_PROACTOR_H
+#define FINAGLE_PROACTOR_H
+
+#include <sys/types.h>
+#include <deque>
+#include <boost/function.hpp>
+#include <Finagle/Array.h>
+#include <Finagle/Map.h>
+#include <Finagle/ObjectPtr.h>
+
+namespace Finagle {
+
+namespace AppLoop {  class Loop;  }
+
+//! Submits I/O operations, and delivers their completions on an application loop (via \c io_uring(7) where available).
+class Proactor {
+public:
+  //! Completion handler, passed the operation's result (a byte count or descriptor), or \c -errno on failure
+  typedef boost::function< void( int ) > Handler;
+
+public:
+  Proactor( AppLoop::Loop &loop, bool useRing = true );
+ ~Proactor( void );
+
+  bool usingRing( void ) const;
+  unsigned pending( void ) const;
+
+  void recv( int fd, void *buf, unsigned len, Handler const &done );
+  void send( int fd, void const *buf, unsigned len, Handler const &done );
+  void read( int fd, void *buf, unsigned len, off_t offset, Handler const &done );
+  void write( int fd, void const *buf, unsigned len, off_t offset, Handler const &done );
+  void accept( int fd, Handler const &done );
+
+  void cancel( int fd );
+  void flush( void );
+
+protected:
+  enum OpType {  Recv, Send, Read, Write, Accept  };
+
+  struct Op {
+    OpType type;
+    int fd;
+    void *buf;
+    unsigned len;
+    off_t offset;
+    Handler done;
+    Op *prev, *next;   //!< Neighbours in the list of operations in flight on the ring
+    bool cancelling;   //!< Whether a cancellation has been queued for the operation
+  };
+
+  //! Shared with posted deliveries, which must not touch the proactor once it's been destroyed
+  struct Liveness : public ReferenceCount {
+    Liveness( Proactor *p ) : proactor( p ) {}
+    Proactor *proactor;
+  };
+
+  class RingWatcher;
+  class FDWatcher;
+
+protected:
+  void submit( OpType type, int fd, void *buf, unsigned len, off_t offset, Handler const &done );
+  void deliver( Op *op, int res );
+  void complete( Op *op, int res );
+  void completeDone( void );
+  static void completePosted( ObjectPtr<Liveness> const &alive );
+
+  void release( int fd, FDWatcher const *watcher );
+
+  bool setupRing( unsigned entries );
+  void closeRing( void );
+  void drainRing( void );
+  void *claimRing( void );
+  bool queueRing( Op *op );
+  void untrackRing( Op *op );
+  bool cancelRing( Op *op );
+  void reapRing( void );
+
+  static int perform( Op const *op );
+
+protected:
+  AppLoop::Loop &_loop;
+  unsigned _pending;
+  ObjectPtr<Liveness> _alive;
+
+  // io_uring
+  int _ringFD;
+  RingWatcher *_ringWatcher;
+  void *_sqMap, *_cqMap, *_sqes;
+  size_t _sqMapLen, _cqMapLen, _sqesLen;
+  unsigned *_sqHead, *_sqTail, *_sqMask, *_sqArray;
+  unsigned *_cqHead, *_cqTail, *_cqMask;
+  void *_cqes;
+  unsigned _sqEntries, _unsubmitted;
+  Op *_inFlight;                          //!< Operations submitted to the ring, and not yet reaped
+  Array<std::pair<Op *, int> > _reaped;   //!< Completions being delivered by reapRing()
+
+  // Readiness fallback
+  Map<int, FDWatcher *> _fdWatchers;
+  Array<std::pair<Op *, int> > _done;
+
+  Array<Op *> _spare;  //!< Completed operations, for re-use
+};
+
+// INLINE IMPLEMENTATION **********************************************************************************************************
+
+//! Returns \c true iff operations are submitted via \c io_uring(7) (rather than the readiness-based fallback).
+inline bool Proactor::usingRing( void ) const
+{
+  return _ringFD != -1;
+}
+
+//! Returns the number of operations which have been submitted, but not yet completed.
+inline unsigned Proactor::pending( void ) const
+{
+  return _pending;
+}
+
+//! Receives up to \a len bytes from socket \a fd into \a buf.
+inline void Proactor::recv( int fd, void *buf, unsigned len, Handler const &done )
+{
+  submit( Recv, fd, buf, len, 0, done );
+}
+
+//! Sends \a len bytes from \a buf to socket \a fd.
+inline void Proactor::send( int fd, void const *buf, unsigned len, Handler const &done )
+{
+  submit( Send, fd, (void *) buf, len, 0, done );
+}
+
+//! Reads up to \a len bytes from file \a fd, at \a offset, into \a buf.
+inline void Proactor::read( int fd, void *buf, unsigned len, off_t offset, Handler const &done )
+{
+  submit( Read, fd, buf, len, offset, done );
+}
+
+//! Writes \a len bytes from \a buf to file \a fd, at \a offset.
+inline void Proactor::write( int fd, void const *buf, unsigned len, off_t offset, Handler const &done )
+{
+  submit( Write, fd, (void *) buf, len, offset, done );
+}
+
+//! Accepts a connection on listening socket \a fd; the handler is passed the new socket's descriptor.
+inline void Proactor::accept( int fd, Handler const &done )
+{
+  submit( Accept, fd, 0, 0, 0, done );
+}
+
+}
+
+#endif
@@ -11,6 +11,7 @@
 #ifndef FINAGLE_QUEUE_H
 #define FINAGLE_QUEUE_H
 
+#include <algorithm>
 #include <deque>
 #include <Finagle/WaitCondition.h>
 
@@ -18,17 +19,56 @@ namespace Finagle {
 
 using std::deque;
 
+/*! \brief Whether the queues hand items of \a Type out by swapping them with the destination, rather than assigning.
+**
+** \c false by default, but \c true for String and ObjectPtr.  Specialize it (with a \c value of \c true) for other
+** types with a cheap \c swap but an expensive copy, such as buffers and containers:
+** \code
+** namespace Finagle {  template <> struct QueueSwaps<Packet> {  static const bool value = true;  };  }
+** \endcode
+** The \c *_swap push functions always swap.
+*/
+template <typename Type>
+struct QueueSwaps {
+  static const bool value = false;
+};
+
+//! Hands a queued item of \a Type out, by assignment (or by swapping, if QueueSwaps says so)
+template <typename Type, bool Swap = QueueSwaps<Type>::value>
+struct QueueTransfer {
+  static void take( Type &dest, Type &src ) {  dest = src;  }
+
+  template <typename Container>
+  static void append( Container &dest, Type &src ) {  dest.push_back( src );  }
+};
+
+template <typename Type>
+struct QueueTransfer<Type, true> {
+  static void take( Type &dest, Type &src ) {
+    using std::swap;
+    swap( dest, src );
+  }
+
+  template <typename Container>
+  static void append( Container &dest, Type &src ) {
+    dest.push_back( Type() );
+    take( dest.back(), src );
+  }
+};
+
 //! Generic thread-safe queue
 template <typename Type>
 class Queue : protected deque<Type> {
 public:
-  Queue( void ) {}
+  Queue( void ) : _guard( "Queue" ) {}
 
   bool empty( void ) const;
   unsigned size( void ) const;
 
   void push_back( Type const &el );
   void push_front( Type const &el );
+  void push_back_swap( Type &el );
+  void push_front_swap( Type &el );
 
   Type pop_back( void );
   Type pop_front( void );
@@ -36,6 +76,15 @@ public:
   bool pop_back( Type &dest, Time timeout = 0 );
   bool pop_front( Type &dest, Time timeout = 0 );
 
+  template <typename InputIterator>
+  void push_range( InputIterator begin, InputIterator end );
+
+  template <typename Container>
+  unsigned pop_all( Container &dest );
+
+  template <typename Container>
+  unsigned pop_up_to( unsigned max, Container &dest, Time timeout = 0 );
+
 public:
   template <typename Functor>
   void whenNotEmpty( Functor &func );
@@ -49,7 +98,7 @@ protected:  // functors
     BackPopper( Type &dest ) : _dest(dest) {}
     void operator()( Queue<Type> &queue ) {
       deque<Type> &q( (deque<Type> &) queue );
-      _dest = q.back();
+      QueueTransfer<Type>::take( _dest, q.back() );
       q.pop_back();
     }
 
@@ -63,15 +112,36 @@ protected:  // functors
     FrontPopper( Type &dest ) : BackPopper(dest) {}
     void operator()( Queue<Type> &queue ) {
       deque<Type> &q( (deque<Type> &) queue );
-      BackPopper::_dest = q.front();
+      QueueTransfer<Type>::take( BackPopper::_dest, q.front() );
       q.pop_front();
     }
   };
   friend class FrontPopper;
 
+  template <typename Container>
+  class RangePopper {
+  public:
+    RangePopper( Container &dest, unsigned max ) : count(0), _dest(dest), _max(max) {}
+    void operator()( Queue<Type> &queue ) {
+      deque<Type> &q( (deque<Type> &) queue );
+      for ( ; !q.empty() && (count < _max); ++count ) {
+        QueueTransfer<Type>::append( _dest, q.front() );
+        q.pop_front();
+      }
+    }
+
+  public:
+    unsigned count;
+
+  protected:
+    Container &_dest;
+    unsigned _max;
+  };
+  template <typename Container> friend class RangePopper;
+
 protected:
   mutable Mutex _guard;
-  WaitCondition _notEmpty;
+  Condition _notEmpty;  //!< Signalled (under #_guard) as items are added
 };
 
 // INLINE/TEMPLATE IMPLEMENTATION *************************************************************************************************
@@ -111,6 +181,28 @@ inline void Queue<Type>::push_front( Type const &el )
   _notEmpty.signalOne();
 }
 
+//! Adds an item to the tail of the queue, by swapping it with \a el (which is left default-constructed), rather than copying it.
+template <typename Type>
+inline void Queue<Type>::push_back_swap( Type &el )
+{
+  using std::swap;
+  Lock _( _guard );
+  deque<Type>::push_back( Type() );
+  swap( deque<Type>::back(), el );
+  _notEmpty.signalOne();
+}
+
+//! Adds an item to the head of the queue, by swapping it with \a el (which is left default-constructed), rather than copying it.
+template <typename Type>
+inline void Queue<Type>::push_front_swap( Type &el )
+{
+  using std::swap;
+  Lock _( _guard );
+  deque<Type>::push_front( Type() );
+  swap( deque<Type>::front(), el );
+  _notEmpty.signalOne();
+}
+
 //! Returns the item at the tail of the queue.  If the queue is empty, blocks until an item has been added.
 template <typename Type>
 inline Type Queue<Type>::pop_back( void )
@@ -151,23 +243,53 @@ inline bool Queue<Type>::pop_front( Type &dest, Time timeout )
 }
 
 
+//! Adds the items in [\a begin, \a end) to the tail of the queue, taking the lock once, and waking a waiter per item.
+template <typename Type>
+template <typename InputIterator>
+void Queue<Type>::push_range( InputIterator begin, InputIterator end )
+{
+  if ( begin == end )
+    return;
+
+  Lock _( _guard );
+  unsigned size = deque<Type>::size();
+  deque<Type>::insert( deque<Type>::end(), begin, end );
+  _notEmpty.signal( deque<Type>::size() - size );
+}
+
+//! Moves every item in the queue to the end of \a dest (without blocking), and returns the number of items moved.
+template <typename Type>
+template <typename Container>
+unsigned Queue<Type>::pop_all( Container &dest )
+{
+  RangePopper<Container> p( dest, ~0U );
+  Lock _( _guard );
+  p( *this );
+  return p.count;
+}
+
+//! Moves up to \a max items from the head of the queue to the end of \a dest, waiting up to \a timeout for the first.
+//! Returns the number of items moved.
+template <typename Type>
+template <typename Container>
+unsigned Queue<Type>::pop_up_to( unsigned max, Container &dest, Time timeout )
+{
+  RangePopper<Container> p( dest, max );
+  ifNotEmpty( p, timeout );
+  return p.count;
+}
+
+
 //! Calls functor \a func (passing the queue reference).  If the queue is empty, blocks until an item has been added.
 template <typename Type>
 template <typename Functor>
 void Queue<Type>::whenNotEmpty( Functor &func )
 {
-  _guard.lock();
-
-  while ( empty() ) {
-    _notEmpty.lock();
-    _guard.unlock();
-    _notEmpty.wait();
-    _guard.lock();
-    _notEmpty.unlock();
-  }
+  Lock _( _guard );
+  while ( deque<Type>::empty() )
+    _notEmpty.wait( _guard );
 
   func( *this );
-  _guard.unlock();
 }
 
 //! Calls functor \a func (passing the queue reference) if the queue is not empty, or becomes non-empty before \a timeout, and returns \c true.
@@ -176,23 +298,17 @@ template <typename Type>
 template <typename Functor>
 bool Queue<Type>::ifNotEmpty( Functor &func, Time timeout )
 {
-  _guard.lock();
-
-  if ( empty() ) {
-    _notEmpty.lock();
-    _guard.unlock();
-
-    if ( !_notEmpty.wait( timeout ) || empty() ) {
-      _notEmpty.unlock();
-      return false;
-    }
-
-    _guard.lock();
-    _notEmpty.unlock();
+  Lock _( _guard );
+  if ( deque<Type>::empty() && (timeout > 0.0) ) {
+    Time deadline = Time::now() + timeout;
+    while ( deque<Type>::empty() && _notEmpty.wait( _guard, deadline ) )
+      ;
   }
 
+  if ( deque<Type>::empty() )
+    return false;
+
   func( *this );
-  _guard.unlock();
   return true;
 }
 
@@ -0,0 +1,166 @@
+/*!
+** \file RWMutex.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#ifndef FINAGLE_RWMUTEX_H
+#define FINAGLE_RWMUTEX_H
+
+#include <Finagle/Mutex.h>
+#include <Finagle/PThreadEx.h>
+
+namespace Finagle {
+
+/*! \brief A reader/writer mutex, for read-mostly data
+**
+** Any number of threads may hold a ReadLock at once, but a WriteLock excludes all others.  Where the platform allows,
+** waiting writers take priority over new readers, so a steady stream of readers can't starve a writer.
+**
+** lock() and unlock() lock for writing, as does a WriteLock.  Unlike Mutex, an RWMutex is \e not recursive: a thread
+** holding a WriteLock mustn't lock it again (and one holding a ReadLock mustn't take a WriteLock).
+**
+** Example: \code
+** RWMutex routesGuard;
+**
+** // Readers
+** ReadLock _( routesGuard );
+** Route const &route = routes[dest];
+**
+** // Writers
+** WriteLock _( routesGuard );
+** routes.insert( dest, route );
+** \endcode
+*/
+class RWMutex {
+public:
+  RWMutex( void );
+ ~RWMutex( void );
+
+  void lock( void );
+  bool tryLock( void );
+  void unlock( void );
+
+  void lockShared( void );
+  bool tryLockShared( void );
+  void unlockShared( void );
+
+protected:
+  pthread_rwlock_t _rwlock;
+
+private:
+  RWMutex( RWMutex const & );
+  RWMutex &operator =( RWMutex const & );
+};
+
+//! Locks an RWMutex for reading, while in scope
+class ReadLock {
+public:
+  ReadLock( RWMutex &mutex );
+ ~ReadLock( void );
+
+protected:
+  RWMutex &_mutex;
+
+private:
+  ReadLock( ReadLock const & );
+  ReadLock &operator =( ReadLock const & );
+};
+
+typedef BasicLock<RWMutex> WriteLock;  //!< Locks an RWMutex for writing, while in scope
+
+// INLINE IMPLEMENTATION **********************************************************************************************************
+
+inline RWMutex::RWMutex( void )
+{
+  pthread_rwlockattr_t attr;
+  PTHREAD_ASSERT( pthread_rwlockattr_init( &attr ) );
+#ifdef __GLIBC__
+  PTHREAD_ASSERT( pthread_rwlockattr_setkind_np( &attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP ) );
+#endif
+  PTHREAD_ASSERT( pthread_rwlock_init( &_rwlock, &attr ) );
+  PTHREAD_ASSERT( pthread_rwlockattr_destroy( &attr ) );
+}
+
+inline RWMutex::~RWMutex( void )
+{
+  PTHREAD_ASSERT( pthread_rwlock_destroy( &_rwlock ) );
+}
+
+//! Locks the mutex for writing.
+inline void RWMutex::lock( void )
+{
+  PTHREAD_ASSERT( pthread_rwlock_wrlock( &_rwlock ) );
+}
+
+//! Locks the mutex for writing, if it's not locked by another thread, and returns \c true iff it was locked.
+inline bool RWMutex::tryLock( void )
+{
+  int res = pthread_rwlock_trywrlock( &_rwlock );
+  if ( res == EBUSY )
+    return false;
+
+  PTHREAD_ASSERT( res );
+  return true;
+}
+
+//! Unlocks the mutex (locked for writing).
+inline void RWMutex::unlock( void )
+{
+  PTHREAD_ASSERT( pthread_rwlock_unlock( &_rwlock ) );
+}
+
+//! Locks the mutex for reading.
+inline void RWMutex::lockShared( void )
+{
+  PTHREAD_ASSERT( pthread_rwlock_rdlock( &_rwlock ) );
+}
+
+//! Locks the mutex for reading, if it's not locked for writing, and returns \c true iff it was locked.
+inline bool RWMutex::tryLockShared( void )
+{
+  int res = pthread_rwlock_tryrdlock( &_rwlock );
+  if ( res == EBUSY )
+    return false;
+
+  PTHREAD_ASSERT( res );
+  return true;
+}
+
+//! Unlocks the mutex (locked for reading).
+inline void RWMutex::unlockShared( void )
+{
+  PTHREAD_ASSERT( pthread_rwlock_unlock( &_rwlock ) );
+}
+
+
+inline ReadLock::ReadLock( RWMutex &mutex )
+: _mutex( mutex )
+{
+  _mutex.lockShared();
+}
+
+inline ReadLock::~ReadLock( void )
+{
+  _mutex.unlockShared();
+}
+
+}
+
+#endif
@@ -0,0 +1,467 @@
+/*!
+** \file Reactor.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include "config.h"
+
+#include <cerrno>
+#include <unistd.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
+#include "Reactor.h"
+#include "AppLog.h"
+#include "FileDescWatcher.h"
+#include "Util.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::Reactor
+** \brief Waits for, and dispatches, file descriptor events for the application loop.
+**
+** Watchables which provide a single descriptor (see FileDescWatchable::watchFD()) are registered with \c epoll(7) once,
+** when they are enabled, and re-registered only when their descriptor or event mask changes (see
+** FileDescWatchable::update()).  Each wait then costs time proportional to the number of \e ready descriptors, rather
+** than the number of watched descriptors, and isn't limited by \c FD_SETSIZE.
+**
+** Descriptors which \c epoll(7) refuses (regular files and directories) are, as \c select(2) would report them,
+** always ready: each wait then returns at once, and notifies them of every event they're watching for (other than
+** exceptions).
+**
+** Watchables which can only fill in \c fd_sets (e.g. Transfer::Processor) are polled with \c select(2) each wait,
+** along with the \c epoll descriptor itself.  If \c epoll(7) isn't available, everything falls back to \c select(2),
+** and descriptors of \c FD_SETSIZE or more can't be watched.
+**
+** \sa AppLoop, FileDescWatcher.
+*/
+
+//! Initial size of the \c epoll_wait(2) event buffer (grown as needed).
+static const unsigned InitialEvents = 64;
+
+//! Maximum size of the \c epoll_wait(2) event buffer.
+static const unsigned MaxEvents = 4096;
+
+#ifdef HAVE_SYS_EPOLL_H
+
+static unsigned toEPoll( unsigned events )
+{
+  return ((events & FileDescWatchable::Read)   ? EPOLLIN  : 0) |
+         ((events & FileDescWatchable::Write)  ? EPOLLOUT : 0) |
+         ((events & FileDescWatchable::Except) ? EPOLLPRI : 0);
+}
+
+static unsigned fromEPoll( unsigned events )
+{
+  unsigned res = ((events & EPOLLIN)  ? FileDescWatchable::Read   : 0) |
+                 ((events & EPOLLOUT) ? FileDescWatchable::Write  : 0) |
+                 ((events & EPOLLPRI) ? FileDescWatchable::Except : 0);
+
+  // As with select(2), errors and hang-ups are reported as readable (and writable).
+  if ( events & (EPOLLERR | EPOLLHUP) )
+    res |= FileDescWatchable::Read | FileDescWatchable::Write;
+
+  return res;
+}
+
+#endif
+
+
+Reactor::Reactor( void )
+: _epollFD( -1 ), _alwaysReady( 0 ), _events( 0 ), _maxEvents( 0 )
+{
+#ifdef HAVE_SYS_EPOLL_H
+  _epollFD = epoll_create( InitialEvents );
+  if ( _epollFD == -1 ) {
+    LOG_WARN << "Unable to create epoll instance, falling back to select(2): " << SystemEx::sysErrStr();
+    return;
+  }
+
+  _maxEvents = InitialEvents;
+  _events = new epoll_event[_maxEvents];
+#endif
+}
+
+
+Reactor::~Reactor( void )
+{
+#ifdef HAVE_SYS_EPOLL_H
+  delete [] (epoll_event *) _events;
+#endif
+  _events = 0;
+
+  if ( _epollFD != -1 ) {
+    ::close( _epollFD );
+    _epollFD = -1;
+  }
+}
+
+
+/*! \brief Registers \a watchable, using its current descriptor and events.
+**
+** \throw SystemEx if its descriptor can't be watched (see registerFD()), in which case it isn't registered.
+*/
+void Reactor::add( FileDescWatchable const *watchable )
+{
+  if ( contains( watchable ) )
+    return;
+
+  int fd = watchable->watchFD();
+  if ( fd == -1 ) {
+    _selected.insert( watchable );
+    return;
+  }
+
+  try {
+    registerFD( watchable, _watched.insert( watchable, Interest() ), fd, watchable->watchEvents() );
+  }
+  catch ( ... ) {
+    _watched.erase( watchable );
+    throw;
+  }
+}
+
+
+/*! \brief Re-registers \a watchable if its descriptor or events have changed (does nothing if it's not registered).
+**
+** \throw SystemEx if its new descriptor can't be watched (see registerFD()), in which case it stays registered, but
+** won't be notified until a later update succeeds.
+*/
+void Reactor::update( FileDescWatchable const *watchable )
+{
+  InterestMap::Iterator i = _watched.find( watchable );
+  if ( i != _watched.end() ) {
+    registerFD( watchable, i.val(), watchable->watchFD(), watchable->watchEvents() );
+    return;
+  }
+
+  // A select()-only watchable which now provides a descriptor
+  if ( _selected.contains( watchable ) && (watchable->watchFD() != -1) ) {
+    _selected.erase( watchable );
+    add( watchable );
+  }
+}
+
+
+//! Unregisters \a watchable.
+void Reactor::remove( FileDescWatchable const *watchable )
+{
+  InterestMap::Iterator i = _watched.find( watchable );
+  if ( i != _watched.end() ) {
+    registerFD( watchable, i.val(), -1, 0 );
+    _watched.erase( i );
+    return;
+  }
+
+  _selected.erase( watchable );
+}
+
+
+/*! \brief Brings the kernel's registration (\a cur) for \a watchable up to date with descriptor \a fd and \a events.
+**
+** Descriptors with no events of interest are removed from the \c epoll set entirely, as \c epoll(7) would otherwise
+** continue to report errors and hang-ups for them.
+**
+** If \c epoll(7) refuses \a fd with \c EPERM (as it does regular files and directories), it's marked always ready
+** instead (see wait()).
+**
+** \throw SystemEx if \c epoll_ctl(2) fails (e.g. with \c EEXIST, if another watchable already watches \a fd), or,
+** without \c epoll(7), if \a fd is too large for \c select(2).  \a cur is left describing what the kernel has
+** registered.
+*/
+void Reactor::registerFD( FileDescWatchable const *watchable, Interest &cur, int fd, unsigned events )
+{
+  if ( (cur.fd == fd) && (cur.events == events) )
+    return;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if ( _epollFD != -1 ) {
+    // The kernel has nothing registered for an always-ready descriptor
+    if ( cur.alwaysReady ) {
+      cur = Interest( -1, 0 );
+      _alwaysReady--;
+    }
+
+    bool wasRegistered = (cur.fd != -1) && cur.events;
+    bool isRegistered  = (fd != -1) && events;
+
+    // The descriptor may already have been closed (and thus removed by the kernel), so ignore errors here.
+    if ( wasRegistered && (!isRegistered || (cur.fd != fd)) ) {
+      epoll_event ev = { 0, { 0 } };
+      epoll_ctl( _epollFD, EPOLL_CTL_DEL, cur.fd, &ev );
+      wasRegistered = false;
+    }
+
+    if ( isRegistered ) {
+      epoll_event ev = { 0, { 0 } };
+      ev.events = toEPoll( events );
+      ev.data.ptr = (void *) watchable;
+
+      if ( epoll_ctl( _epollFD, wasRegistered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev ) == -1 ) {
+        int err = SystemEx::sysErrCode();
+        if ( !wasRegistered && (err == EPERM) ) {
+          cur = Interest( fd, events );
+          cur.alwaysReady = true;
+          _alwaysReady++;
+          return;
+        }
+
+        if ( !wasRegistered )
+          cur = Interest();
+
+        throw SystemEx( String( "Unable to watch descriptor " ) + String( fd ) + " with epoll_ctl(2)", err );
+      }
+    }
+
+    cur.fd = fd;
+    cur.events = events;
+    return;
+  }
+#endif
+
+  if ( fd >= FD_SETSIZE )
+    throw SystemEx( String( "Unable to watch descriptor " ) + String( fd ) + " with select(2)", EINVAL );
+
+  cur.fd = fd;
+  cur.events = events;
+}
+
+
+/*! \brief Waits up to \a timeout seconds for events on any registered watchable.
+**
+** Returns the number of ready descriptors (\c 0 on timeout or interruption), or \c -1 on error (see \c errno).  Ready
+** watchables are notified by a subsequent call to dispatch().
+*/
+int Reactor::wait( Time timeout )
+{
+  _ready.clear();
+  _selectedReady.clear();
+
+  if ( (timeout < 0.0) || _alwaysReady )
+    timeout = 0.0;
+
+  int res;
+  if ( (_epollFD != -1) && _selected.empty() )
+    res = waitReady( int( ceil( timeout * 1000.0 ) ) );
+  else {
+    bool epollReady = false;
+    res = pollSelected( timeout, epollReady );
+    if ( (res != -1) && epollReady ) {
+      int n = waitReady( 0 );
+      if ( n == -1 )
+        return -1;
+
+      if ( _epollFD >= FD_SETSIZE )
+        res += n;  // not counted by select(2)
+    }
+  }
+
+  if ( (res == -1) || !_alwaysReady )
+    return res;
+
+  return res + collectAlwaysReady();
+}
+
+
+/*! \brief Notifies the watchables found ready by the last wait().
+**
+** Watchables which have been removed since the wait (e.g. by an earlier notification) are skipped.  Returns \c false
+** (leaving any remaining notifications undelivered) as soon as \a stop becomes \c true.  Notifications may safely
+** re-enter the application loop (e.g. via AppLoop::wait()).  If \a stats is given, records each notification's time.
+*/
+bool Reactor::dispatch( bool const volatile &stop, LoopStats *stats )
+{
+  Array<Ready> ready;
+  ready.swap( _ready );
+
+  for ( Array<Ready>::ConstIterator r = ready.begin(); r != ready.end(); ++r ) {
+    if ( !_watched.contains( r->watchable ) )
+      continue;
+
+    FileDescWatchable::ConstPtr w = r->watchable;
+    if ( stats ) {
+      Time start = Time::now();
+      w->onEvents( r->events );
+      stats->watcher( start, w );
+    } else
+      w->onEvents( r->events );
+
+    if ( stop )
+      return false;
+  }
+
+  if ( _selectedReady.empty() )
+    return true;
+
+  Array<FileDescWatchable const *> selected;
+  selected.swap( _selectedReady );
+  fd_set readFDs( _readFDs ), writeFDs( _writeFDs ), exceptFDs( _exceptFDs );
+
+  for ( Array<FileDescWatchable const *>::ConstIterator i = selected.begin(); i != selected.end(); ++i ) {
+    if ( !_selected.contains( *i ) )
+      continue;
+
+    FileDescWatchable::ConstPtr w = *i;
+    if ( stats ) {
+      Time start = Time::now();
+      w->onSelect( readFDs, writeFDs, exceptFDs );
+      stats->watcher( start, w );
+    } else
+      w->onSelect( readFDs, writeFDs, exceptFDs );
+
+    if ( stop )
+      return false;
+  }
+
+  return true;
+}
+
+
+//! Collects up to the buffer size of ready events from \c epoll(7), waiting up to \a timeoutMSecs milliseconds.
+int Reactor::waitReady( int timeoutMSecs )
+{
+#ifdef HAVE_SYS_EPOLL_H
+  epoll_event *events = (epoll_event *) _events;
+  int n = epoll_wait( _epollFD, events, _maxEvents, timeoutMSecs );
+  if ( n == -1 )
+    return (errno == EINTR) ? 0 : -1;
+
+  for ( int i = 0; i < n; ++i ) {
+    FileDescWatchable const *w = (FileDescWatchable const *) events[i].data.ptr;
+    InterestMap::Iterator in = _watched.find( w );
+    if ( in == _watched.end() )
+      continue;
+
+    unsigned evts = fromEPoll( events[i].events ) & in.val().events;
+    if ( evts )
+      _ready.push_back( Ready( w, evts ) );
+  }
+
+  // Buffer was filled, so grow it for next time.
+  if ( ((unsigned) n == _maxEvents) && (_maxEvents < MaxEvents) ) {
+    delete [] events;
+    _maxEvents *= 2;
+    _events = new epoll_event[_maxEvents];
+  }
+
+  return n;
+#else
+  return 0;
+#endif
+}
+
+
+//! Marks every always-ready watchable (see registerFD()) ready for its reads and writes, and returns how many there were.
+int Reactor::collectAlwaysReady( void )
+{
+  int n = 0;
+  for ( InterestMap::Iterator i = _watched.begin(); i != _watched.end(); ++i ) {
+    unsigned evts = i.val().events & (FileDescWatchable::Read | FileDescWatchable::Write);
+    if ( i.val().alwaysReady && evts ) {
+      _ready.push_back( Ready( i.key(), evts ) );
+      n++;
+    }
+  }
+
+  return n;
+}
+
+
+/*! \brief Waits, using \c select(2), on the select()-only watchables and the \c epoll descriptor.
+**
+** Without \c epoll(7), also waits on every registered descriptor, and collects their events directly.
+*/
+int Reactor::pollSelected( Time timeout, bool &epollReady )
+{
+  FD_ZERO( &_readFDs );
+  FD_ZERO( &_writeFDs );
+  FD_ZERO( &_exceptFDs );
+
+  int maxFD = -1;
+  for ( Set<FileDescWatchable const *>::ConstIterator i = _selected.begin(); i != _selected.end(); ++i ) {
+    int fd = (*i)->fds( _readFDs, _writeFDs, _exceptFDs );
+    if ( fd == -1 )
+      continue;
+
+    if ( fd >= FD_SETSIZE ) {
+      LOG_ERROR << "Ignoring watchable with descriptor " << fd << ", which is too large for select(2)";
+      continue;
+    }
+
+    maxFD = max( maxFD, fd );
+    _selectedReady.push_back( *i );
+  }
+
+  if ( _epollFD >= FD_SETSIZE ) {
+    // Can't select() on the epoll descriptor, so check it after a short wait
+    epollReady = true;
+    if ( timeout > 0.01 )
+      timeout = 0.01;
+  } else if ( _epollFD != -1 ) {
+    FD_SET( _epollFD, &_readFDs );
+    maxFD = max( maxFD, _epollFD );
+  } else {
+    for ( InterestMap::Iterator i = _watched.begin(); i != _watched.end(); ++i ) {
+      Interest const &in = i.val();
+      if ( (in.fd == -1) || !in.events )
+        continue;
+
+      if ( in.events & FileDescWatchable::Read   )  FD_SET( in.fd, &_readFDs );
+      if ( in.events & FileDescWatchable::Write  )  FD_SET( in.fd, &_writeFDs );
+      if ( in.events & FileDescWatchable::Except )  FD_SET( in.fd, &_exceptFDs );
+      maxFD = max( maxFD, in.fd );
+    }
+  }
+
+  if ( maxFD == -1 ) {
+    sleep( timeout );
+    return 0;
+  }
+
+  timeval tv = { time_t( timeout ), suseconds_t( (timeout - trunc( timeout )) * 1000000.0 ) };
+  int res = select( maxFD + 1, &_readFDs, &_writeFDs, &_exceptFDs, &tv );
+  if ( res <= 0 ) {
+    _selectedReady.clear();
+    return ((res == -1) && (errno != EINTR)) ? -1 : 0;
+  }
+
+  if ( _epollFD != -1 ) {
+    if ( _epollFD < FD_SETSIZE )
+      epollReady = FD_ISSET( _epollFD, &_readFDs );
+
+    return res;
+  }
+
+  for ( InterestMap::Iterator i = _watched.begin(); i != _watched.end(); ++i ) {
+    Interest const &in = i.val();
+    if ( (in.fd == -1) || !in.events )
+      continue;
+
+    unsigned evts = (FD_ISSET( in.fd, &_readFDs   ) ? FileDescWatchable::Read   : 0) |
+                    (FD_ISSET( in.fd, &_writeFDs  ) ? FileDescWatchable::Write  : 0) |
+                    (FD_ISSET( in.fd, &_exceptFDs ) ? FileDescWatchable::Except : 0);
+    if ( evts & in.events )
+      _ready.push_back( Ready( i.key(), evts & in.events ) );
+  }
+
+  return res;
+}
@@ -0,0 +1,110 @@
+/*!
+** \file Reactor.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#ifndef FINAGLE_REACTOR_H
+#define FINAGLE_REACTOR_H
+
+#include <sys/select.h>
+#include <Finagle/Array.h>
+#include <Finagle/DateTime.h>
+#include <Finagle/LoopStats.h>
+#include <Finagle/Map.h>
+#include <Finagle/Set.h>
+
+namespace Finagle {
+
+class FileDescWatchable;
+
+//! Dispatches file descriptor events to FileDescWatchables (via \c epoll(7), or \c select(2) where unavailable).
+class Reactor {
+public:
+  Reactor( void );
+ ~Reactor( void );
+
+  void add( FileDescWatchable const *watchable );
+  void update( FileDescWatchable const *watchable );
+  void remove( FileDescWatchable const *watchable );
+
+  bool contains( FileDescWatchable const *watchable ) const;
+  bool empty( void ) const;
+  unsigned size( void ) const;
+
+  int  wait( Time timeout );
+  bool dispatch( bool const volatile &stop, LoopStats *stats = 0 );
+
+protected:
+  struct Interest {
+    Interest( int fileDesc = -1, unsigned evts = 0 ) : fd( fileDesc ), events( evts ), alwaysReady( false ) {}
+    int fd;
+    unsigned events;
+    bool alwaysReady;  //!< \c epoll(7) refused the descriptor (e.g. a regular file), so it's treated as always ready
+  };
+
+  struct Ready {
+    Ready( FileDescWatchable const *w = 0, unsigned evts = 0 ) : watchable( w ), events( evts ) {}
+    FileDescWatchable const *watchable;
+    unsigned events;
+  };
+
+  typedef Map<FileDescWatchable const *, Interest> InterestMap;
+
+protected:
+  void registerFD( FileDescWatchable const *watchable, Interest &cur, int fd, unsigned events );
+  int  pollSelected( Time timeout, bool &epollReady );
+  int  waitReady( int timeoutMSecs );
+  int  collectAlwaysReady( void );
+
+protected:
+  int _epollFD;
+  InterestMap _watched;                      //!< Watchables which provide a single descriptor (i.e. FileDescWatcher)
+  Set<FileDescWatchable const *> _selected;  //!< Watchables which can only provide an \c fd_set (e.g. Transfer::Processor)
+  unsigned _alwaysReady;                     //!< Watchables in #_watched whose descriptors \c epoll(7) refused
+
+  void *_events;                             //!< \c epoll_event buffer
+  unsigned _maxEvents;
+  Array<Ready> _ready;
+  fd_set _readFDs, _writeFDs, _exceptFDs;
+  Array<FileDescWatchable const *> _selectedReady;
+};
+
+// INLINE IMPLEMENTATION **********************************************************************************************************
+
+//! Returns \c true iff \a watchable is registered with this reactor.
+inline bool Reactor::contains( FileDescWatchable const *watchable ) const
+{
+  return _watched.contains( watchable ) || _selected.contains( watchable );
+}
+
+//! Returns \c true iff no watchables are registered.
+inline bool Reactor::empty( void ) const
+{
+  return _watched.empty() && _selected.empty();
+}
+
+//! Returns the number of registered watchables.
+inline unsigned Reactor::size( void ) const
+{
+  return _watched.size() + _selected.size();
+}
+
+}
+
+#endif
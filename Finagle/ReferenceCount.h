@@ -24,58 +24,91 @@
 
 namespace Finagle {
 
+//! Reference-counting policy for objects used by a single thread at a time (e.g. an application loop's)
+struct LocalCount {
+  typedef unsigned Count;
+
+  static void increment( Count &count ) {  count++;  }
+  static bool decrement( Count &count ) {  return --count == 0;  }
+};
+
+//! Reference-counting policy for objects shared between threads
+struct AtomicCount {
+  typedef unsigned volatile Count;
+
+  static void increment( Count &count ) {  __sync_fetch_and_add( &count, 1 );  }
+  static bool decrement( Count &count ) {  return __sync_sub_and_fetch( &count, 1 ) == 0;  }
+};
+
 /*! \brief Simple reference-counting implementation (suitable for ObjectPtr)
 **
 ** This class implements a reference count, suitable for inheriting into
 ** classes which are referenced with ObjectPtr.  A referenced object need not
 ** necessarily inherit ReferenceCount, but it must provide the same
 ** functions.
+**
+** The \a Policy determines whether the count is thread-safe: ReferenceCount
+** (LocalCount) is plain arithmetic, for objects used by one thread at a time;
+** AtomicReferenceCount (AtomicCount) may be referenced and released from any
+** thread, at the cost of an atomic operation per reference.
 */
-class ReferenceCount {
+template <typename Policy>
+class BasicReferenceCount {
 public:
-  ReferenceCount( void );
-  ReferenceCount( ReferenceCount const & );
+  BasicReferenceCount( void );
+  BasicReferenceCount( BasicReferenceCount const & );
 
   void ref( void ) const;
   bool deref( void ) const;
   unsigned refs( void ) const;
 
 protected:
-  mutable unsigned _refs;
+  mutable typename Policy::Count _refs;
 };
 
+//! A reference count for objects used by a single thread at a time
+typedef BasicReferenceCount<LocalCount> ReferenceCount;
+
+//! A reference count for objects shared between threads
+typedef BasicReferenceCount<AtomicCount> AtomicReferenceCount;
+
 // INLINE/TEMPLATE IMPLEMENTATION *************************************************************************************************
 
 //! Initializes the reference count to \c 0.
-inline ReferenceCount::ReferenceCount( void )
+template <typename Policy>
+inline BasicReferenceCount<Policy>::BasicReferenceCount( void )
 : _refs(0)
 {}
 
 //! Initializes the reference count to \c 0.
-inline ReferenceCount::ReferenceCount( ReferenceCount const & )
+template <typename Policy>
+inline BasicReferenceCount<Policy>::BasicReferenceCount( BasicReferenceCount const & )
 : _refs(0)
 {}
 
 /*! \brief Incremements the reference count.
 **
-** \warning this function \e may not be thread-safe.
+** \warning this function is only thread-safe with the AtomicCount policy.
 */
-inline void ReferenceCount::ref( void ) const
+template <typename Policy>
+inline void BasicReferenceCount<Policy>::ref( void ) const
 {
-  _refs++;
+  Policy::increment( _refs );
 }
 
 /*! \brief Decremements the reference count and returns \c true if it's \c 0.
 **
-** \warning this function \e is not thread-safe.
+** \warning this function is only thread-safe with the AtomicCount policy.
 */
-inline bool ReferenceCount::deref( void ) const
+template <typename Policy>
+inline bool BasicReferenceCount<Policy>::deref( void ) const
 {
-  return --_refs == 0;
+  return Policy::decrement( _refs );
 }
 
 //! Returns the reference count.
-inline unsigned ReferenceCount::refs( void ) const
+template <typename Policy>
+inline unsigned BasicReferenceCount<Policy>::refs( void ) const
 {
   return _refs;
 }
@@ -0,0 +1,151 @@
+/*!
+** \file RingQueue.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include "config.h"
+
+#include <cerrno>
+#include <cmath>
+#include <ctime>
+#include <sched.h>
+#include <unistd.h>
+#ifdef HAVE_LINUX_FUTEX_H
+#include <linux/futex.h>
+#endif
+#ifdef HAVE_LINUX_MEMBARRIER_H
+#include <linux/membarrier.h>
+#endif
+#if defined(HAVE_LINUX_FUTEX_H) || defined(HAVE_LINUX_MEMBARRIER_H)
+#include <sys/syscall.h>
+#endif
+
+#include "RingQueue.h"
+
+using namespace std;
+using namespace Finagle;
+
+//! Returns \a capacity rounded up to a power of two (and at least \c 2).
+unsigned RingQueueBase::roundCapacity( unsigned capacity )
+{
+  unsigned rounded = 2;
+  while ( rounded < capacity )
+    rounded <<= 1;
+
+  return rounded;
+}
+
+
+//! Backs off before retry \a attempt: briefly pauses the CPU, then yields to other threads.
+void RingQueueBase::relax( unsigned attempt )
+{
+  if ( attempt < SpinTries / 4 ) {
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+  } else
+    sched_yield();
+}
+
+
+/*! \brief Blocks while \a *word == \a val, until woken by unpark() (or for up to \a timeout seconds, if valid).
+**
+** May return spuriously; returns \c false if the timeout expired.
+*/
+bool RingQueueBase::Parking::park( int volatile *word, int val, Time timeout )
+{
+  struct timespec ts, *tsp = 0;
+  if ( timeout.isValid() ) {
+    double secs = floor( timeout );
+    ts.tv_sec = time_t( secs );
+    ts.tv_nsec = long( (timeout - secs) * 1e9 );
+    tsp = &ts;
+  }
+
+#ifdef HAVE_LINUX_FUTEX_H
+  if ( syscall( SYS_futex, (int *) word, FUTEX_WAIT_PRIVATE, val, tsp, 0, 0 ) == -1 )
+    return errno != ETIMEDOUT;
+
+  return true;
+#else
+  // Without futexes, poll every millisecond
+  Time end = tsp ? (Time::now() + timeout) : Time();
+  while ( *word == val ) {
+    if ( end.isValid() && (Time::now() >= end) )
+      return false;
+
+    struct timespec nap = { 0, 1000000 };
+    nanosleep( &nap, 0 );
+  }
+
+  return true;
+#endif
+}
+
+
+//! Wakes up to \a count threads parked on \a word.
+void RingQueueBase::Parking::unpark( int volatile *word, int count )
+{
+#ifdef HAVE_LINUX_FUTEX_H
+  syscall( SYS_futex, (int *) word, FUTEX_WAKE_PRIVATE, count, 0, 0, 0 );
+#else
+  (void) word;
+  (void) count;
+#endif
+}
+
+
+//! Registers the process for expedited \c membarrier(2).  Returns \c false if the kernel doesn't support it.
+static bool registerBarrier( void )
+{
+#ifdef HAVE_LINUX_MEMBARRIER_H
+  long cmds = syscall( __NR_membarrier, MEMBARRIER_CMD_QUERY, 0 );
+  return (cmds != -1) && (cmds & MEMBARRIER_CMD_PRIVATE_EXPEDITED) &&
+         (syscall( __NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0 ) == 0);
+#else
+  return false;
+#endif
+}
+
+
+/*! \brief Lets notify() skip its fence, by having waiters issue a process-wide barrier() before they re-check instead.
+**
+** A notifier's store, then its load of #waiters, may otherwise be reordered, so that it misses a waiter which in turn
+** misses the store.  Only worthwhile where notifications are far more frequent than parking, and only safe when each
+** notification follows a store which the waiters re-check (e.g. a queue's release store of its tail).  Returns \c false,
+** leaving notify() fenced, if the kernel doesn't support \c membarrier(2).
+*/
+bool RingQueueBase::Parking::makeAsymmetric( void )
+{
+  static bool const supported = registerBarrier();
+  asymmetric = supported;
+  return asymmetric;
+}
+
+
+//! Executes a memory barrier on every running thread of the process (once makeAsymmetric() has succeeded).
+void RingQueueBase::Parking::barrier( void )
+{
+#ifdef HAVE_LINUX_MEMBARRIER_H
+  if ( syscall( __NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0 ) == 0 )
+    return;
+#endif
+  __sync_synchronize();
+}
@@ -0,0 +1,356 @@
+/*!
+** \file RingQueue.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#ifndef FINAGLE_RINGQUEUE_H
+#define FINAGLE_RINGQUEUE_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <Finagle/DateTime.h>
+
+namespace Finagle {
+
+//! Non-template parts of RingQueue and SPSCQueue
+class RingQueueBase {
+public:
+  static const unsigned CacheLine = 64;  //!< Size (and alignment) of the indices, to keep them in separate cache lines
+  static const unsigned SpinTries = 32;  //!< Attempts to push (or pop) before parking
+
+  //! Threads parked until a queue becomes non-empty (or non-full), or some other condition holds
+  struct Parking {
+    Parking( void ) : seq( 0 ), waiters( 0 ), asymmetric( false ) {}
+
+    void notify( void );
+    void notifyAll( void );
+    bool makeAsymmetric( void );
+    static bool park( int volatile *word, int val, Time timeout );
+    static void unpark( int volatile *word, int count );
+    static void barrier( void );
+
+    int volatile seq;      //!< Incremented on each notification (the futex word)
+    int volatile waiters;  //!< Threads parked, or about to park
+    bool asymmetric;       //!< Waiters issue a barrier(), so notifiers needn't fence
+  };
+
+  template <typename Attempt>
+  static bool await( Parking &parking, Attempt attempt, Time deadline );
+
+  static void relax( unsigned attempt );
+
+protected:
+  static unsigned roundCapacity( unsigned capacity );
+};
+
+/*! \brief Lock-free, bounded, multiple-producer/multiple-consumer queue
+**
+** Items are kept in a power-of-two ring of slots, each with a sequence number which tells producers and consumers
+** whether it's free or full, so tryPush() and tryPop() need only a single compare-and-swap of the tail (or head)
+** index.  The blocking push_back() and pop_front() retry briefly, then park on a futex only while the queue is full
+** (or empty).
+**
+** Unlike SizedQueue, items may only be added at the tail, and removed from the head.  \a Type must be
+** default-constructible and assignable.
+**
+** Example: \code
+** RingQueue<Job *> jobs( 1024 );
+**
+** // Producers
+** jobs.push_back( new Job( ... ) );
+**
+** // Consumers
+** Job *job;
+** while ( jobs.pop_front( job, 1.0 ) )
+**   job->run();
+** \endcode
+*/
+template <typename Type>
+class RingQueue : protected RingQueueBase {
+public:
+  RingQueue( unsigned capacity );
+ ~RingQueue( void );
+
+  unsigned capacity( void ) const;
+  unsigned size( void ) const;
+  bool empty( void ) const;
+  bool full( void ) const;
+
+  bool tryPush( Type const &el );
+  bool tryPop( Type &dest );
+
+  void push_back( Type const &el );
+  bool push_back( Type const &el, Time timeout );
+
+  Type pop_front( void );
+  bool pop_front( Type &dest, Time timeout = 0 );
+
+protected:
+  struct Cell {
+    size_t volatile seq;  //!< Position at which the cell is next free (== pos), or full (== pos + 1)
+    Type val;
+  };
+
+  //! Retries tryPush(), for await()
+  struct Pusher {
+    Pusher( RingQueue &q, Type const &e ) : queue( q ), el( e ) {}
+    bool operator()( void ) {  return queue.tryPush( el );  }
+    RingQueue &queue;
+    Type const &el;
+  };
+
+  //! Retries tryPop(), for await()
+  struct Popper {
+    Popper( RingQueue &q, Type &d ) : queue( q ), dest( d ) {}
+    bool operator()( void ) {  return queue.tryPop( dest );  }
+    RingQueue &queue;
+    Type &dest;
+  };
+
+protected:
+  Cell *_cells;
+  size_t _mask;
+
+  char _pad0[CacheLine];
+  size_t volatile _tail;  //!< Next position to push
+  char _pad1[CacheLine - sizeof(size_t)];
+  size_t volatile _head;  //!< Next position to pop
+  char _pad2[CacheLine - sizeof(size_t)];
+
+  Parking _notEmpty;
+  char _pad3[CacheLine - sizeof(Parking)];
+  Parking _notFull;
+
+private:
+  RingQueue( RingQueue const & );
+  RingQueue &operator =( RingQueue const & );
+};
+
+// INLINE/TEMPLATE IMPLEMENTATION *************************************************************************************************
+
+//! Wakes a parked thread, if there are any.
+inline void RingQueueBase::Parking::notify( void )
+{
+  if ( asymmetric )
+    __atomic_signal_fence( __ATOMIC_SEQ_CST );
+  else
+    __sync_synchronize();
+
+  if ( waiters ) {
+    __sync_fetch_and_add( &seq, 1 );
+    unpark( &seq, 1 );
+  }
+}
+
+//! Wakes all parked threads.
+inline void RingQueueBase::Parking::notifyAll( void )
+{
+  if ( asymmetric )
+    __atomic_signal_fence( __ATOMIC_SEQ_CST );
+  else
+    __sync_synchronize();
+
+  if ( waiters ) {
+    __sync_fetch_and_add( &seq, 1 );
+    unpark( &seq, 0x7fffffff );
+  }
+}
+
+//! Retries \a attempt (spinning, then parked on \a parking) until it succeeds, or until \a deadline (if valid) passes.
+template <typename Attempt>
+bool RingQueueBase::await( Parking &parking, Attempt attempt, Time deadline )
+{
+  for ( unsigned i = 0; i < SpinTries; ++i ) {
+    relax( i );
+    if ( attempt() )
+      return true;
+  }
+
+  while ( true ) {
+    int seq = parking.seq;
+    __sync_fetch_and_add( &parking.waiters, 1 );
+    if ( parking.asymmetric )
+      Parking::barrier();
+
+    bool done = attempt();
+    if ( !done ) {
+      Time left;
+      if ( deadline.isValid() && ((left = deadline - Time::now()) <= 0.0) ) {
+        __sync_fetch_and_sub( &parking.waiters, 1 );
+        return false;
+      }
+      Parking::park( &parking.seq, seq, left );
+    }
+
+    __sync_fetch_and_sub( &parking.waiters, 1 );
+    if ( done )
+      return true;
+  }
+}
+
+
+//! Initializes the queue, with room for at least \a capacity items (rounded up to a power of two).
+template <typename Type>
+RingQueue<Type>::RingQueue( unsigned capacity )
+: _tail( 0 ), _head( 0 )
+{
+  capacity = roundCapacity( capacity );
+  _mask = capacity - 1;
+  _cells = new Cell[capacity];
+  for ( size_t i = 0; i < capacity; ++i )
+    _cells[i].seq = i;
+}
+
+//! Discards any remaining items.
+template <typename Type>
+inline RingQueue<Type>::~RingQueue( void )
+{
+  delete [] _cells;
+}
+
+//! Returns the maximum number of items in the queue.
+template <typename Type>
+inline unsigned RingQueue<Type>::capacity( void ) const
+{
+  return _mask + 1;
+}
+
+//! Returns the (momentary) number of items in the queue.
+template <typename Type>
+inline unsigned RingQueue<Type>::size( void ) const
+{
+  size_t head = _head, tail = _tail;
+  return (tail > head) ? unsigned( tail - head ) : 0;
+}
+
+//! Returns \c true iff the queue is (momentarily) empty.
+template <typename Type>
+inline bool RingQueue<Type>::empty( void ) const
+{
+  return size() == 0;
+}
+
+//! Returns \c true iff the queue is (momentarily) full.
+template <typename Type>
+inline bool RingQueue<Type>::full( void ) const
+{
+  return size() >= capacity();
+}
+
+
+//! Adds \a el to the tail of the queue, without blocking.  Returns \c false if the queue is full.
+template <typename Type>
+bool RingQueue<Type>::tryPush( Type const &el )
+{
+  Cell *cell;
+  size_t pos = _tail;
+  while ( true ) {
+    cell = &_cells[pos & _mask];
+    intptr_t diff = intptr_t( cell->seq ) - intptr_t( pos );
+    if ( diff == 0 ) {
+      if ( __sync_bool_compare_and_swap( &_tail, pos, pos + 1 ) )
+        break;
+      pos = _tail;
+    } else if ( diff < 0 )
+      return false;  // the cell hasn't been popped since the last lap
+    else
+      pos = _tail;   // another producer claimed it
+  }
+
+  cell->val = el;
+  __sync_synchronize();
+  cell->seq = pos + 1;
+
+  _notEmpty.notify();
+  return true;
+}
+
+//! Removes the item at the head of the queue into \a dest, without blocking.  Returns \c false if the queue is empty.
+template <typename Type>
+bool RingQueue<Type>::tryPop( Type &dest )
+{
+  Cell *cell;
+  size_t pos = _head;
+  while ( true ) {
+    cell = &_cells[pos & _mask];
+    intptr_t diff = intptr_t( cell->seq ) - intptr_t( pos + 1 );
+    if ( diff == 0 ) {
+      if ( __sync_bool_compare_and_swap( &_head, pos, pos + 1 ) )
+        break;
+      pos = _head;
+    } else if ( diff < 0 )
+      return false;  // the cell hasn't been pushed yet
+    else
+      pos = _head;   // another consumer claimed it
+  }
+
+  dest = cell->val;
+  cell->val = Type();
+  __sync_synchronize();
+  cell->seq = pos + _mask + 1;
+
+  _notFull.notify();
+  return true;
+}
+
+
+//! Adds \a el to the tail of the queue.  Will block while the queue is full.
+template <typename Type>
+inline void RingQueue<Type>::push_back( Type const &el )
+{
+  if ( !tryPush( el ) )
+    await( _notFull, Pusher( *this, el ), Time() );
+}
+
+//! Adds \a el to the tail of the queue, if there's room before \a timeout seconds.  Returns \c false if the queue is still full.
+template <typename Type>
+inline bool RingQueue<Type>::push_back( Type const &el, Time timeout )
+{
+  if ( tryPush( el ) )
+    return true;
+
+  return timeout.isValid() && await( _notFull, Pusher( *this, el ), Time::now() + timeout );
+}
+
+//! Removes and returns the item at the head of the queue.  Will block while the queue is empty.
+template <typename Type>
+inline Type RingQueue<Type>::pop_front( void )
+{
+  Type dest;
+  if ( !tryPop( dest ) )
+    await( _notEmpty, Popper( *this, dest ), Time() );
+
+  return dest;
+}
+
+//! Removes the item at the head of the queue into \a dest, if there is one before \a timeout seconds (\c 0 to not wait).
+//! Returns \c false if the queue is still empty.
+template <typename Type>
+inline bool RingQueue<Type>::pop_front( Type &dest, Time timeout )
+{
+  if ( tryPop( dest ) )
+    return true;
+
+  return timeout.isValid() && await( _notEmpty, Popper( *this, dest ), Time::now() + timeout );
+}
+
+}
+
+#endif
@@ -0,0 +1,303 @@
+/*!
+** \file SPSCQueue.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#ifndef FINAGLE_SPSCQUEUE_H
+#define FINAGLE_SPSCQUEUE_H
+
+#include <Finagle/Array.h>
+#include <Finagle/RingQueue.h>
+
+namespace Finagle {
+
+/*! \brief Wait-free, bounded, single-producer/single-consumer queue
+**
+** One thread may push, and one (other) thread may pop, with no locks or read-modify-write instructions: each side
+** owns one index, which it publishes with a release store and reads from the other side with an acquire load (and
+** only when its cached copy runs out).  The producer may stage() several items and publish() them at once, and the
+** consumer may take every published item with popAll(), so that the indices (and the check for parked threads)
+** change hands once per batch.
+**
+** As with RingQueue, the blocking push_back() and pop_front() retry briefly, then park on a futex while the queue is
+** full (or empty).  Where \c membarrier(2) is available, the check for a parked thread after publishing needs no
+** fence: a thread about to park issues a process-wide barrier instead (see RingQueueBase::Parking::makeAsymmetric()).
+** \a Type must be default-constructible and assignable.
+**
+** Example: \code
+** SPSCQueue<Packet> packets( 4096 );
+**
+** // Producer
+** while ( reader.read( packet ) )
+**   if ( !packets.stage( packet ) )
+**     packets.push_back( packet );  // full: publishes the batch, then waits for room
+** packets.publish();
+**
+** // Consumer
+** Array<Packet> batch;
+** while ( packets.popAll( batch ) || packets.pop_front( packet, 1.0 ) ) {
+**   ...
+** }
+** \endcode
+*/
+template <typename Type>
+class SPSCQueue : protected RingQueueBase {
+public:
+  SPSCQueue( unsigned capacity );
+ ~SPSCQueue( void );
+
+  unsigned capacity( void ) const;
+  unsigned size( void ) const;
+  bool empty( void ) const;
+  bool full( void ) const;
+
+public:  // producer
+  bool stage( Type const &el );
+  void publish( void );
+  bool tryPush( Type const &el );
+
+  void push_back( Type const &el );
+  bool push_back( Type const &el, Time timeout );
+
+public:  // consumer
+  bool tryPop( Type &dest );
+  unsigned popAll( Array<Type> &dest );
+
+  Type pop_front( void );
+  bool pop_front( Type &dest, Time timeout = 0 );
+
+protected:
+  //! Retries tryPush(), for await()
+  struct Pusher {
+    Pusher( SPSCQueue &q, Type const &e ) : queue( q ), el( e ) {}
+    bool operator()( void ) {  return queue.tryPush( el );  }
+    SPSCQueue &queue;
+    Type const &el;
+  };
+
+  //! Retries tryPop(), for await()
+  struct Popper {
+    Popper( SPSCQueue &q, Type &d ) : queue( q ), dest( d ) {}
+    bool operator()( void ) {  return queue.tryPop( dest );  }
+    SPSCQueue &queue;
+    Type &dest;
+  };
+
+protected:
+  Type *_items;
+  size_t _mask;
+
+  char _pad0[CacheLine];
+  size_t _tail;       //!< Published push position (written by the producer)
+  size_t _staged;     //!< Next push position, including unpublished items (producer only)
+  size_t _headCache;  //!< Last read of #_head (producer only)
+  char _pad1[CacheLine - 3 * sizeof(size_t)];
+  size_t _head;       //!< Next pop position (written by the consumer)
+  size_t _tailCache;  //!< Last read of #_tail (consumer only)
+  char _pad2[CacheLine - 2 * sizeof(size_t)];
+
+  Parking _notEmpty;
+  char _pad3[CacheLine - sizeof(Parking)];
+  Parking _notFull;
+
+private:
+  SPSCQueue( SPSCQueue const & );
+  SPSCQueue &operator =( SPSCQueue const & );
+};
+
+// INLINE/TEMPLATE IMPLEMENTATION *************************************************************************************************
+
+//! Initializes the queue, with room for at least \a capacity items (rounded up to a power of two).
+template <typename Type>
+SPSCQueue<Type>::SPSCQueue( unsigned capacity )
+: _tail( 0 ), _staged( 0 ), _headCache( 0 ), _head( 0 ), _tailCache( 0 )
+{
+  capacity = roundCapacity( capacity );
+  _mask = capacity - 1;
+  _items = new Type[capacity];
+
+  _notEmpty.makeAsymmetric();
+  _notFull.makeAsymmetric();
+}
+
+//! Discards any remaining items.
+template <typename Type>
+inline SPSCQueue<Type>::~SPSCQueue( void )
+{
+  delete [] _items;
+}
+
+//! Returns the maximum number of items in the queue.
+template <typename Type>
+inline unsigned SPSCQueue<Type>::capacity( void ) const
+{
+  return _mask + 1;
+}
+
+//! Returns the (momentary) number of published items in the queue.
+template <typename Type>
+inline unsigned SPSCQueue<Type>::size( void ) const
+{
+  size_t head = __atomic_load_n( &_head, __ATOMIC_ACQUIRE );
+  size_t tail = __atomic_load_n( &_tail, __ATOMIC_ACQUIRE );
+  return (tail > head) ? unsigned( tail - head ) : 0;
+}
+
+//! Returns \c true iff the queue has no published items.
+template <typename Type>
+inline bool SPSCQueue<Type>::empty( void ) const
+{
+  return size() == 0;
+}
+
+//! Returns \c true iff the queue is (momentarily) full.
+template <typename Type>
+inline bool SPSCQueue<Type>::full( void ) const
+{
+  return size() >= capacity();
+}
+
+
+/*! \brief Adds \a el to the tail of the queue, without making it visible to the consumer until publish() (producer only).
+**
+** Returns \c false (after publishing any staged items) if the queue is full.
+*/
+template <typename Type>
+inline bool SPSCQueue<Type>::stage( Type const &el )
+{
+  if ( (_staged - _headCache) > _mask ) {
+    _headCache = __atomic_load_n( &_head, __ATOMIC_ACQUIRE );
+    if ( (_staged - _headCache) > _mask ) {
+      publish();
+      return false;
+    }
+  }
+
+  _items[_staged & _mask] = el;
+  _staged++;
+  return true;
+}
+
+//! Makes any staged items visible to the consumer, and wakes it if it's parked (producer only).
+template <typename Type>
+inline void SPSCQueue<Type>::publish( void )
+{
+  if ( _staged == _tail )
+    return;
+
+  __atomic_store_n( &_tail, _staged, __ATOMIC_RELEASE );
+  _notEmpty.notify();
+}
+
+//! Adds \a el to the tail of the queue and publishes it, without blocking.  Returns \c false if the queue is full (producer only).
+template <typename Type>
+inline bool SPSCQueue<Type>::tryPush( Type const &el )
+{
+  if ( !stage( el ) )
+    return false;
+
+  publish();
+  return true;
+}
+
+//! Adds \a el to the tail of the queue.  Will block while the queue is full (producer only).
+template <typename Type>
+inline void SPSCQueue<Type>::push_back( Type const &el )
+{
+  if ( !tryPush( el ) )
+    await( _notFull, Pusher( *this, el ), Time() );
+}
+
+//! Adds \a el to the tail of the queue, if there's room before \a timeout seconds.  Returns \c false if the queue is still full.
+template <typename Type>
+inline bool SPSCQueue<Type>::push_back( Type const &el, Time timeout )
+{
+  if ( tryPush( el ) )
+    return true;
+
+  return timeout.isValid() && await( _notFull, Pusher( *this, el ), Time::now() + timeout );
+}
+
+
+//! Removes the item at the head of the queue into \a dest, without blocking.  Returns \c false if the queue is empty (consumer only).
+template <typename Type>
+inline bool SPSCQueue<Type>::tryPop( Type &dest )
+{
+  if ( _head == _tailCache ) {
+    _tailCache = __atomic_load_n( &_tail, __ATOMIC_ACQUIRE );
+    if ( _head == _tailCache )
+      return false;
+  }
+
+  Type &item = _items[_head & _mask];
+  dest = item;
+  item = Type();
+
+  __atomic_store_n( &_head, _head + 1, __ATOMIC_RELEASE );
+  _notFull.notify();
+  return true;
+}
+
+//! Appends every published item to \a dest, oldest first, and returns the number of items (consumer only).
+template <typename Type>
+unsigned SPSCQueue<Type>::popAll( Array<Type> &dest )
+{
+  _tailCache = __atomic_load_n( &_tail, __ATOMIC_ACQUIRE );
+  unsigned count = unsigned( _tailCache - _head );
+  if ( !count )
+    return 0;
+
+  dest.reserve( dest.size() + count );
+  for ( size_t pos = _head; pos != _tailCache; ++pos ) {
+    Type &item = _items[pos & _mask];
+    dest.push_back( item );
+    item = Type();
+  }
+
+  __atomic_store_n( &_head, _tailCache, __ATOMIC_RELEASE );
+  _notFull.notify();
+  return count;
+}
+
+//! Removes and returns the item at the head of the queue.  Will block while the queue is empty (consumer only).
+template <typename Type>
+inline Type SPSCQueue<Type>::pop_front( void )
+{
+  Type dest;
+  if ( !tryPop( dest ) )
+    await( _notEmpty, Popper( *this, dest ), Time() );
+
+  return dest;
+}
+
+//! Removes the item at the head of the queue into \a dest, if there is one before \a timeout seconds (\c 0 to not wait).
+//! Returns \c false if the queue is still empty.
+template <typename Type>
+inline bool SPSCQueue<Type>::pop_front( Type &dest, Time timeout )
+{
+  if ( tryPop( dest ) )
+    return true;
+
+  return timeout.isValid() && await( _notEmpty, Popper( *this, dest ), Time::now() + timeout );
+}
+
+}
+
+#endif
@@ -0,0 +1,207 @@
+/*!
+** \file SignalWatcher.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include "config.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef HAVE_SYS_SIGNALFD_H
+#include <sys/signalfd.h>
+#endif
+
+#include "SignalWatcher.h"
+#include "AppLog.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::SignalWatcher
+** \brief Delivers POSIX signals to an application loop, as they arrive.
+**
+** Watched signals are blocked, and read from a \c signalfd(2), so they wake the loop immediately, and #received is
+** emitted by the loop's thread (where it's safe to do anything), rather than from within a signal handler.  Since
+** signal masks are per-thread, and inherited by new threads, a SignalWatcher should be created (and its signals
+** watched) before any other threads are started; otherwise, they may still take the signal themselves.
+**
+** Without \c signalfd(2), a handler is installed for each watched signal, which writes the signal's number to a pipe
+** (so only one SignalWatcher may exist at a time).
+**
+** Example: \code
+** SignalWatcher::Ptr signals = new SignalWatcher;
+** signals->watch( SIGTERM );
+** signals->received.connect( boost::bind( &AppLoop::exit, 0 ) );
+** \endcode
+*/
+
+#ifndef HAVE_SYS_SIGNALFD_H
+//! Self-pipe written by the fallback signal handler
+static int SignalPipe[2] = { -1, -1 };
+
+static void onSignal( int signum )
+{
+  int err = errno;
+  char c = (char) signum;
+  ::write( SignalPipe[1], &c, 1 );
+  errno = err;
+}
+#endif
+
+
+//! Creates a watcher, initially watching no signals, notified by \a loop.
+SignalWatcher::SignalWatcher( AppLoop::Loop &loop )
+: FileDescWatchable( loop ), _fd( -1 )
+{
+  sigemptyset( &_mask );
+
+#ifdef HAVE_SYS_SIGNALFD_H
+  _fd = signalfd( -1, &_mask, SFD_NONBLOCK | SFD_CLOEXEC );
+  if ( _fd == -1 ) {
+    LOG_ERROR << "Unable to create signalfd: " << SystemEx::sysErrStr();
+    return;
+  }
+#else
+  if ( SignalPipe[0] == -1 ) {
+    if ( pipe( SignalPipe ) == -1 ) {
+      LOG_ERROR << "Unable to create signal pipe: " << SystemEx::sysErrStr();
+      return;
+    }
+
+    for ( unsigned i = 0; i < 2; ++i ) {
+      fcntl( SignalPipe[i], F_SETFL, fcntl( SignalPipe[i], F_GETFL ) | O_NONBLOCK );
+      fcntl( SignalPipe[i], F_SETFD, FD_CLOEXEC );
+    }
+  }
+
+  _fd = SignalPipe[0];
+#endif
+
+  enable();
+}
+
+
+//! Stops watching every signal (restoring its default disposition).
+SignalWatcher::~SignalWatcher( void )
+{
+  disable();
+
+  for ( int signum = 1; signum < NSIG; ++signum ) {
+    if ( watching( signum ) )
+      unwatch( signum );
+  }
+
+#ifdef HAVE_SYS_SIGNALFD_H
+  if ( _fd != -1 )
+    ::close( _fd );
+#endif
+}
+
+
+//! Starts delivering signal \a signum via #received.
+void SignalWatcher::watch( int signum )
+{
+  if ( (_fd == -1) || watching( signum ) )
+    return;
+
+  sigaddset( &_mask, signum );
+
+#ifdef HAVE_SYS_SIGNALFD_H
+  sigset_t sig;
+  sigemptyset( &sig );
+  sigaddset( &sig, signum );
+  pthread_sigmask( SIG_BLOCK, &sig, 0 );
+
+  if ( signalfd( _fd, &_mask, 0 ) == -1 )
+    LOG_ERROR << "Error in signalfd(2): " << SystemEx::sysErrStr();
+#else
+  struct sigaction action;
+  memset( &action, 0, sizeof(action) );
+  action.sa_handler = onSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset( &action.sa_mask );
+  sigaction( signum, &action, 0 );
+#endif
+}
+
+
+//! Stops watching signal \a signum (restoring its default disposition).
+void SignalWatcher::unwatch( int signum )
+{
+  if ( !watching( signum ) )
+    return;
+
+  sigdelset( &_mask, signum );
+
+#ifdef HAVE_SYS_SIGNALFD_H
+  signalfd( _fd, &_mask, 0 );
+
+  sigset_t sig;
+  sigemptyset( &sig );
+  sigaddset( &sig, signum );
+  pthread_sigmask( SIG_UNBLOCK, &sig, 0 );
+#else
+  signal( signum, SIG_DFL );
+#endif
+}
+
+
+int SignalWatcher::watchFD( void ) const
+{
+  return _fd;
+}
+
+
+unsigned SignalWatcher::watchEvents( void ) const
+{
+  return Read;
+}
+
+
+//! Reads every pending signal, and emits #received for each.
+void SignalWatcher::onEvents( unsigned ) const
+{
+  while ( true ) {
+#ifdef HAVE_SYS_SIGNALFD_H
+    signalfd_siginfo info;
+    ssize_t res = ::read( _fd, &info, sizeof(info) );
+    if ( res != sizeof(info) ) {
+      if ( (res == -1) && (errno == EINTR) )
+        continue;
+      break;
+    }
+    int signum = info.ssi_signo;
+#else
+    char c;
+    ssize_t res = ::read( _fd, &c, 1 );
+    if ( res != 1 ) {
+      if ( (res == -1) && (errno == EINTR) )
+        continue;
+      break;
+    }
+    int signum = c;
+#endif
+
+    received( signum );
+  }
+}
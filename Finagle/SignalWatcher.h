@@ -0,0 +1,67 @@
+/*!
+** \file SignalWatcher.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#ifndef FINAGLE_SIGNALWATCHER_H
+#define FINAGLE_SIGNALWATCHER_H
+
+#include <signal.h>
+#include <boost/signals.hpp>
+#include <Finagle/FileDescWatcher.h>
+
+namespace Finagle {
+
+//! Delivers POSIX signals to an application loop, as they arrive (via \c signalfd(2) where available).
+class SignalWatcher : public FileDescWatchable {
+public:
+  typedef ObjectPtr<SignalWatcher> Ptr;
+
+public:
+  SignalWatcher( AppLoop::Loop &loop = AppLoop::Loop::current() );
+ ~SignalWatcher( void );
+
+  void watch( int signum );
+  void unwatch( int signum );
+  bool watching( int signum ) const;
+
+public:
+  mutable boost::signal< void( int ) > received;  //!< Emitted (by the loop's thread) with each signal's number
+
+protected:
+  int      watchFD( void ) const;
+  unsigned watchEvents( void ) const;
+  void     onEvents( unsigned events ) const;
+
+protected:
+  int _fd;
+  sigset_t _mask;
+};
+
+// INLINE IMPLEMENTATION **********************************************************************************************************
+
+//! Returns \c true iff signal \a signum is being watched.
+inline bool SignalWatcher::watching( int signum ) const
+{
+  return sigismember( &_mask, signum ) == 1;
+}
+
+}
+
+#endif
@@ -64,7 +64,7 @@ template <typename Type, typename TypePtr>
 unsigned Singleton<Type, TypePtr>::_useCount = 0;
 
 template <typename Type, typename TypePtr>
-Finagle::Mutex Singleton<Type, TypePtr>::_guard;
+Finagle::Mutex Singleton<Type, TypePtr>::_guard( "Singleton" );
 
 template <typename Type, typename TypePtr>
 TypePtr Singleton<Type, TypePtr>::_inst = 0;
@@ -39,6 +39,8 @@ public:
 public:
   void push_back( Type const &el );
   void push_front( Type const &el );
+  void push_back_swap( Type &el );
+  void push_front_swap( Type &el );
 
   Type pop_back( void );
   Type pop_front( void );
@@ -46,6 +48,15 @@ public:
   bool pop_back( Type &dest, Time timeout = 0 );
   bool pop_front( Type &dest, Time timeout = 0 );
 
+  template <typename InputIterator>
+  void push_range( InputIterator begin, InputIterator end );
+
+  template <typename Container>
+  unsigned pop_all( Container &dest );
+
+  template <typename Container>
+  unsigned pop_up_to( unsigned max, Container &dest, Time timeout = 0 );
+
 public:
   template <typename Functor>
   void whenNotFull( Functor &func );
@@ -57,7 +68,10 @@ protected: // functors
   class BackPusher {
   public:
     BackPusher( Type const &src ) : _src(src) {}
-    void operator()( SizedQueue<Type> &queue ) {  ((deque<Type> &) queue).push_back( _src );  }
+    void operator()( SizedQueue<Type> &queue ) {
+      ((deque<Type> &) queue).push_back( _src );
+      queue._notEmpty.signalOne();
+    }
 
   protected:
     Type const &_src;
@@ -67,10 +81,35 @@ protected: // functors
   class FrontPusher : protected BackPusher {
   public:
     FrontPusher( Type const &src ) : BackPusher(src) {}
-    void operator()( SizedQueue<Type> &queue ) {  ((std::deque<Type> &) queue).push_front( BackPusher::_src );  }
+    void operator()( SizedQueue<Type> &queue ) {
+      ((std::deque<Type> &) queue).push_front( BackPusher::_src );
+      queue._notEmpty.signalOne();
+    }
   };
   friend class FrontPusher;
 
+  class SwapPusher {
+  public:
+    SwapPusher( Type &src, bool front ) : _src(src), _front(front) {}
+    void operator()( SizedQueue<Type> &queue ) {
+      deque<Type> &q( (deque<Type> &) queue );
+      using std::swap;
+      if ( _front ) {
+        q.push_front( Type() );
+        swap( q.front(), _src );
+      } else {
+        q.push_back( Type() );
+        swap( q.back(), _src );
+      }
+      queue._notEmpty.signalOne();
+    }
+
+  protected:
+    Type &_src;
+    bool _front;
+  };
+  friend class SwapPusher;
+
   struct BackPopper : public Queue<Type>::BackPopper {
     BackPopper( Type &dest ) : Queue<Type>::BackPopper(dest) {}
     void operator()( Queue<Type> &queue ) {
@@ -93,9 +132,37 @@ protected: // functors
   };
   friend class FrontPopper;
 
+  template <typename InputIterator>
+  class RangePusher {
+  public:
+    RangePusher( InputIterator &begin, InputIterator end ) : _begin(begin), _end(end) {}
+    void operator()( SizedQueue<Type> &queue ) {
+      deque<Type> &q( (deque<Type> &) queue );
+      unsigned count = 0;
+      for ( ; (_begin != _end) && (q.size() < queue._capacity); ++_begin, ++count )
+        q.push_back( *_begin );
+      queue._notEmpty.signal( count );
+    }
+
+  protected:
+    InputIterator &_begin;
+    InputIterator _end;
+  };
+  template <typename InputIterator> friend class RangePusher;
+
+  template <typename Container>
+  struct RangePopper : public Queue<Type>::template RangePopper<Container> {
+    RangePopper( Container &dest, unsigned max ) : Queue<Type>::template RangePopper<Container>(dest, max) {}
+    void operator()( Queue<Type> &queue ) {
+      Queue<Type>::template RangePopper<Container>::operator()( queue );
+      ((SizedQueue<Type> &) queue)._notFull.signal( this->count );
+    }
+  };
+  template <typename Container> friend struct RangePopper;
+
 protected:
   unsigned _capacity;
-  WaitCondition _notFull;
+  Condition _notFull;  //!< Signalled (under #_guard) as items are removed
 };
 
 // INLINE IMPLEMENTATION ******************************************************
@@ -142,6 +209,24 @@ inline void SizedQueue<Type>::push_front( Type const &el )
   whenNotFull( p );
 }
 
+//! Adds an item to the tail of the queue, by swapping it with \a el (which is left default-constructed).  Will block while
+//! the queue is full.
+template <typename Type>
+inline void SizedQueue<Type>::push_back_swap( Type &el )
+{
+  SwapPusher p( el, false );
+  whenNotFull( p );
+}
+
+//! Adds an item to the head of the queue, by swapping it with \a el (which is left default-constructed).  Will block while
+//! the queue is full.
+template <typename Type>
+inline void SizedQueue<Type>::push_front_swap( Type &el )
+{
+  SwapPusher p( el, true );
+  whenNotFull( p );
+}
+
 //! Overridden to use our functor.
 template <typename Type>
 inline Type SizedQueue<Type>::pop_back( void )
@@ -179,46 +264,69 @@ inline bool SizedQueue<Type>::pop_front( Type &dest, Time timeout )
 }
 
 
+//! Adds the items in [\a begin, \a end) to the tail of the queue, taking the lock once for each run of items that fits
+//! (and waking a waiter per item).  Will block while the queue is full.
+template <typename Type>
+template <typename InputIterator>
+void SizedQueue<Type>::push_range( InputIterator begin, InputIterator end )
+{
+  RangePusher<InputIterator> p( begin, end );
+  while ( begin != end )
+    whenNotFull( p );
+}
+
+//! Moves every item in the queue to the end of \a dest (without blocking), and returns the number of items moved.
+template <typename Type>
+template <typename Container>
+unsigned SizedQueue<Type>::pop_all( Container &dest )
+{
+  RangePopper<Container> p( dest, ~0U );
+  Lock _( Queue<Type>::_guard );
+  p( *this );
+  return p.count;
+}
+
+//! Moves up to \a max items from the head of the queue to the end of \a dest, waiting up to \a timeout for the first.
+//! Returns the number of items moved.
+template <typename Type>
+template <typename Container>
+unsigned SizedQueue<Type>::pop_up_to( unsigned max, Container &dest, Time timeout )
+{
+  RangePopper<Container> p( dest, max );
+  ifNotEmpty( p, timeout );
+  return p.count;
+}
+
+
 //! If the queue is full, blocks until an item has been removed.  Then calls functor \a func (passing the queue reference).
 template <typename Type>
 template <typename Functor>
 void SizedQueue<Type>::whenNotFull( Functor &func )
 {
-  Queue<Type>::_guard.lock();
-  while ( full() ) {
-    _notFull.lock();
-    Queue<Type>::_guard.unlock();
-    _notFull.wait();
-    Queue<Type>::_guard.lock();
-    _notFull.unlock();
-  }
+  Lock _( Queue<Type>::_guard );
+  while ( deque<Type>::size() >= _capacity )
+    _notFull.wait( Queue<Type>::_guard );
 
   func( *this );
-  Queue<Type>::_guard.unlock();
 }
 
-//! Calls functor \a func (passing the queue reference) if the queue is not empty, or becomes non-empty before \a timeout, and returns \c true.
-//! If the queue is still empty, \a func is not called and \c false is returned.
+//! Calls functor \a func (passing the queue reference) if the queue is not full, or has room before \a timeout, and returns \c true.
+//! If the queue is still full, \a func is not called and \c false is returned.
 template <typename Type>
 template <typename Functor>
 bool SizedQueue<Type>::ifNotFull( Functor &func, Time timeout )
 {
-  Queue<Type>::_guard.lock();
-  if ( full() ) {
-    _notFull.lock();
-    Queue<Type>::_guard.unlock();
-
-    if ( ((timeout != 0.0) && !_notFull.wait( timeout )) || full() ) {
-      _notFull.unlock();
-      return false;
-    }
-
-    Queue<Type>::_guard.lock();
-    _notFull.unlock();
+  Lock _( Queue<Type>::_guard );
+  if ( (deque<Type>::size() >= _capacity) && (timeout > 0.0) ) {
+    Time deadline = Time::now() + timeout;
+    while ( (deque<Type>::size() >= _capacity) && _notFull.wait( Queue<Type>::_guard, deadline ) )
+      ;
   }
 
+  if ( deque<Type>::size() >= _capacity )
+    return false;
+
   func( *this );
-  Queue<Type>::_guard.unlock();
   return true;
 }
 
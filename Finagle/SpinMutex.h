@@ -0,0 +1,154 @@
+/*!
+** \file SpinMutex.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#ifndef FINAGLE_SPINMUTEX_H
+#define FINAGLE_SPINMUTEX_H
+
+#include <Finagle/Mutex.h>
+#include <Finagle/RingQueue.h>
+
+namespace Finagle {
+
+/*! \brief A mutex which busy-waits, for very short critical sections
+**
+** Locking and unlocking an uncontended SpinMutex is a single atomic exchange (and a store), with no system calls.  A
+** contended lock backs off as RingQueue does (see RingQueueBase::relax()), pausing the CPU for a few attempts, then
+** yielding to other threads between attempts, so a holder which has been preempted isn't starved.  It is best suited
+** to critical sections of a few instructions (e.g. a free list, or a counter) which are never held across blocking
+** calls.
+**
+** Unlike Mutex, a SpinMutex is \e not recursive.
+*/
+class SpinMutex {
+public:
+  SpinMutex( void );
+
+  void lock( void );
+  bool tryLock( void );
+  void unlock( void );
+
+protected:
+  int volatile _locked;
+
+private:
+  SpinMutex( SpinMutex const & );
+  SpinMutex &operator =( SpinMutex const & );
+};
+
+/*! \brief A mutex which spins briefly, then parks on a futex
+**
+** For critical sections which are usually short, but occasionally long: a contended lock first spins (as SpinMutex),
+** in case the holder is about to release it, then sleeps until it's released, rather than burning CPU.  Uncontended,
+** locking and unlocking are each a single atomic operation, and unlocking only makes a system call if another thread
+** is parked.
+**
+** Like SpinMutex, an AdaptiveMutex is \e not recursive.
+*/
+class AdaptiveMutex {
+public:
+  static const unsigned SpinTries = 64;  //!< Attempts to take the lock before parking
+
+public:
+  AdaptiveMutex( void );
+
+  void lock( void );
+  bool tryLock( void );
+  void unlock( void );
+
+protected:
+  //! \c 0 if unlocked, \c 1 if locked, or \c 2 if locked with (possibly) parked waiters
+  int volatile _state;
+
+private:
+  AdaptiveMutex( AdaptiveMutex const & );
+  AdaptiveMutex &operator =( AdaptiveMutex const & );
+};
+
+typedef BasicLock<SpinMutex> SpinLock;          //!< Locks a SpinMutex, while in scope
+typedef BasicLock<AdaptiveMutex> AdaptiveLock;  //!< Locks an AdaptiveMutex, while in scope
+
+// INLINE IMPLEMENTATION **********************************************************************************************************
+
+inline SpinMutex::SpinMutex( void )
+: _locked( 0 )
+{}
+
+//! Locks the mutex, spinning while another thread holds it.
+inline void SpinMutex::lock( void )
+{
+  for ( unsigned attempt = 0; __sync_lock_test_and_set( &_locked, 1 ); )
+    do
+      RingQueueBase::relax( attempt++ );
+    while ( _locked );
+}
+
+//! Locks the mutex, if it's not locked by another thread, and returns \c true iff it was locked.
+inline bool SpinMutex::tryLock( void )
+{
+  return !_locked && !__sync_lock_test_and_set( &_locked, 1 );
+}
+
+//! Unlocks the mutex.
+inline void SpinMutex::unlock( void )
+{
+  __sync_lock_release( &_locked );
+}
+
+inline AdaptiveMutex::AdaptiveMutex( void )
+: _state( 0 )
+{}
+
+//! Locks the mutex, spinning briefly, then parking while another thread holds it.
+inline void AdaptiveMutex::lock( void )
+{
+  for ( unsigned attempt = 0; attempt < SpinTries; ++attempt ) {
+    if ( !_state && __sync_bool_compare_and_swap( &_state, 0, 1 ) )
+      return;
+
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+  }
+
+  // Mark the mutex contended (so the holder will wake us) and park, until it's released
+  while ( __sync_lock_test_and_set( &_state, 2 ) )
+    RingQueueBase::Parking::park( &_state, 2, Time() );
+}
+
+//! Locks the mutex, if it's not locked by another thread, and returns \c true iff it was locked.
+inline bool AdaptiveMutex::tryLock( void )
+{
+  return !_state && __sync_bool_compare_and_swap( &_state, 0, 1 );
+}
+
+//! Unlocks the mutex, waking a parked thread (if there may be any).
+inline void AdaptiveMutex::unlock( void )
+{
+  if ( __sync_fetch_and_sub( &_state, 1 ) != 1 ) {
+    _state = 0;
+    RingQueueBase::Parking::unpark( &_state, 1 );
+  }
+}
+
+}
+
+#endif
@@ -138,6 +138,14 @@ inline bool operator ==( NoCase const &a, const char *b ) {  return a.compare( b
 inline bool operator ==( NoCase const &a, std::string const &b ) {  return a.compare( b.c_str() ) == 0;  }
 inline std::ostream &operator <<( std::ostream &out, NoCase const &str ) {  return out << str.c_str();  }
 
+//! Exchanges the contents of \a a and \a b, without copying either.
+inline void swap( String &a, String &b ) {  a.swap( b );  }
+
+template <typename Type> struct QueueSwaps;  // see Queue.h
+
+//! Queues hand Strings out by swapping, rather than copying them
+template <> struct QueueSwaps<String> {  static const bool value = true;  };
+
 // INLINE IMPLEMENTATION **********************************************************************************************************
 
 //! Initializes the string to empty.
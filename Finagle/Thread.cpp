@@ -19,11 +19,21 @@
 ** at http://www.gnu.org/copyleft/lesser.html .
 */
 
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
 #include "Thread.h"
 #include "AppLog.h"
 #include "AppLoop.h"
 #include "MemTrace.h"
 
+using namespace std;
 using namespace Finagle;
 
 static class ThreadData {
@@ -53,13 +63,204 @@ pthread_key_t ThreadData::threadClass;
 
 /*! \class Finagle::Thread
 ** \brief Multi-thread object (via \c pthreads)
+**
+** A thread may be given Options before it's started, to name it, confine it to a set of CPUs or a NUMA node, size its
+** stack, or set its scheduling policy.  To spread threads over the machine, one per physical core before doubling up
+** on hyperthreads, start the <em>n</em>th with Options::forCore( \e n ), e.g.: \code
+** for ( unsigned i = 0; i < Thread::cpus().size(); ++i )
+**   loops.push_back( new AppLoop::LoopThread( Thread::Options::forCore( i ) ) );
+** \endcode
+*/
+
+namespace {
+  //! Parses a Linux CPU or node list (e.g. \c "0-3,8-11").
+  Array<unsigned> parseList( string const &list )
+  {
+    Array<unsigned> items;
+    char const *p = list.c_str();
+    while ( *p ) {
+      char *end;
+      unsigned first = strtoul( p, &end, 10 ), last = first;
+      if ( end == p )
+        break;
+
+      if ( *end == '-' ) {
+        p = end + 1;
+        last = strtoul( p, &end, 10 );
+      }
+      for ( unsigned i = first; i <= last; ++i )
+        items.push_back( i );
+
+      p = (*end == ',') ? end + 1 : end;
+    }
+
+    return items;
+  }
+
+  //! Reads the first line of a (\c /sys) file, or returns an empty string.
+  string readLine( string const &path )
+  {
+    ifstream in( path.c_str() );
+    string line;
+    getline( in, line );
+    return line;
+  }
+
+  //! Identifies the physical core of \a cpu, as \c "package:core" (or the CPU itself, if the topology is unknown).
+  string coreOf( unsigned cpu )
+  {
+    String dir = String( "/sys/devices/system/cpu/cpu" ) + String( cpu ) + "/topology/";
+    string package = readLine( dir + "physical_package_id" ), core = readLine( dir + "core_id" );
+    if ( core.empty() )
+      return String( "cpu" ) + String( cpu );
+
+    return package + ":" + core;
+  }
+
+  //! Initializes a thread attributes object, and destroys it when it goes out of scope (even if a throw skips the rest).
+  class AttrGuard {
+  public:
+    AttrGuard( pthread_attr_t &attr ) : _attr( attr ) {  PTHREAD_ASSERT( pthread_attr_init( &_attr ) );  }
+   ~AttrGuard( void ) {  pthread_attr_destroy( &_attr );  }
+
+  private:
+    AttrGuard( AttrGuard const & );
+    AttrGuard &operator =( AttrGuard const & );
+
+    pthread_attr_t &_attr;
+  };
+}
+
+/*! \brief Returns the options which run the <em>index</em>th of a set of threads on its own core.
+**
+** Threads are assigned a CPU each from cpus() (so one per physical core first, then their hyperthreads), wrapping
+** around if there are more threads than CPUs.
+*/
+Thread::Options Thread::Options::forCore( unsigned index )
+{
+  Options opts;
+  Array<unsigned> all = Thread::cpus();
+  if ( !all.empty() )
+    opts.cpus.push_back( all[index % all.size()] );
+
+  return opts;
+}
+
+
+/*! \brief Returns the CPUs available to the calling thread.
+**
+** The first CPU of each physical core comes first, then any further (hyperthread) CPUs of each core, so the first
+** \e n CPUs are on separate cores, where possible.
 */
+Array<unsigned> Thread::cpus( void )
+{
+  Array<unsigned> available;
+#ifdef __GLIBC__
+  cpu_set_t set;
+  if ( sched_getaffinity( 0, sizeof(set), &set ) == 0 ) {
+    for ( unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+      if ( CPU_ISSET( cpu, &set ) )
+        available.push_back( cpu );
+  }
+#endif
+  if ( available.empty() ) {
+    long count = sysconf( _SC_NPROCESSORS_ONLN );
+    for ( long cpu = 0; cpu < count; ++cpu )
+      available.push_back( cpu );
+  }
+
+  // Order by the rank of each CPU within its core (i.e. first CPUs, then second, etc.)
+  map<string, unsigned> perCore;
+  Array<pair<unsigned, unsigned> > ranked;
+  for ( unsigned i = 0; i < available.size(); ++i )
+    ranked.push_back( make_pair( perCore[coreOf( available[i] )]++, available[i] ) );
+
+  sort( ranked.begin(), ranked.end() );
+  for ( unsigned i = 0; i < ranked.size(); ++i )
+    available[i] = ranked[i].second;
+
+  return available;
+}
+
+
+//! Returns the CPUs of NUMA node \a node (or none, if there's no such node, or NUMA topology is unavailable).
+Array<unsigned> Thread::nodeCPUs( unsigned node )
+{
+  return parseList( readLine( String( "/sys/devices/system/node/node" ) + String( node ) + "/cpulist" ) );
+}
+
+
+//! Applies the options which are set when the thread is created.
+void Thread::configure( pthread_attr_t &attr ) const
+{
+  if ( _options.stackSize ) {
+    size_t page = sysconf( _SC_PAGESIZE );
+    size_t size = max( _options.stackSize, size_t( PTHREAD_STACK_MIN ) );
+    PTHREAD_ASSERT( pthread_attr_setstacksize( &attr, (size + page - 1) / page * page ) );
+  }
+
+#ifdef __GLIBC__
+  Array<unsigned> cpus = _options.cpus;
+  if ( _options.numaNode >= 0 ) {
+    Array<unsigned> node = nodeCPUs( _options.numaNode );
+    if ( cpus.empty() )
+      cpus = node;
+    else {
+      Array<unsigned> both;
+      for ( unsigned i = 0; i < cpus.size(); ++i )
+        if ( find( node.begin(), node.end(), cpus[i] ) != node.end() )
+          both.push_back( cpus[i] );
+      if ( !both.empty() )
+        cpus = both;
+    }
+  }
+
+  if ( !cpus.empty() ) {
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    for ( unsigned i = 0; i < cpus.size(); ++i )
+      if ( cpus[i] < CPU_SETSIZE )
+        CPU_SET( cpus[i], &set );
+    PTHREAD_ASSERT( pthread_attr_setaffinity_np( &attr, sizeof(set), &set ) );
+  }
+#endif
+
+  if ( _options.policy >= 0 ) {
+    sched_param param;
+    param.sched_priority = _options.priority;
+    PTHREAD_ASSERT( pthread_attr_setinheritsched( &attr, PTHREAD_EXPLICIT_SCHED ) );
+    PTHREAD_ASSERT( pthread_attr_setschedpolicy( &attr, _options.policy ) );
+    PTHREAD_ASSERT( pthread_attr_setschedparam( &attr, &param ) );
+  }
+}
+
+
+//! Applies the options which the thread sets for itself: its name, and its preferred memory node.
+void Thread::placeSelf( void ) const
+{
+#ifdef __GLIBC__
+  if ( !_options.name.empty() )
+    pthread_setname_np( pthread_self(), _options.name.substr( 0, 15 ).c_str() );
+#endif
+
+#ifdef SYS_set_mempolicy
+  static const int PreferredNode = 1;  // MPOL_PREFERRED
+  static const unsigned MaxNodes = 1024;
+  unsigned long nodes[MaxNodes / (8 * sizeof(unsigned long))] = { 0 };
+  unsigned node = _options.numaNode;
+  if ( (_options.numaNode >= 0) && (node < MaxNodes - 1) ) {
+    nodes[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    syscall( SYS_set_mempolicy, PreferredNode, nodes, (unsigned long) MaxNodes );  // fails harmlessly without NUMA
+  }
+#endif
+}
 
 void *Thread::run( void *This )
 {
   Thread *t = (Thread *) This;
 
   __threadData.setSelf( t );
+  t->placeSelf();
   try {
     t->_exitVal = t->exec();
   }
@@ -78,20 +279,29 @@ void *Thread::run( void *This )
   return (void *) t->_exitVal;
 }
 
-/*! \brief Begins thread execution
+/*! \brief Begins thread execution, with its options()
 **
-** Does nothing if the thread is already running.
+** Does nothing if the thread is already running.  Throws PThreadEx if the options can't be applied (e.g. a real-time
+** scheduling policy without the privilege to use it, or only CPUs which are missing or offline), leaving the thread
+** stopped, so it may be given other options and started again.
 */
 void Thread::start( void )
 {
   if ( running() )  return;
 
   pthread_attr_t attr;
-  PTHREAD_ASSERT( pthread_attr_init( &attr ) );
+  AttrGuard guard( attr );
   PTHREAD_ASSERT( pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_JOINABLE ) );
+  configure( attr );
+
+  // Set before creation, as the new thread may check running() (or finish, and clear it) before pthread_create returns.
   _running = true;
-  PTHREAD_ASSERT( pthread_create( &_id, &attr, Thread::run, this ) );
-  PTHREAD_ASSERT( pthread_attr_destroy( &attr ) );
+  int res = pthread_create( &_id, &attr, Thread::run, this );
+  if ( res ) {
+    _running = false;
+    _id = 0;
+    PTHREAD_ASSERT( res );
+  }
 }
 
 //! waits for the thread to complete, and returns Thread::exitVal.
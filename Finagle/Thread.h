@@ -22,7 +22,10 @@
 #ifndef FINAGLE_THREAD_H
 #define FINAGLE_THREAD_H
 
+#include <cstddef>
+#include <Finagle/Array.h>
 #include <Finagle/PThreadEx.h>
+#include <Finagle/TextString.h>
 
 namespace Finagle {
 
@@ -30,14 +33,31 @@ class Thread {
 public:
   typedef pthread_t ID;
 
+  //! How a thread is started (see setOptions())
+  struct Options {
+    Options( void );
+    static Options forCore( unsigned index );
+
+    String name;           //!< Name shown by \c ps, \c top and debuggers (at most 15 characters), or empty
+    Array<unsigned> cpus;  //!< CPUs the thread may run on (or empty for any)
+    int numaNode;          //!< NUMA node whose CPUs the thread may run on, and whose memory it prefers (or \c -1 for any)
+    size_t stackSize;      //!< Stack size, in bytes (or \c 0 for the default)
+    int policy;            //!< Scheduling policy (e.g. \c SCHED_FIFO), or \c -1 to inherit the creator's
+    int priority;          //!< Scheduling priority, within #policy
+  };
+
 public:
   Thread( void );
+  Thread( Options const &options );
   virtual ~Thread( void );
 
   bool running( void ) const;
   Thread::ID const &id( void ) const;
   int  exitVal( void ) const;
 
+  Options const &options( void ) const;
+  void setOptions( Options const &options );
+
   void start( void );
   int  join( void );
   void stop( void );
@@ -47,6 +67,9 @@ public:
   static Thread::ID self_id( void );
   static void exit( int res );
 
+  static Array<unsigned> cpus( void );
+  static Array<unsigned> nodeCPUs( unsigned node );
+
 protected:
   virtual int exec( void ) = 0;
 
@@ -54,19 +77,32 @@ protected:
   ID _id;
   bool _running;
   int _exitVal;
+  Options _options;
 
 private:
   static pthread_key_t _thread;
   static void *run( void *This );
+  void configure( pthread_attr_t &attr ) const;
+  void placeSelf( void ) const;
 };
 
 // INLINE IMPLEMENTATION ******************************************************
 
+//! Default options: unnamed, on any CPU or node, with the default stack and the creator's scheduling.
+inline Thread::Options::Options( void )
+: numaNode( -1 ), stackSize( 0 ), policy( -1 ), priority( 0 )
+{}
+
 //! Creates a new (stopped) thread
 inline Thread::Thread( void )
 : _id(0), _running(false), _exitVal(0)
 {}
 
+//! Creates a new (stopped) thread, to be started with \a options
+inline Thread::Thread( Options const &options )
+: _id(0), _running(false), _exitVal(0), _options( options )
+{}
+
 //! Stops the thread, if running
 inline Thread::~Thread( void )
 {
@@ -85,6 +121,18 @@ inline bool Thread::running( void ) const
   return _running;
 }
 
+//! Returns the options the thread is (or will be) started with.
+inline Thread::Options const &Thread::options( void ) const
+{
+  return _options;
+}
+
+//! Sets the options the thread will next be started with.
+inline void Thread::setOptions( Options const &options )
+{
+  _options = options;
+}
+
 //! Returns the final exit value (or \c 0 if the thread is still running)
 inline int Thread::exitVal( void ) const
 {
@@ -0,0 +1,256 @@
+/*!
+** \file ThreadPool.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <unistd.h>
+
+#include "ThreadPool.h"
+#include "AppLog.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::ThreadPool
+** \brief A fixed set of worker threads which run submitted tasks, each worker stealing from the others when it runs out.
+**
+** Each worker keeps its own deque of tasks.  Tasks submitted by a worker (e.g. to split up its own work) go onto its
+** deque, and are run most-recent-first, while they're still in cache; tasks submitted from other threads go onto a
+** shared queue, and are run in order.  A worker with nothing left to run steals the oldest task from another worker's
+** deque, and only parks once there's nothing to steal.
+**
+** post() runs a task for its side effects; submit() returns a Future for the task's result (or exception).
+**
+** Example: \code
+** ThreadPool pool;
+**
+** Future<unsigned> count = pool.submit( boost::bind( &Index::count, &index, term ) );
+** pool.post( boost::bind( &Index::compact, &index ) );
+** ...
+** LOG_INFO << term << ": " << count.get();
+** \endcode
+**
+** When shut down (or destroyed), the pool stops accepting tasks, runs those already submitted, then stops and joins
+** its workers.
+*/
+
+/*! \brief Starts a pool of \a workers threads.
+**
+** If \a workers is \c 0, starts one per processor (see hardwareConcurrency()).  If \a pinned, each worker is confined to
+** a CPU of its own, one per physical core first (see Thread::Options::forCore()).
+*/
+ThreadPool::ThreadPool( unsigned workers, bool pinned )
+: _guard( "ThreadPool" ), _closed( false )
+{
+  if ( !workers )
+    workers = hardwareConcurrency();
+
+  Array<unsigned> cpus;
+  if ( pinned )
+    cpus = Thread::cpus();
+
+  _workers.reserve( workers );
+  for ( unsigned i = 0; i < workers; ++i ) {
+    Thread::Options opts;
+    opts.name = String( "pool worker " ) + String( i );
+    if ( !cpus.empty() )
+      opts.cpus.push_back( cpus[i % cpus.size()] );
+
+    _workers.push_back( new Worker( *this, i, opts ) );
+  }
+
+  for ( unsigned i = 0; i < workers; ++i )
+    _workers[i]->start();
+}
+
+//! Shuts down the pool, running any tasks already submitted.
+ThreadPool::~ThreadPool( void )
+{
+  shutdown();
+
+  for ( unsigned i = 0; i < _workers.size(); ++i )
+    delete _workers[i];
+}
+
+
+/*! \brief Runs \a task on one of the pool's workers.
+**
+** Exceptions thrown by \a task are logged.
+**
+** \throw ClosedEx if the pool has been shut down (and this isn't one of its workers).
+*/
+void ThreadPool::post( Task const &task )
+{
+  Worker *self = dynamic_cast<Worker *>( Thread::self() );
+  if ( self && (&self->pool == this) )
+    self->push( task );  // even while shutting down, as the workers are still running
+  else {
+    // Checked under the guard, so no task can be injected once shutdown() has closed the pool
+    Lock _( _guard );
+    if ( _closed )
+      throw ClosedEx();
+
+    _injected.push_back( task );
+  }
+
+  _idle.notify();
+}
+
+
+/*! \brief Stops accepting tasks, and waits for the workers to run those already submitted (and any they submit in
+** turn), then exit.
+**
+** Must not be called from one of the pool's own workers.
+*/
+void ThreadPool::shutdown( void )
+{
+  {
+    Lock _( _guard );
+    if ( _closed )
+      return;
+
+    _closed = true;
+  }
+  _idle.notifyAll();
+
+  for ( unsigned i = 0; i < _workers.size(); ++i )
+    _workers[i]->join();
+}
+
+
+//! Returns the number of online processors (at least \c 1).
+unsigned ThreadPool::hardwareConcurrency( void )
+{
+  long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+  return (cpus > 0) ? unsigned( cpus ) : 1;
+}
+
+//! Returns the pool whose worker is the current thread (or \c 0, if it isn't a pool worker).
+ThreadPool *ThreadPool::current( void )
+{
+  Worker *self = dynamic_cast<Worker *>( Thread::self() );
+  return self ? &self->pool : 0;
+}
+
+
+//! Finds the next task for \a worker: from its own deque, then the shared queue, then other workers' deques.
+bool ThreadPool::next( Worker &worker, Task &task )
+{
+  if ( worker.pop( task ) )
+    return true;
+
+  {
+    Lock _( _guard );
+    if ( !_injected.empty() ) {
+      task.swap( _injected.front() );
+      _injected.pop_front();
+      return true;
+    }
+  }
+
+  unsigned count = _workers.size();
+  for ( unsigned i = 1; i < count; ++i )
+    if ( _workers[(worker.index + i) % count]->steal( task ) )
+      return true;
+
+  return false;
+}
+
+
+//! Returns \c true iff the pool has been shut down, and has no tasks left anywhere (so a worker with none may exit).
+bool ThreadPool::finished( void ) const
+{
+  Lock _( _guard );
+  if ( !_closed || !_injected.empty() )
+    return false;
+
+  for ( unsigned i = 0; i < _workers.size(); ++i )
+    if ( !_workers[i]->empty() )
+      return false;
+
+  return true;
+}
+
+
+ThreadPool::Worker::Worker( ThreadPool &p, unsigned i, Thread::Options const &options )
+: Thread( options ), pool( p ), index( i ), _guard( "ThreadPool::Worker" )
+{}
+
+//! Adds \a task to the back of the worker's deque.
+void ThreadPool::Worker::push( Task const &task )
+{
+  Lock _( _guard );
+  _tasks.push_back( task );
+}
+
+//! Removes the newest task from the worker's deque (for the worker itself).
+bool ThreadPool::Worker::pop( Task &task )
+{
+  Lock _( _guard );
+  if ( _tasks.empty() )
+    return false;
+
+  task.swap( _tasks.back() );
+  _tasks.pop_back();
+  return true;
+}
+
+//! Removes the oldest task from the worker's deque (for another worker).
+bool ThreadPool::Worker::steal( Task &task )
+{
+  Lock _( _guard );
+  if ( _tasks.empty() )
+    return false;
+
+  task.swap( _tasks.front() );
+  _tasks.pop_front();
+  return true;
+}
+
+//! Returns \c true iff the worker's deque is empty.
+bool ThreadPool::Worker::empty( void ) const
+{
+  Lock _( _guard );
+  return _tasks.empty();
+}
+
+//! Runs tasks until the pool is shut down, and there are none left.
+int ThreadPool::Worker::exec( void )
+{
+  while ( true ) {
+    Task task;
+    RingQueueBase::await( pool._idle, Finder( *this, task ), Time() );
+    if ( !task )
+      return 0;  // closed, and nothing left to run
+
+    try {
+      task();
+    }
+    catch ( Finagle::Exception &ex ) {
+      Finagle::Log() << ex;
+    }
+    catch ( std::exception &ex ) {
+      LOG_ERROR << "Unhandled exception in pool task: " << ex.what();
+    }
+    catch ( ... ) {
+      LOG_ERROR << "Unhandled exception in pool task: <unknown>";
+    }
+  }
+}
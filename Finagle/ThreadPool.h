@@ -0,0 +1,154 @@
+/*!
+** \file ThreadPool.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#ifndef FINAGLE_THREADPOOL_H
+#define FINAGLE_THREADPOOL_H
+
+#include <deque>
+#include <boost/function.hpp>
+#include <boost/utility/result_of.hpp>
+#include <Finagle/Array.h>
+#include <Finagle/Future.h>
+#include <Finagle/Mutex.h>
+#include <Finagle/RingQueue.h>
+#include <Finagle/Thread.h>
+
+namespace Finagle {
+
+//! A fixed set of worker threads which run submitted tasks, each worker stealing from the others when it runs out.
+class ThreadPool {
+public:
+  //! A unit of work
+  typedef boost::function< void() > Task;
+
+  //! %Exception thrown when submitting to a pool which has been shut down
+  class ClosedEx : public Exception {
+  public:
+    ClosedEx( void ) : Exception( "Thread pool is shut down" ) {}
+  };
+
+public:
+  ThreadPool( unsigned workers = 0, bool pinned = false );
+ ~ThreadPool( void );
+
+  unsigned size( void ) const;
+  bool closed( void ) const;
+
+  void post( Task const &task );
+
+  template <typename Func>
+  Future<typename boost::result_of<Func()>::type> submit( Func func );
+
+  void shutdown( void );
+
+public:
+  static unsigned hardwareConcurrency( void );
+  static ThreadPool *current( void );
+
+protected:
+  //! A worker thread, with its own deque of tasks (popped LIFO by the worker, and stolen FIFO by the others)
+  class Worker : public Thread {
+  public:
+    Worker( ThreadPool &pool, unsigned index, Thread::Options const &options );
+
+    void push( Task const &task );
+    bool pop( Task &task );
+    bool steal( Task &task );
+    bool empty( void ) const;
+
+  public:
+    ThreadPool &pool;
+    unsigned index;
+
+  protected:
+    int exec( void );
+
+  protected:
+    mutable Mutex _guard;
+    std::deque<Task> _tasks;
+  };
+  friend class Worker;
+
+  //! Looks for a task for a worker, for RingQueueBase::await()
+  struct Finder {
+    Finder( Worker &w, Task &t ) : worker( w ), task( t ) {}
+    bool operator()( void ) {  return worker.pool.next( worker, task ) || worker.pool.finished();  }
+    Worker &worker;
+    Task &task;
+  };
+
+  template <typename Result, typename Func>
+  struct Job {
+    Job( Promise<Result> const &p, Func const &f ) : promise( p ), func( f ) {}
+    void operator()( void ) {  promise.run( func );  }
+    Promise<Result> promise;
+    Func func;
+  };
+
+  bool next( Worker &worker, Task &task );
+  bool finished( void ) const;
+
+protected:
+  Array<Worker *> _workers;
+  mutable Mutex _guard;             //!< Guards #_injected and #_closed
+  std::deque<Task> _injected;       //!< Tasks submitted from outside the pool's workers
+  RingQueueBase::Parking _idle;     //!< Workers with nothing to do
+  bool volatile _closed;            //!< Set (under #_guard) by shutdown()
+
+private:
+  ThreadPool( ThreadPool const & );
+  ThreadPool &operator =( ThreadPool const & );
+};
+
+// INLINE/TEMPLATE IMPLEMENTATION *************************************************************************************************
+
+//! Returns the number of worker threads.
+inline unsigned ThreadPool::size( void ) const
+{
+  return _workers.size();
+}
+
+//! Returns \c true iff the pool has been shut down (and accepts no more tasks).
+inline bool ThreadPool::closed( void ) const
+{
+  return _closed;
+}
+
+/*! \brief Runs \a func on one of the pool's workers, and returns a future for its result.
+**
+** Any exception thrown by \a func fails the future, rather than the worker.
+**
+** \throw ClosedEx if the pool has been shut down.
+*/
+template <typename Func>
+Future<typename boost::result_of<Func()>::type> ThreadPool::submit( Func func )
+{
+  typedef typename boost::result_of<Func()>::type Result;
+
+  Promise<Result> promise;
+  post( Job<Result, Func>( promise, func ) );
+  return promise.future();
+}
+
+}
+
+#endif
@@ -34,16 +34,20 @@ using namespace AppLoop;
 ** timer->start();
 ** \endcode
 **
+** Timers are scheduled on (and triggered by) the application loop of the thread which created them, unless another
+** loop is given.
+**
+** By default, a timer fires as soon as possible after its alarm.  Timers which can tolerate some lateness (e.g.
+** connection timeouts) should be given a slack (see setSlack()), so that the loop can fire many of them in a single
+** wakeup.
+**
 ** \sa AppLoop.
 */
 
 void Timer::start( void )
 {
-  if ( isRunning() )
-    Timers().remove( this );
-
-  _nextAlarm = Time::now() + _period;
-  Timers().insert( this );
+  _nextAlarm = _loop->clock().now() + _period;
+  _loop->timers().insert( this );
 }
 
 
@@ -52,8 +56,26 @@ void Timer::stop( void )
   if ( !isRunning() )
     return;
 
-  Timers().remove( this );
   _nextAlarm = 0;
+  _loop->timers().remove( this );
+}
+
+
+/*! \brief Allows the timer to fire up to \a slack seconds after its alarm.
+**
+** The loop then aligns the timer to a boundary within that window, shared by other timers due at about the same time,
+** so that they're all triggered by a single wakeup.  Timers without slack (the default) keep their full precision.
+** The alarm of a recurring timer is unaffected, so slack never accumulates across periods.
+**
+** \sa TimerWheel::Stats.
+*/
+void Timer::setSlack( Time slack )
+{
+  _slack = slack;
+
+  // Re-schedule, if we're waiting in the wheel
+  if ( _loop->timers().contains( this ) )
+    _loop->timers().insert( this );
 }
 
 
@@ -62,12 +84,13 @@ void Timer::trigger( void )
   if ( !_repeat )
     _nextAlarm = 0;
 
-  Timers().remove( this );
+  _loop->timers().remove( this );
 
   (*this)();
 
-  if ( _repeat ) {
+  // Re-schedule, unless a slot has stopped or restarted us.
+  if ( _repeat && isRunning() && !_loop->timers().contains( this ) ) {
     _nextAlarm += _period;
-    Timers().insert( this );
+    _loop->timers().insert( this );
   }
 }
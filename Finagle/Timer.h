@@ -24,9 +24,8 @@
 
 #include <Finagle/AppLoop.h>
 #include <Finagle/ObjectPtr.h>
-#include <Finagle/List.h>
 #include <Finagle/DateTime.h>
-#include <Finagle/Singleton.h>
+#include <Finagle/TimerWheel.h>
 
 #include <iostream>
 
@@ -37,9 +36,9 @@ public:
   typedef ObjectPtr<Timer> Ptr;
 
 public:
-  static Timer::Ptr SingleShot( Time const &delay );
-  static Timer::Ptr Recurring( Time const &period );
-  Timer( Time const &period, bool repeat );
+  static Timer::Ptr SingleShot( Time const &delay, AppLoop::Loop &loop = AppLoop::Loop::current() );
+  static Timer::Ptr Recurring( Time const &period, AppLoop::Loop &loop = AppLoop::Loop::current() );
+  Timer( Time const &period, bool repeat, AppLoop::Loop &loop = AppLoop::Loop::current() );
 
   bool isRunning( void ) const;
 
@@ -49,6 +48,10 @@ public:
   void restart( void );
 
   Time const &nextAlarm( void ) const;
+  Time const &period( void ) const;
+  Time const &slack( void ) const;
+  void setSlack( Time slack );
+  AppLoop::Loop &loop( void ) const;
   bool operator <( Timer const &that ) const;
 
 protected:
@@ -58,25 +61,32 @@ protected:
   Time _nextAlarm;
   Time _period;
   bool _repeat;
+  Time _slack;
+  AppLoop::Loop *_loop;
+
+private:
+  Time _fireAt;
+  Timer *_wheelPrev, *_wheelNext;
+  int _wheelSlot;
 
 protected:
-  friend void AppLoop::process( Time );
+  friend class TimerWheel;
 };
 
 // INLINE IMPLEMENTATION ******************************************************
 
-inline Timer::Ptr Timer::SingleShot( Time const &delay )
+inline Timer::Ptr Timer::SingleShot( Time const &delay, AppLoop::Loop &loop )
 {
-  return new Timer( delay, false );
+  return new Timer( delay, false, loop );
 }
 
-inline Timer::Ptr Timer::Recurring( Time const &period )
+inline Timer::Ptr Timer::Recurring( Time const &period, AppLoop::Loop &loop )
 {
-  return new Timer( period, true );
+  return new Timer( period, true, loop );
 }
 
-inline Timer::Timer( Time const &period, bool repeat )
-: _nextAlarm( 0 ), _period( period ), _repeat( repeat )
+inline Timer::Timer( Time const &period, bool repeat, AppLoop::Loop &loop )
+: _nextAlarm( 0 ), _period( period ), _repeat( repeat ), _slack( 0.0 ), _loop( &loop ), _fireAt( 0 ), _wheelPrev( 0 ), _wheelNext( 0 ), _wheelSlot( -1 )
 {
   start();
 }
@@ -103,13 +113,27 @@ inline Time const &Timer::nextAlarm( void ) const
   return _nextAlarm;
 }
 
-inline bool Timer::operator <( Timer const &that ) const
+//! Returns the timer's period (or delay, for a single-shot timer).
+inline Time const &Timer::period( void ) const
 {
-  return _nextAlarm < that._nextAlarm;
+  return _period;
+}
+
+//! Returns how late the timer may fire, so that it can be coalesced with others (see setSlack()).
+inline Time const &Timer::slack( void ) const
+{
+  return _slack;
 }
 
-namespace AppLoop {
-  static Singleton<List<Timer::Ptr> > Timers;
+//! Returns the application loop on which the timer is scheduled.
+inline AppLoop::Loop &Timer::loop( void ) const
+{
+  return *_loop;
+}
+
+inline bool Timer::operator <( Timer const &that ) const
+{
+  return _nextAlarm < that._nextAlarm;
 }
 
 };
@@ -0,0 +1,406 @@
+/*!
+** \file TimerWheel.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "TimerWheel.h"
+#include "Timer.h"
+
+using namespace std;
+using namespace Finagle;
+
+/*! \class Finagle::TimerWheel
+** \brief Hierarchical timing wheel.
+**
+** Timers are kept in one of #Levels wheels of #Slots slots each.  The first level has one slot per #TickTime, and
+** each following level has one slot per full turn of the level below it.  A timer goes into the lowest level whose
+** current turn contains its alarm; as time advances into a higher-level slot, its timers are cascaded down.
+**
+** Each slot is an intrusive, doubly-linked list, so insert() and remove() are O(1), and expiry costs O(1) per timer
+** (plus a cascade per level).  Bitmaps of occupied slots let advance() skip over empty stretches of time.
+**
+** Timers never fire before their exact alarm time: within the current slot, popExpired() returns only those timers
+** that are due, earliest first.  It moves all of them into a separate, sorted list in one pass, so expiring \e k timers
+** from one slot costs O(\e k log \e k), rather than a scan of the slot per timer.  A timer with slack (see Timer::setSlack()) is scheduled for a coalesced time instead
+** (see coalesce()), which is shared by other timers due at about the same time, so that they expire together.
+**
+** \sa Timer and AppLoop.
+*/
+
+const double TimerWheel::TickTime = 0.001;
+
+
+//! Creates an empty wheel, starting at time \a now.
+TimerWheel::TimerWheel( Time now )
+: _now( toTick( now ) ), _size( 0 )
+{
+  memset( _slots, 0, sizeof(_slots) );
+  memset( _occupied, 0, sizeof(_occupied) );
+  resetStats();
+}
+
+
+//! Releases any remaining timers.
+TimerWheel::~TimerWheel( void )
+{
+  for ( unsigned slot = 0; slot <= Due; ++slot ) {
+    while ( Timer *timer = _slots[slot] ) {
+      unlink( timer );
+      if ( timer->deref() )
+        delete timer;
+    }
+  }
+}
+
+
+//! Restarts an empty wheel at time \a now (e.g. when its loop changes clocks).
+void TimerWheel::reset( Time now )
+{
+  if ( _size )
+    return;
+
+  _now = toTick( now );
+}
+
+
+//! Returns \c true if \a timer is scheduled in this wheel.
+bool TimerWheel::contains( Timer const *timer ) const
+{
+  return timer->_wheelSlot != -1;
+}
+
+
+/*! \brief Schedules \a timer for its Timer::nextAlarm() (coalesced, if it has slack).
+**
+** The wheel holds a reference to the timer until it's removed.
+*/
+void TimerWheel::insert( Timer *timer )
+{
+  timer->_fireAt = coalesce( timer->nextAlarm(), timer->slack() );
+  if ( timer->_fireAt != timer->nextAlarm() )
+    _stats.deferred++;
+
+  if ( contains( timer ) ) {
+    unlink( timer );
+  } else {
+    timer->ref();
+    _size++;
+  }
+
+  schedule( timer );
+}
+
+
+//! Unschedules \a timer, if it's scheduled.
+void TimerWheel::remove( Timer *timer )
+{
+  if ( !contains( timer ) )
+    return;
+
+  unlink( timer );
+  _size--;
+
+  if ( timer->deref() )
+    delete timer;
+}
+
+
+/*! \brief Returns the time at which the earliest timer may be due (or an invalid time, if the wheel is empty).
+**
+** For timers in the lowest level, this is the exact (or coalesced) alarm time.  For timers in higher levels, it's the start of their
+** slot, which is never later than the alarm time; waiting until then lets the timers cascade down.
+*/
+Time TimerWheel::nextAlarm( void ) const
+{
+  if ( !_size )
+    return 0.0;
+
+  if ( _slots[Due] )
+    return _slots[Due]->_fireAt;
+
+  for ( unsigned level = 0; level < Levels; ++level ) {
+    unsigned shift = level * SlotBits;
+    unsigned cur = unsigned( _now >> shift ) & (Slots - 1);
+
+    // Timers within the current turn of this level are never in its current slot (except at the lowest level)
+    int slot = nextSlot( level, level ? (cur + 1) : cur );
+    if ( slot == -1 )
+      continue;
+
+    if ( level == 0 )
+      return earliest( slot )->_fireAt;
+
+    Tick turn = (_now >> (shift + SlotBits)) << (shift + SlotBits);
+    return Time( double( turn + (Tick( slot ) << shift) ) * TickTime );
+  }
+
+  return earliest( Overflow )->_fireAt;
+}
+
+
+/*! \brief Removes and returns the earliest timer due at or before \a now (or \c 0, if none are due).
+**
+** The wheel's reference to the timer is transferred to the returned pointer.  Timers which become due while those
+** already collected are being popped (e.g. scheduled by their notifications) are returned after them.
+*/
+ObjectPtr<Timer> TimerWheel::popExpired( Time now )
+{
+  Tick target = toTick( now );
+
+  while ( _size ) {
+    // Anything left in the current slot when we're about to move past it is due (allowing for rounding).
+    if ( !_slots[Due] )
+      collectDue( unsigned( _now ) & (Slots - 1), (_now < target) ? Time( -1.0 ) : now );
+
+    if ( Timer *timer = _slots[Due] ) {
+      ObjectPtr<Timer> res( timer );
+      unlink( timer );
+      _size--;
+      timer->deref();
+      return res;
+    }
+
+    if ( _now >= target )
+      break;
+
+    advance( target );
+  }
+
+  return 0;
+}
+
+
+/*! \brief Triggers every timer due at or before \a now, earliest first.
+**
+** Returns \c false (leaving any remaining timers untriggered) as soon as \a stop becomes \c true.  If \a stats is
+** given, records each timer's lag and notification time.
+*/
+bool TimerWheel::trigger( Time now, bool const volatile &stop, LoopStats *stats )
+{
+  bool woken = false;
+  Time triggerStart = stats ? Time::now() : Time();
+  while ( ObjectPtr<Timer> timer = popExpired( now ) ) {
+    if ( !woken ) {
+      woken = true;
+      _stats.wakeups++;
+    }
+    _stats.fired++;
+
+    if ( stats ) {
+      // Lag is in the loop's time (which may be virtual), plus however long the timers before this one took
+      Time start = Time::now();
+      stats->lag.add( (now - timer->_fireAt) + (start - triggerStart) );
+      timer->trigger();
+      stats->timer( start, timer );
+    } else
+      timer->trigger();
+
+    if ( stop )
+      return false;
+  }
+
+  return true;
+}
+
+
+/*! \brief Returns the time at which to fire a timer due at \a alarm, which may fire up to \a slack seconds late.
+**
+** Rounds the alarm up to a multiple of the largest power-of-two number of ticks within the slack, so that timers with
+** similar alarms and slack share a fire time (and thus a single wakeup), and the result is never outside the window.
+*/
+Time TimerWheel::coalesce( Time alarm, Time slack )
+{
+  Tick window = (slack > 0.0) ? Tick( slack / TickTime ) : 0;
+  if ( window < 2 )
+    return alarm;
+
+  Tick grain = Tick( 1 ) << (63 - __builtin_clzll( window ));
+  Tick tick = toTick( alarm );
+  if ( Time( double( tick ) * TickTime ) < alarm )
+    tick++;
+
+  tick = ((tick + grain - 1) / grain) * grain;
+  return Time( double( tick ) * TickTime );
+}
+
+
+//! Places \a timer into the appropriate slot for its alarm time.
+void TimerWheel::schedule( Timer *timer )
+{
+  Tick tick = toTick( timer->_fireAt );
+  if ( tick < _now )
+    tick = _now;
+
+  for ( unsigned level = 0; level < Levels; ++level ) {
+    unsigned shift = (level + 1) * SlotBits;
+    if ( (tick >> shift) == (_now >> shift) ) {
+      link( timer, (level * Slots) + (unsigned( tick >> (level * SlotBits) ) & (Slots - 1)) );
+      return;
+    }
+  }
+
+  link( timer, Overflow );
+}
+
+
+/*! \brief Advances the wheel towards tick \a target.
+**
+** Moves to the next occupied slot of the lowest level (or the end of its current turn, cascading the higher levels),
+** but no further than \a target.
+*/
+void TimerWheel::advance( Tick target )
+{
+  int slot = nextSlot( 0, (unsigned( _now ) & (Slots - 1)) + 1 );
+  Tick next = (slot != -1) ? ((_now & ~Tick( Slots - 1 )) + slot) : ((_now | (Slots - 1)) + 1);
+
+  if ( next > target ) {
+    _now = target;
+    return;
+  }
+
+  _now = next;
+  if ( (_now & (Slots - 1)) == 0 )
+    cascade( 1 );
+}
+
+
+//! Moves the timers from the current slot of \a level down into the lower levels.
+void TimerWheel::cascade( unsigned level )
+{
+  unsigned slot = Overflow;
+  if ( level < Levels ) {
+    unsigned shift = level * SlotBits;
+    unsigned cur = unsigned( _now >> shift ) & (Slots - 1);
+
+    // Higher levels turn over first, so their timers can cascade into this level.
+    if ( cur == 0 )
+      cascade( level + 1 );
+
+    slot = (level * Slots) + cur;
+  }
+
+  Timer *timer = _slots[slot];
+  while ( timer ) {
+    Timer *next = timer->_wheelNext;
+    unlink( timer );
+    schedule( timer );
+    timer = next;
+  }
+}
+
+
+//! Adds \a timer to the head of \a slot.
+void TimerWheel::link( Timer *timer, unsigned slot )
+{
+  timer->_wheelSlot = slot;
+  timer->_wheelPrev = 0;
+  timer->_wheelNext = _slots[slot];
+  if ( _slots[slot] )
+    _slots[slot]->_wheelPrev = timer;
+  _slots[slot] = timer;
+
+  if ( slot < Overflow )
+    _occupied[slot / Slots][(slot % Slots) / 64] |= uint64_t( 1 ) << (slot % 64);
+}
+
+
+//! Removes \a timer from its slot.
+void TimerWheel::unlink( Timer *timer )
+{
+  unsigned slot = timer->_wheelSlot;
+
+  if ( timer->_wheelPrev )
+    timer->_wheelPrev->_wheelNext = timer->_wheelNext;
+  else
+    _slots[slot] = timer->_wheelNext;
+
+  if ( timer->_wheelNext )
+    timer->_wheelNext->_wheelPrev = timer->_wheelPrev;
+
+  timer->_wheelSlot = -1;
+  timer->_wheelPrev = timer->_wheelNext = 0;
+
+  if ( (slot < Overflow) && !_slots[slot] )
+    _occupied[slot / Slots][(slot % Slots) / 64] &= ~(uint64_t( 1 ) << (slot % 64));
+}
+
+
+//! Orders timers by (coalesced) alarm time
+struct TimerWheel::FiresBefore {
+  bool operator ()( Timer const *a, Timer const *b ) const {  return a->_fireAt < b->_fireAt;  }
+};
+
+/*! \brief Moves the timers in \a slot which are due at or before \a now (or all of them, if \a now is negative) to the
+** #Due list, earliest first.
+*/
+void TimerWheel::collectDue( unsigned slot, Time now )
+{
+  _collected.clear();
+  for ( Timer *timer = _slots[slot], *next; timer; timer = next ) {
+    next = timer->_wheelNext;
+    if ( (now < 0.0) || (timer->_fireAt <= now) ) {
+      unlink( timer );
+      _collected.push_back( timer );
+    }
+  }
+
+  if ( _collected.empty() )
+    return;
+
+  stable_sort( _collected.begin(), _collected.end(), FiresBefore() );
+
+  // link() adds to the head of the list
+  for ( unsigned i = _collected.size(); i--; )
+    link( _collected[i], Due );
+}
+
+
+//! Returns the timer with the earliest (coalesced) alarm in \a slot (or \c 0, if the slot is empty).
+Timer *TimerWheel::earliest( unsigned slot ) const
+{
+  Timer *res = _slots[slot];
+  if ( !res )
+    return 0;
+
+  for ( Timer *t = res->_wheelNext; t; t = t->_wheelNext ) {
+    if ( t->_fireAt < res->_fireAt )
+      res = t;
+  }
+
+  return res;
+}
+
+
+//! Returns the first occupied slot of \a level at or after \a from (or \c -1, if there are none).
+int TimerWheel::nextSlot( unsigned level, unsigned from ) const
+{
+  for ( unsigned word = from / 64; word < (Slots / 64); ++word ) {
+    uint64_t bits = _occupied[level][word];
+    if ( word == (from / 64) )
+      bits &= ~uint64_t( 0 ) << (from % 64);
+
+    if ( bits )
+      return (word * 64) + __builtin_ctzll( bits );
+  }
+
+  return -1;
+}
@@ -0,0 +1,135 @@
+/*!
+** \file TimerWheel.h
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#ifndef FINAGLE_TIMERWHEEL_H
+#define FINAGLE_TIMERWHEEL_H
+
+#include <stdint.h>
+#include <cstring>
+#include <Finagle/Array.h>
+#include <Finagle/DateTime.h>
+#include <Finagle/LoopStats.h>
+#include <Finagle/ObjectPtr.h>
+
+namespace Finagle {
+
+class Timer;
+
+//! Hierarchical timing wheel, used by the application loop to schedule Timers.
+class TimerWheel {
+public:
+  static const double TickTime;     //!< Resolution of a wheel slot, in seconds
+  static const unsigned Levels = 4;
+  static const unsigned SlotBits = 8;
+  static const unsigned Slots = 1 << SlotBits;
+
+  //! Timer coalescing counters
+  struct Stats {
+    unsigned wakeups;   //!< Calls to trigger() which fired at least one timer
+    unsigned fired;     //!< Timers fired by trigger()
+    unsigned deferred;  //!< Timers scheduled after their alarm, to coalesce them (see Timer::setSlack())
+  };
+
+public:
+  TimerWheel( Time now = Time::now() );
+ ~TimerWheel( void );
+
+  bool empty( void ) const;
+  unsigned size( void ) const;
+  void reset( Time now );
+
+  void insert( Timer *timer );
+  void remove( Timer *timer );
+  bool contains( Timer const *timer ) const;
+
+  Time nextAlarm( void ) const;
+  ObjectPtr<Timer> popExpired( Time now );
+  bool trigger( Time now, bool const volatile &stop, LoopStats *stats = 0 );
+
+  static Time coalesce( Time alarm, Time slack );
+
+  Stats const &stats( void ) const;
+  void resetStats( void );
+
+protected:
+  typedef uint64_t Tick;
+
+  static Tick toTick( Time t );
+
+  void link( Timer *timer, unsigned slot );
+  void unlink( Timer *timer );
+  void schedule( Timer *timer );
+  void advance( Tick target );
+  void cascade( unsigned level );
+
+  void collectDue( unsigned slot, Time now );
+  Timer *earliest( unsigned slot ) const;
+  int nextSlot( unsigned level, unsigned from ) const;
+
+  struct FiresBefore;
+
+protected:
+  static const unsigned Overflow = Levels * Slots;  //!< Slot for timers beyond the last level
+  static const unsigned Due = Overflow + 1;         //!< Timers collected from the current slot, in alarm order
+
+  Tick _now;
+  unsigned _size;
+  Timer *_slots[Due + 1];
+  Array<Timer *> _collected;
+  uint64_t _occupied[Levels][Slots / 64];
+  Stats _stats;
+};
+
+// INLINE IMPLEMENTATION **********************************************************************************************************
+
+//! Returns \c true iff no timers are scheduled.
+inline bool TimerWheel::empty( void ) const
+{
+  return _size == 0;
+}
+
+//! Returns the number of scheduled timers.
+inline unsigned TimerWheel::size( void ) const
+{
+  return _size;
+}
+
+//! Returns the wheel's coalescing counters.
+inline TimerWheel::Stats const &TimerWheel::stats( void ) const
+{
+  return _stats;
+}
+
+//! Clears the wheel's coalescing counters.
+inline void TimerWheel::resetStats( void )
+{
+  memset( &_stats, 0, sizeof(_stats) );
+}
+
+//! Converts time \a t to a wheel tick (allowing for rounding, so that the start of a slot maps back to that slot).
+inline TimerWheel::Tick TimerWheel::toTick( Time t )
+{
+  return (t > 0.0) ? Tick( (t / TickTime) + 0.001 ) : 0;
+}
+
+}
+
+#endif
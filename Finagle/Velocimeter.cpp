@@ -32,9 +32,18 @@ using namespace Finagle;
 
 Velocimeter &Velocimeter::operator +=( double incr )
 {
-  Time now = Time::now();
+  Time now = _clock->now();
   double dt = now - _lastIncr;
+
+  // No time has passed (e.g. on a VirtualClock), so count this with the next increment.
+  if ( dt <= 0.0 ) {
+    _pending += incr;
+    return *this;
+  }
+
   _lastIncr = now;
+  incr += _pending;
+  _pending = 0.0;
 
   double e = exp( -dt * _smooth );
   _rate = (e * _rate) + ((1 - e) * (incr / dt));
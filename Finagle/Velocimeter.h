@@ -22,13 +22,14 @@
 #ifndef FINAGLE_VELOCIMETER_H
 #define FINAGLE_VELOCIMETER_H
 
+#include <Finagle/Clock.h>
 #include <Finagle/DateTime.h>
 
 namespace Finagle {
 
 class Velocimeter {
 public:
-  Velocimeter( double smooth = 1.0 );
+  Velocimeter( double smooth = 1.0, Clock const &clock = Clock::system() );
 
   double rate( void ) const;
   Velocimeter &operator +=( double incr );
@@ -38,12 +39,15 @@ public:
 protected:
   double _rate, _smooth;
   Time _lastIncr;
+  double _pending;
+  Clock const *_clock;
 };
 
 // INLINE IMPLEMENTATION ******************************************************
 
-inline Velocimeter::Velocimeter( double smooth )
-: _rate( 0.0 ), _smooth( 1.0 / smooth ), _lastIncr( Time::now() )
+//! Creates a rate meter which smooths over (approximately) \a smooth seconds, as measured by \a clock.
+inline Velocimeter::Velocimeter( double smooth, Clock const &clock )
+: _rate( 0.0 ), _smooth( 1.0 / smooth ), _lastIncr( clock.now() ), _pending( 0.0 ), _clock( &clock )
 {}
 
 inline double Velocimeter::rate( void ) const
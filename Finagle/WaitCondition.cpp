@@ -41,7 +41,13 @@ bool WaitCondition::wait( Time timeout )
   int res = 0;
   {
     Lock _( *this );
+#ifdef FINAGLE_PROFILE_LOCKS
+    Time suspended = suspend();
+#endif
     res = pthread_cond_timedwait( &_cond, &_mutex, &end );
+#ifdef FINAGLE_PROFILE_LOCKS
+    resume( suspended );
+#endif
   }
   if ( res == 0 )
     return true;
@@ -51,3 +57,51 @@ bool WaitCondition::wait( Time timeout )
 
   return false;
 }
+
+
+/*! \class Finagle::Condition
+** \brief A condition variable, waited on while holding an associated Mutex.
+**
+** Unlike WaitCondition (which is its own mutex), a Condition shares the mutex which guards the state it describes, so
+** a waiter checks that state and waits under a single lock, and a signaller changes it and signals under the same
+** lock, with no window in which a wakeup can be lost:
+** \code
+** Lock _( guard );
+** while ( items.empty() )
+**   notEmpty.wait( guard );
+** \endcode
+**
+** The mutex must be locked exactly once by the waiting thread, as a (recursive) Mutex locked more than once isn't
+** released while waiting.  The condition counts its waiters (under the mutex), so signalling one without waiters
+** costs nothing.
+**
+** When profiling locks (see LockProfile), time spent waiting is counted as a condition wait of the (named) mutex,
+** rather than as time it was held.
+*/
+
+//! Releases \a mutex (which must be locked exactly once by the caller) until signalled, or until \a deadline passes,
+//! then relocks it.  Returns \c false if the deadline passed.
+bool Condition::wait( Mutex &mutex, Time deadline )
+{
+  timespec end;
+  end.tv_sec = time_t( trunc(deadline) );
+  end.tv_nsec = long( (deadline - end.tv_sec) * 1000000000 );
+
+#ifdef FINAGLE_PROFILE_LOCKS
+  Time suspended = mutex.suspend();
+#endif
+  _waiters++;
+  int res = pthread_cond_timedwait( &_cond, &mutex._mutex, &end );
+  _waiters--;
+#ifdef FINAGLE_PROFILE_LOCKS
+  mutex.resume( suspended );
+#endif
+
+  if ( res == 0 )
+    return true;
+
+  if ( res != ETIMEDOUT )
+    throw PThreadEx( "pthread_cond_timedwait( &_cond, &mutex._mutex, &end )", res );
+
+  return false;
+}
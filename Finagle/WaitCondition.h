@@ -30,6 +30,7 @@ namespace Finagle {
 class WaitCondition : public Mutex {
 public:
   WaitCondition( void );
+  WaitCondition( char const *name );
  ~WaitCondition( void );
 
   void wait( void );
@@ -42,6 +43,25 @@ protected:
   pthread_cond_t _cond;
 };
 
+//! A condition variable, waited on while holding an associated Mutex.
+class Condition {
+public:
+  Condition( void );
+ ~Condition( void );
+
+  void wait( Mutex &mutex );
+  bool wait( Mutex &mutex, Time deadline );
+
+  unsigned waiters( void ) const;
+  void signalOne( void );
+  void signal( unsigned count );
+  void signalAll( void );
+
+protected:
+  pthread_cond_t _cond;
+  unsigned _waiters;
+};
+
 // INLINE IMPLEMENTATION **********************************************************************************************************
 
 inline WaitCondition::WaitCondition( void )
@@ -49,6 +69,13 @@ inline WaitCondition::WaitCondition( void )
   PTHREAD_ASSERT( pthread_cond_init( &_cond, 0 ) );
 }
 
+//! Creates the condition, named \a name (a string literal) in the lock profile (see LockProfile).
+inline WaitCondition::WaitCondition( char const *name )
+: Mutex( name )
+{
+  PTHREAD_ASSERT( pthread_cond_init( &_cond, 0 ) );
+}
+
 inline WaitCondition::~WaitCondition( void )
 {
   PTHREAD_ASSERT( pthread_cond_destroy( &_cond ) );
@@ -58,7 +85,13 @@ inline WaitCondition::~WaitCondition( void )
 inline void WaitCondition::wait( void )
 {
   Lock _( *this );
+#ifdef FINAGLE_PROFILE_LOCKS
+  Time suspended = suspend();
+#endif
   PTHREAD_ASSERT( pthread_cond_wait( &_cond, &_mutex ) );
+#ifdef FINAGLE_PROFILE_LOCKS
+  resume( suspended );
+#endif
 }
 
 //! Wakes one of the threads waiting on this condition.  If no threads are currently waiting, does nothing.
@@ -73,6 +106,64 @@ inline void WaitCondition::signalAll( void )
   PTHREAD_ASSERT( pthread_cond_broadcast( &_cond ) );
 }
 
+
+
+inline Condition::Condition( void )
+: _waiters( 0 )
+{
+  PTHREAD_ASSERT( pthread_cond_init( &_cond, 0 ) );
+}
+
+inline Condition::~Condition( void )
+{
+  PTHREAD_ASSERT( pthread_cond_destroy( &_cond ) );
+}
+
+//! Releases \a mutex (which must be locked exactly once by the caller) until signalled, then relocks it.
+inline void Condition::wait( Mutex &mutex )
+{
+#ifdef FINAGLE_PROFILE_LOCKS
+  Time suspended = mutex.suspend();
+#endif
+  _waiters++;
+  int res = pthread_cond_wait( &_cond, &mutex._mutex );
+  _waiters--;
+#ifdef FINAGLE_PROFILE_LOCKS
+  mutex.resume( suspended );
+#endif
+  PTHREAD_ASSERT( res );
+}
+
+//! Returns the number of threads waiting on the condition (the associated mutex must be locked).
+inline unsigned Condition::waiters( void ) const
+{
+  return _waiters;
+}
+
+//! Wakes one of the threads waiting on the condition, if there are any (the associated mutex must be locked).
+inline void Condition::signalOne( void )
+{
+  if ( _waiters )
+    PTHREAD_ASSERT( pthread_cond_signal( &_cond ) );
+}
+
+//! Wakes up to \a count of the threads waiting on the condition (the associated mutex must be locked).
+inline void Condition::signal( unsigned count )
+{
+  if ( count >= _waiters )
+    signalAll();
+  else
+    while ( count-- )
+      PTHREAD_ASSERT( pthread_cond_signal( &_cond ) );
+}
+
+//! Wakes all threads waiting on the condition, if there are any (the associated mutex must be locked).
+inline void Condition::signalAll( void )
+{
+  if ( _waiters )
+    PTHREAD_ASSERT( pthread_cond_broadcast( &_cond ) );
+}
+
 }
 
 #endif
@@ -22,6 +22,7 @@
 #ifndef FINAGLE_XML_COLLECTION_H
 #define FINAGLE_XML_COLLECTION_H
 
+#include <Finagle/RWMutex.h>
 #include <Finagle/XML/Object.h>
 
 namespace Finagle {  namespace XML {
@@ -39,8 +40,14 @@ public:
   bool configure( XML::Element const &config );
   XML::Element::Ptr configuration( void ) const;
 
+  RWMutex &guard( void ) const;
+
+protected:
+  bool configureLocked( XML::Element const &config );
+
 protected:
   String _tag;
+  mutable RWMutex _guard;  //!< Write-locked while (re)configuring; readers sharing the collection should ReadLock it
 };
 
 // INLINE/TEMPLATE IMPLEMENTATION *********************************************
@@ -50,8 +57,22 @@ inline Collection<Class, MapType>::Collection( String const &tag )
 : _tag( tag )
 {}
 
+//! Returns the mutex which guards the collection: readers which share it with a (re)configuring thread should hold a ReadLock.
+template <typename Class, typename MapType>
+inline RWMutex &Collection<Class, MapType>::guard( void ) const
+{
+  return _guard;
+}
+
 template <typename Class, typename MapType>
 bool Collection<Class, MapType>::configure( XML::Element const &config )
+{
+  WriteLock _( _guard );
+  return configureLocked( config );
+}
+
+template <typename Class, typename MapType>
+bool Collection<Class, MapType>::configureLocked( XML::Element const &config )
 {
   static const String ObjName( Class().objName() );
   static const String ObjIDAttrib( Class().objIDAttrib() );
@@ -73,7 +94,7 @@ String n( ObjName ), o( ObjIDAttrib );
 
   if ( elName == _tag ) {
     for ( XML::Element::ConstElementIterator el( config.first() ); el; ++el ) {
-      if ( !configure( *el ) )
+      if ( !configureLocked( *el ) )
         return false;
     }
     return true;
@@ -86,6 +107,7 @@ template <typename Class, typename MapType>
 XML::Element::Ptr Collection<Class, MapType>::configuration( void ) const
 {
   XML::Element::Ptr config( new XML::Element( _tag ) );
+  ReadLock _( _guard );
   for ( ConstIterator obj( MapType::begin() ); obj != MapType::end(); ++obj )
     *config << obj->configuration();
   return config;
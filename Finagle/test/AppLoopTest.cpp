@@ -0,0 +1,337 @@
+/*!
+** \file AppLoopTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include <typeinfo>
+#include <unistd.h>
+#include <boost/bind.hpp>
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/AppLoop.h>
+#include <Finagle/FileDescWatcher.h>
+#include <Finagle/ThreadFunc.h>
+#include <Finagle/Timer.h>
+#include <Finagle/Util.h>
+
+using namespace std;
+using namespace Finagle;
+
+class AppLoopTest : public CppUnit::TestFixture, public boost::signals::trackable {
+  CPPUNIT_TEST_SUITE( AppLoopTest );
+  CPPUNIT_TEST( testCurrent );
+  CPPUNIT_TEST( testProcessTime );
+  CPPUNIT_TEST( testLoopTimer );
+  CPPUNIT_TEST( testMoveTo );
+  CPPUNIT_TEST( testPost );
+  CPPUNIT_TEST( testPostLatency );
+  CPPUNIT_TEST( testInstrument );
+  CPPUNIT_TEST( testIdleSlots );
+  CPPUNIT_TEST( testVirtualClock );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp( void );
+  void tearDown( void );
+
+  void testCurrent( void );
+  void testProcessTime( void );
+  void testLoopTimer( void );
+  void testMoveTo( void );
+  void testPost( void );
+  void testPostLatency( void );
+  void testInstrument( void );
+  void testIdleSlots( void );
+  void testVirtualClock( void );
+
+protected:
+  void onAlarm( void );
+  void onReadable( void );
+  void onPosted( unsigned id );
+  void postMany( void );
+  void stall( void );
+  void onIdle( void );
+  void idleStall( void );
+  bool waitFor( unsigned &count );
+
+protected:
+  static const unsigned NumPosts = 10000;
+
+  int _pipe[2];
+  unsigned _alarms, _reads, _idles;
+  Thread::ID _thread;
+  Array<unsigned> _posted;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( AppLoopTest );
+
+
+void AppLoopTest::setUp( void )
+{
+  CPPUNIT_ASSERT_EQUAL( 0, pipe( _pipe ) );
+  _alarms = _reads = _idles = 0;
+  _thread = 0;
+  _posted.clear();
+}
+
+void AppLoopTest::tearDown( void )
+{
+  close( _pipe[0] );
+  close( _pipe[1] );
+}
+
+
+void AppLoopTest::onAlarm( void )
+{
+  _thread = Thread::self_id();
+  _alarms++;
+}
+
+void AppLoopTest::onReadable( void )
+{
+  char c;
+  CPPUNIT_ASSERT_EQUAL( 1, (int) read( _pipe[0], &c, 1 ) );
+  _thread = Thread::self_id();
+  _reads++;
+}
+
+void AppLoopTest::onPosted( unsigned id )
+{
+  _thread = Thread::self_id();
+  _posted.push_back( id );
+}
+
+void AppLoopTest::postMany( void )
+{
+  for ( unsigned i = 0; i < NumPosts; ++i )
+    AppLoop::post( boost::bind( &AppLoopTest::onPosted, this, i ) );
+}
+
+void AppLoopTest::stall( void )
+{
+  onReadable();
+  sleep( 0.02 );
+}
+
+void AppLoopTest::onIdle( void )
+{
+  _idles++;
+}
+
+void AppLoopTest::idleStall( void )
+{
+  sleep( 0.015 );
+}
+
+//! Waits (up to a second) for \a count to become non-zero.
+bool AppLoopTest::waitFor( unsigned &count )
+{
+  for ( unsigned i = 0; (i < 100) && !count; ++i )
+    AppLoop::wait( 0.01 );
+
+  return count != 0;
+}
+
+
+void AppLoopTest::testCurrent( void )
+{
+  CPPUNIT_ASSERT( &AppLoop::Loop::current() == &AppLoop::Loop::main() );
+  CPPUNIT_ASSERT( &AppLoop::Watchers() == &AppLoop::Loop::main().watchers() );
+
+  AppLoop::Loop loop;
+  Timer::Ptr timer = Timer::SingleShot( 1.0, loop );
+  CPPUNIT_ASSERT( &timer->loop() == &loop );
+  CPPUNIT_ASSERT_EQUAL( 1U, loop.timers().size() );
+
+  timer->stop();
+  CPPUNIT_ASSERT( loop.timers().empty() );
+}
+
+
+void AppLoopTest::testProcessTime( void )
+{
+  Time start = Time::now();
+  AppLoop::process( 0.02 );
+  Time elapsed = Time::now() - start;
+
+  CPPUNIT_ASSERT( elapsed >= 0.019 );
+  CPPUNIT_ASSERT( elapsed < 0.5 );
+}
+
+
+//! A timer bound to a worker's loop is triggered by the worker's thread.
+void AppLoopTest::testLoopTimer( void )
+{
+  AppLoop::LoopThread worker;
+  Timer::Ptr timer = Timer::SingleShot( 0.01, worker.loop() );
+  timer->connect( boost::bind( &AppLoopTest::onAlarm, this ) );
+
+  // The worker's loop never belongs to the thread which created it
+  CPPUNIT_ASSERT( !worker.loop().isCurrent() );
+  worker.start();
+  CPPUNIT_ASSERT( waitFor( _alarms ) );
+  CPPUNIT_ASSERT( pthread_equal( _thread, worker.id() ) );
+  CPPUNIT_ASSERT( !worker.loop().isCurrent() );
+}
+
+
+//! A watcher moved to a worker's loop is notified by the worker's thread.
+void AppLoopTest::testMoveTo( void )
+{
+  AppLoop::LoopThread worker;
+  worker.start();
+
+  FileDescWatcher::Ptr watcher = new FileDescWatcher( _pipe[0] );
+  watcher->readable.connect( boost::bind( &AppLoopTest::onReadable, this ) );
+  CPPUNIT_ASSERT( &watcher->loop() == &AppLoop::Loop::main() );
+
+  watcher->moveTo( worker.loop() );
+  CPPUNIT_ASSERT( !AppLoop::Watchers().contains( watcher ) );
+
+  CPPUNIT_ASSERT_EQUAL( 1, (int) write( _pipe[1], "x", 1 ) );
+  CPPUNIT_ASSERT( waitFor( _reads ) );
+  CPPUNIT_ASSERT( pthread_equal( _thread, worker.id() ) );
+  CPPUNIT_ASSERT( &watcher->loop() == &worker.loop() );
+  CPPUNIT_ASSERT_EQUAL( 1U, worker.loop().load() );
+
+  // Stop the worker before the watcher is destroyed (and unregistered) by this thread.
+  worker.loop().exit();
+  worker.join();
+}
+
+
+//! Tasks posted by another thread run on the loop's thread, in order.
+void AppLoopTest::testPost( void )
+{
+  ClassFuncThread<AppLoopTest> poster( this, &AppLoopTest::postMany );
+  poster.start();
+  poster.join();
+
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT_EQUAL( (unsigned) NumPosts, (unsigned) _posted.size() );
+  for ( unsigned i = 0; i < NumPosts; ++i )
+    CPPUNIT_ASSERT_EQUAL( i, _posted[i] );
+  CPPUNIT_ASSERT( pthread_equal( _thread, Thread::self_id() ) );
+}
+
+
+//! A task posted to a waiting loop runs well before the loop's timeout.
+void AppLoopTest::testPostLatency( void )
+{
+  AppLoop::LoopThread worker;
+  worker.start();
+  AppLoop::wait( 0.01 );  // Let the worker start waiting
+
+  Time start = Time::now();
+  worker.loop().post( boost::bind( &AppLoopTest::onPosted, this, 1 ) );
+  while ( _posted.empty() && ((Time::now() - start) < 1.0) )
+    ;
+  Time latency = Time::now() - start;
+
+  CPPUNIT_ASSERT_EQUAL( 1U, (unsigned) _posted.size() );
+  CPPUNIT_ASSERT( pthread_equal( _thread, worker.id() ) );
+  CPPUNIT_ASSERT( latency < (AppLoop::ProcessTime / 2.0) );
+}
+
+
+void AppLoopTest::testInstrument( void )
+{
+  AppLoop::Loop &loop = AppLoop::Loop::main();
+  FileDescWatcher::Ptr watcher = new FileDescWatcher( _pipe[0] );
+  watcher->readable.connect( boost::bind( &AppLoopTest::stall, this ) );
+  Timer::Ptr timer = Timer::SingleShot( 0.005 );
+  timer->connect( boost::bind( &AppLoopTest::onAlarm, this ) );
+
+  // Nothing is collected until instrumented.
+  loop.resetStats();
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT_EQUAL( 1U, _alarms );
+  CPPUNIT_ASSERT_EQUAL( 0U, loop.stats().iterations );
+
+  loop.instrument( true, 0.01 );
+  timer->start();
+  CPPUNIT_ASSERT_EQUAL( 1, (int) write( _pipe[1], "x", 1 ) );
+  AppLoop::process( 0.03 );
+  loop.instrument( false );
+
+  LoopStats const &stats = loop.stats();
+  CPPUNIT_ASSERT_EQUAL( 2U, _alarms );
+  CPPUNIT_ASSERT_EQUAL( 1U, _reads );
+  CPPUNIT_ASSERT( stats.iterations > 0 );
+  CPPUNIT_ASSERT_EQUAL( 1U, stats.timers.count );
+  CPPUNIT_ASSERT( stats.lag.count == 1 );
+  CPPUNIT_ASSERT( stats.lag.max >= 0.0 );
+  CPPUNIT_ASSERT_EQUAL( 1U, stats.callbacks.count );
+  CPPUNIT_ASSERT( stats.callbacks.max >= 0.02 );
+  CPPUNIT_ASSERT_EQUAL( (size_t) 1, stats.watchers.size() );
+  CPPUNIT_ASSERT_EQUAL( 1U, stats.watchers[typeid(FileDescWatcher).name()].count );
+  CPPUNIT_ASSERT( stats.wait.count > 0 );
+  CPPUNIT_ASSERT_EQUAL( 1U, stats.slow );
+
+  loop.resetStats();
+  CPPUNIT_ASSERT_EQUAL( 0U, loop.stats().callbacks.count );
+  CPPUNIT_ASSERT( loop.stats().watchers.empty() );
+}
+
+
+//! Each idle handler is timed separately, and a slow one is reported (once).
+void AppLoopTest::testIdleSlots( void )
+{
+  AppLoop::Loop loop;
+  loop.idle.connect( boost::bind( &AppLoopTest::onIdle, this ) );
+  loop.idle.connect( boost::bind( &AppLoopTest::idleStall, this ) );
+
+  loop.instrument( true, 0.01 );
+  loop.process( 0.05 );
+
+  LoopStats const &stats = loop.stats();
+  CPPUNIT_ASSERT( _idles > 0 );
+  CPPUNIT_ASSERT_EQUAL( (size_t) 2, stats.idleSlots.size() );
+  CPPUNIT_ASSERT_EQUAL( _idles, stats.idleSlots[0].count );
+  CPPUNIT_ASSERT_EQUAL( _idles, stats.idleSlots[1].count );
+  CPPUNIT_ASSERT( stats.idleSlots[1].max >= 0.015 );
+  CPPUNIT_ASSERT( stats.slow >= _idles );  // every stall (and any preempted handler)
+}
+
+
+//! Runs a simulated minute of timers, at CPU speed.
+void AppLoopTest::testVirtualClock( void )
+{
+  VirtualClock clock;
+  AppLoop::Loop loop;
+  loop.setClock( clock );
+
+  Timer::Ptr timer = new Timer( 1.0, true, loop );
+  timer->connect( boost::bind( &AppLoopTest::onAlarm, this ) );
+  timer->start();
+
+  Timer::Ptr slow = new Timer( 25.0, true, loop );
+  slow->connect( boost::bind( &AppLoopTest::onAlarm, this ) );
+  slow->start();
+
+  Time start = Time::now();
+  loop.process( 60.0 );
+  Time elapsed = Time::now() - start;
+
+  CPPUNIT_ASSERT_EQUAL( 62U, _alarms );
+  CPPUNIT_ASSERT_DOUBLES_EQUAL( VirtualClock::Epoch + 60.0, clock.now(), 0.001 );
+  CPPUNIT_ASSERT( elapsed < 1.0 );
+
+  timer->stop();
+  slow->stop();
+}
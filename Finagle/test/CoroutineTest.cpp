@@ -0,0 +1,183 @@
+/*!
+** \file CoroutineTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Coroutine.h>
+
+using namespace std;
+using namespace Finagle;
+
+class CoroutineTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE( CoroutineTest );
+  CPPUNIT_TEST( testSleep );
+  CPPUNIT_TEST( testSocket );
+  CPPUNIT_TEST( testSignal );
+  CPPUNIT_TEST( testPool );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testSleep( void );
+  void testSocket( void );
+  void testSignal( void );
+  void testPool( void );
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( CoroutineTest );
+
+
+//! Sleeps a number of times, counting each wake-up.
+class Sleeper : public Coroutine {
+public:
+  Sleeper( unsigned times ) : _times( times ), _woken( 0 ) {}
+
+  unsigned woken( void ) const {  return _woken;  }
+
+protected:
+  void run( void ) {
+    CO_BEGIN;
+    for ( ; _woken < _times; ++_woken )
+      CO_AWAIT( sleepFor( 0.01 ) );
+    CO_END;
+  }
+
+  unsigned _times, _woken;
+};
+
+
+//! Echoes what it receives on a socket, until it's closed.
+class Echo : public Coroutine {
+public:
+  Echo( int fd ) : _fd( fd ), _echoed( 0 ) {}
+
+  unsigned echoed( void ) const {  return _echoed;  }
+
+protected:
+  void run( void ) {
+    CO_BEGIN;
+    while ( true ) {
+      CO_AWAIT( recv( _fd, _buf, sizeof(_buf) ) );
+      if ( result() <= 0 )
+        break;
+
+      _len = result();
+      CO_AWAIT( send( _fd, _buf, _len ) );
+      _echoed += _len;
+    }
+    CO_END;
+  }
+
+  int _fd;
+  char _buf[64];
+  unsigned _len, _echoed;
+};
+
+
+//! Waits for a signal.
+class Waiter : public Coroutine {
+public:
+  Waiter( boost::signal< void() > &sig ) : _sig( sig ) {}
+
+protected:
+  void run( void ) {
+    CO_BEGIN;
+    CO_AWAIT( wait( _sig ) );
+    CO_END;
+  }
+
+  boost::signal< void() > &_sig;
+};
+
+
+void CoroutineTest::testSleep( void )
+{
+  Coroutine::Ptr co = new Sleeper( 3 );
+  CPPUNIT_ASSERT( !co->running() );
+
+  Time start = Time::now();
+  co->start();
+  CPPUNIT_ASSERT( co->running() );
+
+  while ( !co->done() && ((Time::now() - start) < 1.0) )
+    AppLoop::process( 0.01 );
+
+  CPPUNIT_ASSERT( co->done() );
+  CPPUNIT_ASSERT_EQUAL( 3U, ((Sleeper &) *co).woken() );
+  CPPUNIT_ASSERT( (Time::now() - start) >= 0.03 );
+}
+
+
+void CoroutineTest::testSocket( void )
+{
+  int sock[2];
+  CPPUNIT_ASSERT_EQUAL( 0, socketpair( AF_UNIX, SOCK_STREAM, 0, sock ) );
+
+  Coroutine::Ptr co = new Echo( sock[1] );
+  co->start();
+
+  char buf[8];
+  for ( unsigned i = 0; i < 3; ++i ) {
+    CPPUNIT_ASSERT_EQUAL( 4, (int) ::send( sock[0], "ping", 4, 0 ) );
+
+    Time end = Time::now() + 1.0;
+    while ( (((Echo &) *co).echoed() < (i + 1) * 4) && (Time::now() < end) )
+      AppLoop::process( 0.01 );
+
+    CPPUNIT_ASSERT_EQUAL( 4, (int) ::recv( sock[0], buf, sizeof(buf), MSG_DONTWAIT ) );
+    CPPUNIT_ASSERT( memcmp( buf, "ping", 4 ) == 0 );
+  }
+
+  // Closing the other end completes the coroutine
+  close( sock[0] );
+  Time end = Time::now() + 1.0;
+  while ( !co->done() && (Time::now() < end) )
+    AppLoop::process( 0.01 );
+
+  CPPUNIT_ASSERT( co->done() );
+  CPPUNIT_ASSERT_EQUAL( 0, co->result() );
+  close( sock[1] );
+}
+
+
+void CoroutineTest::testSignal( void )
+{
+  boost::signal< void() > sig;
+  Coroutine::Ptr co = new Waiter( sig );
+  co->start();
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT( co->running() );
+
+  sig();
+  CPPUNIT_ASSERT( co->done() );
+}
+
+
+void CoroutineTest::testPool( void )
+{
+  Coroutine *co = new Sleeper( 1 );
+  delete co;
+
+  // A coroutine of the same size re-uses the freed block
+  CPPUNIT_ASSERT_EQUAL( co, (Coroutine *) new Sleeper( 2 ) );
+  delete co;
+}
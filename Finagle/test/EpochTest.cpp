@@ -0,0 +1,246 @@
+/*!
+** \file EpochTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Array.h>
+#include <Finagle/Epoch.h>
+#include <Finagle/Mutex.h>
+#include <Finagle/ThreadFunc.h>
+#include <Finagle/Util.h>
+
+using namespace std;
+using namespace Finagle;
+
+class EpochTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE( EpochTest );
+  CPPUNIT_TEST( testGuard );
+  CPPUNIT_TEST( testBudget );
+  CPPUNIT_TEST( testExit );
+  CPPUNIT_TEST( testReaders );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp( void );
+
+  void testGuard( void );
+  void testBudget( void );
+  void testExit( void );
+  void testReaders( void );
+
+protected:
+  //! An element of a list read without locks, which is marked (but not freed) when reclaimed
+  struct Node {
+    Node( unsigned v, Node *n ) : value( v ), alive( true ), next( n ) {}
+    unsigned value;
+    bool volatile alive;
+    Node * volatile next;
+  };
+
+  static void bury( void *node );
+
+  void pin( void );
+  void retireSome( void );
+  void read( void );
+
+protected:
+  bool volatile _pinned, _release, _done;
+  Node * volatile _list;
+  unsigned _misreads;
+  Mutex _guard;
+  static Array<Node *> _graveyard;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( EpochTest );
+
+Array<EpochTest::Node *> EpochTest::_graveyard;
+
+//! Counts live instances
+struct Tracked {
+  Tracked( void ) {  Live++;  }
+ ~Tracked( void ) {  Live--;  }
+  static unsigned Live;
+};
+
+unsigned Tracked::Live = 0;
+
+
+void EpochTest::setUp( void )
+{
+  // Start with nothing pending
+  while ( Epoch::pending() )
+    Epoch::collect();
+
+  _pinned = _release = _done = false;
+  Tracked::Live = 0;
+}
+
+
+//! Holds a guard until released.
+void EpochTest::pin( void )
+{
+  Epoch::Guard _;
+  _pinned = true;
+  while ( !_release )
+    sleep( 0.001 );
+}
+
+void EpochTest::testGuard( void )
+{
+  ClassFuncThread<EpochTest> reader( this, &EpochTest::pin );
+  reader.start();
+  while ( !_pinned )
+    sleep( 0.001 );
+
+  Epoch::retire( new Tracked );
+  Epoch::collect();
+  Epoch::collect();
+  CPPUNIT_ASSERT_EQUAL( 1U, Tracked::Live );  // the reader might still see it
+  CPPUNIT_ASSERT_EQUAL( 1U, Epoch::pending() );
+
+  _release = true;
+  reader.join();
+  CPPUNIT_ASSERT_EQUAL( 1U, Epoch::collect() );
+  CPPUNIT_ASSERT_EQUAL( 0U, Tracked::Live );
+
+  // Nested guards on this thread
+  {
+    Epoch::Guard outer;
+    {
+      Epoch::Guard inner;
+      CPPUNIT_ASSERT( Epoch::pinned() );
+    }
+    CPPUNIT_ASSERT( Epoch::pinned() );
+  }
+  CPPUNIT_ASSERT( !Epoch::pinned() );
+}
+
+
+void EpochTest::testBudget( void )
+{
+  for ( unsigned i = 0; i < 100; ++i )
+    Epoch::retire( new Tracked );
+
+  CPPUNIT_ASSERT_EQUAL( 10U, Epoch::collect( 10 ) );
+  CPPUNIT_ASSERT_EQUAL( 90U, Tracked::Live );
+  CPPUNIT_ASSERT_EQUAL( 90U, Epoch::pending() );
+
+  CPPUNIT_ASSERT_EQUAL( 90U, Epoch::collect( 1000 ) );
+  CPPUNIT_ASSERT_EQUAL( 0U, Tracked::Live );
+
+  // Retiring collects by itself, so garbage doesn't pile up
+  for ( unsigned i = 0; i < 10 * Epoch::CollectInterval; ++i )
+    Epoch::retire( new Tracked );
+  CPPUNIT_ASSERT( Tracked::Live <= Epoch::CollectInterval );
+}
+
+
+void EpochTest::retireSome( void )
+{
+  for ( unsigned i = 0; i < 10; ++i )
+    Epoch::retire( new Tracked );
+}
+
+//! Checks that the objects retired by an exited thread are collected by the others.
+void EpochTest::testExit( void )
+{
+  ClassFuncThread<EpochTest> t( this, &EpochTest::retireSome );
+  t.start();
+  t.join();
+  CPPUNIT_ASSERT_EQUAL( 10U, Tracked::Live );
+  CPPUNIT_ASSERT_EQUAL( 10U, Epoch::pending() );
+
+  Epoch::collect();
+  CPPUNIT_ASSERT_EQUAL( 0U, Tracked::Live );
+}
+
+
+void EpochTest::bury( void *node )
+{
+  ((Node *) node)->alive = false;
+  _graveyard.push_back( (Node *) node );
+}
+
+//! Walks the list repeatedly, counting reclaimed nodes which are reached.
+void EpochTest::read( void )
+{
+  unsigned misreads = 0;
+  while ( !_done ) {
+    Epoch::Guard _;
+    for ( Node *n = _list; n; n = n->next )
+      if ( !n->alive )
+        misreads++;
+  }
+
+  Lock _( _guard );
+  _misreads += misreads;
+}
+
+//! Replaces list nodes while readers walk it, retiring the old ones: no reader should reach a reclaimed node.
+void EpochTest::testReaders( void )
+{
+  static const unsigned Length = 16, Readers = 3, Replacements = 20000;
+
+  _list = 0;
+  for ( unsigned i = 0; i < Length; ++i )
+    _list = new Node( i, _list );
+  _misreads = 0;
+
+  Array<ClassFuncThread<EpochTest> *> readers;
+  for ( unsigned i = 0; i < Readers; ++i ) {
+    readers.push_back( new ClassFuncThread<EpochTest>( this, &EpochTest::read ) );
+    readers.back()->start();
+  }
+
+  for ( unsigned i = 0; i < Replacements; ++i ) {
+    // Replace the node after the (i % (Length - 1))th
+    Node *prev = _list;
+    for ( unsigned j = i % (Length - 1); j; --j )
+      prev = prev->next;
+
+    Node *old = prev->next;
+    prev->next = new Node( old->value, old->next );
+    __sync_synchronize();
+    Epoch::retire( old, &EpochTest::bury );
+  }
+
+  _done = true;
+  for ( unsigned i = 0; i < Readers; ++i ) {
+    readers[i]->join();
+    delete readers[i];
+  }
+
+  while ( Epoch::pending() )
+    Epoch::collect();
+
+  CPPUNIT_ASSERT_EQUAL( 0U, _misreads );
+  CPPUNIT_ASSERT_EQUAL( Replacements, _graveyard.size() );
+
+  for ( unsigned i = 0; i < _graveyard.size(); ++i )
+    delete _graveyard[i];
+  _graveyard.clear();
+  while ( _list ) {
+    Node *next = _list->next;
+    delete _list;
+    _list = next;
+  }
+}
@@ -0,0 +1,66 @@
+/*!
+** \file FutureBench.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Sat Oct 17 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <iostream>
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/DateTime.h>
+#include <Finagle/Future.h>
+
+using namespace std;
+using namespace Finagle;
+
+//! Times chained promises, whose shared state comes from FutureBase's pool.
+class FutureBench : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE( FutureBench );
+  CPPUNIT_TEST( testChain );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testChain( void );
+
+protected:
+  static unsigned twice( Future<unsigned> f );
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( FutureBench );
+
+
+unsigned FutureBench::twice( Future<unsigned> f )
+{
+  return f.get() * 2;
+}
+
+
+void FutureBench::testChain( void )
+{
+  static const unsigned Chains = 100000;
+
+  Time start = Time::now();
+  for ( unsigned i = 0; i < Chains; ++i ) {
+    Promise<unsigned> p;
+    Future<unsigned> f = p.future().then( &FutureBench::twice );
+    p.setValue( i );
+    CPPUNIT_ASSERT_EQUAL( i * 2, f.get() );
+  }
+  Time elapsed = Time::now() - start;
+  cout << endl << "Chained " << Chains << " promises in " << elapsed << " sec (" << (Chains / elapsed) << " per sec)" << endl;
+}
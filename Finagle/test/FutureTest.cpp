@@ -0,0 +1,229 @@
+/*!
+** \file FutureTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <stdexcept>
+#include <cppunit/extensions/HelperMacros.h>
+#include <boost/bind.hpp>
+#include <Finagle/AppLoop.h>
+#include <Finagle/BlockPool.h>
+#include <Finagle/Future.h>
+#include <Finagle/ThreadPool.h>
+#include <Finagle/Util.h>
+
+using namespace std;
+using namespace Finagle;
+
+class FutureTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE( FutureTest );
+  CPPUNIT_TEST( testPromise );
+  CPPUNIT_TEST( testThen );
+  CPPUNIT_TEST( testThenFailure );
+  CPPUNIT_TEST( testExecutors );
+  CPPUNIT_TEST( testWhenAll );
+  CPPUNIT_TEST( testWhenAny );
+  CPPUNIT_TEST( testPool );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testPromise( void );
+  void testThen( void );
+  void testThenFailure( void );
+  void testExecutors( void );
+  void testWhenAll( void );
+  void testWhenAny( void );
+  void testPool( void );
+
+protected:
+  static unsigned twice( Future<unsigned> f );
+  static String describe( Future<unsigned> f );
+  static Thread::ID where( Future<unsigned> f );
+  static unsigned slow( unsigned v, Time delay );
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( FutureTest );
+
+
+unsigned FutureTest::twice( Future<unsigned> f )
+{
+  return f.get() * 2;
+}
+
+String FutureTest::describe( Future<unsigned> f )
+{
+  return f.failed() ? String( "failed: " ) + f.error() : String( f.get() );
+}
+
+Thread::ID FutureTest::where( Future<unsigned> )
+{
+  return Thread::self_id();
+}
+
+unsigned FutureTest::slow( unsigned v, Time delay )
+{
+  sleep( delay );
+  return v;
+}
+
+
+void FutureTest::testPromise( void )
+{
+  Future<unsigned> invalid;
+  CPPUNIT_ASSERT( !invalid.valid() );
+  CPPUNIT_ASSERT( !invalid.ready() );
+
+  Promise<unsigned> p;
+  Future<unsigned> f = p.future();
+  CPPUNIT_ASSERT( f.valid() );
+  CPPUNIT_ASSERT( !f.ready() );
+  CPPUNIT_ASSERT( !f.wait( 0.01 ) );
+
+  p.setValue( 42 );
+  CPPUNIT_ASSERT( f.ready() );
+  CPPUNIT_ASSERT( !f.failed() );
+  CPPUNIT_ASSERT_EQUAL( 42U, f.get() );
+
+  Promise<void> v;
+  v.setError( "broken" );
+  CPPUNIT_ASSERT( v.future().failed() );
+  CPPUNIT_ASSERT_THROW( v.future().get(), Exception );
+}
+
+
+//! Checks continuations attached before and after completion, and chained.
+void FutureTest::testThen( void )
+{
+  Promise<unsigned> p;
+  Future<unsigned> doubled = p.future().then( &FutureTest::twice );
+  Future<unsigned> quadrupled = doubled.then( &FutureTest::twice );
+  CPPUNIT_ASSERT( !quadrupled.ready() );
+
+  p.setValue( 5 );
+  CPPUNIT_ASSERT( doubled.ready() );
+  CPPUNIT_ASSERT_EQUAL( 10U, doubled.get() );
+  CPPUNIT_ASSERT_EQUAL( 20U, quadrupled.get() );
+
+  // Already complete, so runs immediately
+  Future<String> described = p.future().then( &FutureTest::describe );
+  CPPUNIT_ASSERT( described.ready() );
+  CPPUNIT_ASSERT_EQUAL( String( "5" ), described.get() );
+}
+
+
+//! Checks that failures propagate through continuations which get() them, and can be handled by those which don't.
+void FutureTest::testThenFailure( void )
+{
+  Promise<unsigned> p;
+  Future<unsigned> doubled = p.future().then( &FutureTest::twice );
+  Future<String> described = p.future().then( &FutureTest::describe );
+
+  p.setError( "no value" );
+  CPPUNIT_ASSERT( doubled.failed() );
+  CPPUNIT_ASSERT_EQUAL( String( "no value" ), doubled.error() );
+  CPPUNIT_ASSERT_EQUAL( String( "failed: no value" ), described.get() );
+}
+
+
+//! Checks that continuations run on their executors' threads.
+void FutureTest::testExecutors( void )
+{
+  ThreadPool pool( 2 );
+  Promise<unsigned> p;
+
+  Future<Thread::ID> onPool = p.future().then( pool, &FutureTest::where );
+  Future<Thread::ID> onLoop = p.future().then( AppLoop::Loop::current(), &FutureTest::where );
+  p.setValue( 1 );
+
+  Thread::ID poolThread = onPool.get();
+  CPPUNIT_ASSERT( !pthread_equal( poolThread, Thread::self_id() ) );
+
+  CPPUNIT_ASSERT( !onLoop.ready() );  // until the loop runs its posted tasks
+  AppLoop::process();
+  CPPUNIT_ASSERT( onLoop.ready() );
+  CPPUNIT_ASSERT( pthread_equal( onLoop.get(), Thread::self_id() ) );
+
+  // A shut-down pool fails the continuation
+  pool.shutdown();
+  Future<Thread::ID> refused = p.future().then( pool, &FutureTest::where );
+  CPPUNIT_ASSERT( refused.failed() );
+}
+
+
+void FutureTest::testWhenAll( void )
+{
+  ThreadPool pool( 4 );
+
+  Array<Future<unsigned> > results;
+  for ( unsigned i = 0; i < 8; ++i )
+    results.push_back( pool.submit( boost::bind( &FutureTest::slow, i, 0.01 ) ) );
+
+  Future<void> all = whenAll( results.begin(), results.end() );
+  CPPUNIT_ASSERT( all.wait( 5.0 ) );
+  CPPUNIT_ASSERT( !all.failed() );
+  for ( unsigned i = 0; i < results.size(); ++i )
+    CPPUNIT_ASSERT( results[i].ready() );
+
+  Promise<unsigned> failing;
+  results.push_back( failing.future() );
+  all = whenAll( results.begin(), results.end() );
+  CPPUNIT_ASSERT( !all.ready() );
+  failing.setError( "failed" );
+  CPPUNIT_ASSERT( all.failed() );
+  CPPUNIT_ASSERT_EQUAL( String( "failed" ), all.error() );
+
+  Array<Future<unsigned> > none;
+  CPPUNIT_ASSERT( whenAll( none.begin(), none.end() ).ready() );
+}
+
+
+void FutureTest::testWhenAny( void )
+{
+  Array<Promise<unsigned> > promises;
+  Array<Future<unsigned> > futures;
+  for ( unsigned i = 0; i < 3; ++i ) {
+    promises.push_back( Promise<unsigned>() );
+    futures.push_back( promises[i].future() );
+  }
+
+  Future<unsigned> any = whenAny( futures.begin(), futures.end() );
+  CPPUNIT_ASSERT( !any.ready() );
+
+  promises[2].setValue( 7 );
+  CPPUNIT_ASSERT( any.ready() );
+  CPPUNIT_ASSERT_EQUAL( 2U, any.get() );
+
+  promises[0].setValue( 3 );
+  CPPUNIT_ASSERT_EQUAL( 2U, any.get() );
+
+  Array<Future<unsigned> > none;
+  CPPUNIT_ASSERT( whenAny( none.begin(), none.end() ).failed() );
+}
+
+
+//! Checks that shared state is recycled, rather than allocated anew for each promise.
+void FutureTest::testPool( void )
+{
+  void *first = BlockPool::allocate( 48 );
+  BlockPool::release( first, 48 );
+  void *second = BlockPool::allocate( 40 );
+  CPPUNIT_ASSERT( first == second );
+  BlockPool::release( second, 40 );
+}
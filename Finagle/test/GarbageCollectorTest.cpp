@@ -40,12 +40,20 @@ class GarbageCollectorTest : public CppUnit::TestFixture, public boost::signals:
   CPPUNIT_TEST( testDummy );
   CPPUNIT_TEST( testAdd );
   CPPUNIT_TEST( testCollect );
+  CPPUNIT_TEST( testReferenced );
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testDummy( void );
   void testAdd( void );
   void testCollect( void );
+  void testReferenced( void );
+
+protected:
+  void collected( Dummy::Ptr ) {  _collected++;  }
+
+protected:
+  unsigned _collected;
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( GarbageCollectorTest );
@@ -96,3 +104,30 @@ void GarbageCollectorTest::testCollect( void )
   AppLoop::process();
   CPPUNIT_ASSERT_EQUAL( 0U, Dummy::Instances );
 }
+
+
+//! Checks that an object still referenced elsewhere is kept past its grace period, until the collector's is the last.
+void GarbageCollectorTest::testReferenced( void )
+{
+  GarbageCollector<Dummy> gc;
+  gc.onCollect.connect( boost::bind( &GarbageCollectorTest::collected, this, _1 ) );
+  _collected = 0;
+
+  Dummy::Ptr d( new Dummy );
+  gc += d;
+  for ( unsigned i = 0; i < 4; ++i )
+    AppLoop::process();
+
+  CPPUNIT_ASSERT_EQUAL( 1U, Dummy::Instances );
+  CPPUNIT_ASSERT_EQUAL( 2U, d->refs() );
+  CPPUNIT_ASSERT_EQUAL( 1U, gc.size() );
+  CPPUNIT_ASSERT_EQUAL( 0U, _collected );
+
+  d = 0;
+  for ( unsigned i = 0; (i < 4) && gc.size(); ++i )
+    AppLoop::process();
+
+  CPPUNIT_ASSERT_EQUAL( 0U, Dummy::Instances );
+  CPPUNIT_ASSERT_EQUAL( 0U, gc.size() );
+  CPPUNIT_ASSERT_EQUAL( 1U, _collected );
+}
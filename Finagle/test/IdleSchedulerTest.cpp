@@ -0,0 +1,170 @@
+/*!
+** \file IdleSchedulerTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <boost/bind.hpp>
+#include <Finagle/AppLoop.h>
+#include <Finagle/IdleScheduler.h>
+#include <Finagle/Util.h>
+
+using namespace std;
+using namespace Finagle;
+
+class IdleSchedulerTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE( IdleSchedulerTest );
+  CPPUNIT_TEST( testPriority );
+  CPPUNIT_TEST( testIncremental );
+  CPPUNIT_TEST( testBudget );
+  CPPUNIT_TEST( testStarved );
+  CPPUNIT_TEST( testLoop );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testPriority( void );
+  void testIncremental( void );
+  void testBudget( void );
+  void testStarved( void );
+  void testLoop( void );
+
+protected:
+  bool task( unsigned id, unsigned slices, Time duration );
+
+protected:
+  Array<unsigned> _ran;
+  Array<unsigned> _remaining;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( IdleSchedulerTest );
+
+//! Records a slice of task \a id, which takes \a duration seconds, and finishes after \a slices (\c 0 for never).
+bool IdleSchedulerTest::task( unsigned id, unsigned slices, Time duration )
+{
+  _ran.push_back( id );
+  if ( duration.isValid() )
+    sleep( duration );
+
+  if ( !slices )
+    return true;
+
+  if ( _remaining.size() <= id )
+    _remaining.resize( id + 1, 0 );
+  if ( !_remaining[id] )
+    _remaining[id] = slices;
+
+  return --_remaining[id] != 0;
+}
+
+
+void IdleSchedulerTest::testPriority( void )
+{
+  IdleScheduler sched;
+  sched.setBudget( 0.0 );
+  sched.add( boost::bind( &IdleSchedulerTest::task, this, 1, 0, Time() ), -1 );
+  sched.add( boost::bind( &IdleSchedulerTest::task, this, 2, 0, Time() ), 5 );
+  sched.add( boost::bind( &IdleSchedulerTest::task, this, 3, 0, Time() ), 0 );
+  sched.add( boost::bind( &IdleSchedulerTest::task, this, 4, 0, Time() ), 5 );
+
+  _ran.clear();
+  CPPUNIT_ASSERT_EQUAL( 4U, sched.run() );
+  CPPUNIT_ASSERT_EQUAL( (size_t) 4, _ran.size() );
+  CPPUNIT_ASSERT_EQUAL( 2U, _ran[0] );
+  CPPUNIT_ASSERT_EQUAL( 4U, _ran[1] );
+  CPPUNIT_ASSERT_EQUAL( 3U, _ran[2] );
+  CPPUNIT_ASSERT_EQUAL( 1U, _ran[3] );
+}
+
+
+void IdleSchedulerTest::testIncremental( void )
+{
+  IdleScheduler sched;
+  _remaining.clear();
+  IdleScheduler::ID id = sched.add( boost::bind( &IdleSchedulerTest::task, this, 1, 3, Time() ) );
+
+  CPPUNIT_ASSERT( sched.contains( id ) );
+  CPPUNIT_ASSERT_EQUAL( 1U, sched.run() );
+  CPPUNIT_ASSERT_EQUAL( 1U, sched.run() );
+  CPPUNIT_ASSERT( sched.contains( id ) );
+  CPPUNIT_ASSERT_EQUAL( 1U, sched.run() );
+  CPPUNIT_ASSERT( !sched.contains( id ) );
+  CPPUNIT_ASSERT( sched.empty() );
+  CPPUNIT_ASSERT_EQUAL( 0U, sched.run() );
+}
+
+
+//! Checks that tasks which don't fit in the budget are run, round-robin, in later iterations.
+void IdleSchedulerTest::testBudget( void )
+{
+  IdleScheduler sched;
+  sched.setBudget( 0.05 );
+  for ( unsigned id = 1; id <= 4; ++id )
+    sched.add( boost::bind( &IdleSchedulerTest::task, this, id, 0, Time( 0.03 ) ) );
+
+  _ran.clear();
+  CPPUNIT_ASSERT_EQUAL( 2U, sched.run() );
+  CPPUNIT_ASSERT_EQUAL( 2U, sched.run() );
+
+  CPPUNIT_ASSERT_EQUAL( (size_t) 4, _ran.size() );
+  sort( _ran.begin(), _ran.end() );
+  for ( unsigned i = 0; i < 4; ++i )
+    CPPUNIT_ASSERT_EQUAL( i + 1, _ran[i] );
+}
+
+
+//! Checks that a low-priority task, crowded out by a higher-priority one, is reported as starved.
+void IdleSchedulerTest::testStarved( void )
+{
+  IdleScheduler sched;
+  LoopStats stats;
+  sched.setBudget( 0.001 );
+  sched.setStarveLimit( 3 );
+  sched.add( boost::bind( &IdleSchedulerTest::task, this, 1, 0, Time( 0.002 ) ), 1 );
+  IdleScheduler::ID low = sched.add( boost::bind( &IdleSchedulerTest::task, this, 2, 0, Time() ), 0 );
+
+  for ( unsigned i = 0; i < 2; ++i )
+    sched.run( &stats );
+  CPPUNIT_ASSERT_EQUAL( 0U, sched.starving() );
+  CPPUNIT_ASSERT_EQUAL( 0U, stats.starved );
+
+  sched.run( &stats );
+  sched.run( &stats );
+  CPPUNIT_ASSERT_EQUAL( 1U, sched.starving() );
+  CPPUNIT_ASSERT_EQUAL( 1U, stats.starved );
+
+  // Running the task clears its starvation
+  sched.setBudget( 0.0 );
+  sched.run( &stats );
+  CPPUNIT_ASSERT( sched.contains( low ) );
+  CPPUNIT_ASSERT_EQUAL( 0U, sched.starving() );
+}
+
+
+void IdleSchedulerTest::testLoop( void )
+{
+  AppLoop::Loop &loop = AppLoop::Loop::current();
+  _remaining.clear();
+  _ran.clear();
+  loop.idleTasks().add( boost::bind( &IdleSchedulerTest::task, this, 1, 2, Time() ) );
+
+  loop.process();
+  loop.process();
+  CPPUNIT_ASSERT_EQUAL( (size_t) 2, _ran.size() );
+  CPPUNIT_ASSERT( loop.idleTasks().empty() );
+}
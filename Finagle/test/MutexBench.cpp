@@ -0,0 +1,103 @@
+/*!
+** \file MutexBench.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Sat Oct 17 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <iostream>
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Array.h>
+#include <Finagle/Mutex.h>
+#include <Finagle/RWMutex.h>
+#include <Finagle/SpinMutex.h>
+#include <Finagle/Thread.h>
+
+using namespace std;
+using namespace Finagle;
+
+//! Times short, contended critical sections under each kind of mutex.
+class MutexBench : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE( MutexBench );
+  CPPUNIT_TEST( testVariants );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testVariants( void );
+
+protected:
+  static const unsigned Threads = 4, Increments = 200000;
+
+  //! Increments a shared count under a BasicLock on a \a MutexType
+  template <typename MutexType>
+  class Counter : public Thread {
+  public:
+    Counter( MutexType &m, unsigned &c ) : _mutex( m ), _count( c ) {}
+    ~Counter( void ) {  stop();  }
+
+  protected:
+    int exec( void ) {
+      for ( unsigned i = 0; i < Increments; ++i ) {
+        BasicLock<MutexType> _( _mutex );
+        _count++;
+      }
+      return 0;
+    }
+
+    MutexType &_mutex;
+    unsigned &_count;
+  };
+
+  template <typename MutexType>
+  void contend( char const *name );
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( MutexBench );
+
+
+//! Runs #Threads threads, each incrementing a count #Increments times under a \a MutexType.
+template <typename MutexType>
+void MutexBench::contend( char const *name )
+{
+  MutexType mutex;
+  unsigned count = 0;
+  Array<Counter<MutexType> *> counters;
+  for ( unsigned i = 0; i < Threads; ++i )
+    counters.push_back( new Counter<MutexType>( mutex, count ) );
+
+  Time start = Time::now();
+  for ( unsigned i = 0; i < Threads; ++i )
+    counters[i]->start();
+  for ( unsigned i = 0; i < Threads; ++i ) {
+    counters[i]->join();
+    delete counters[i];
+  }
+  Time elapsed = Time::now() - start;
+
+  CPPUNIT_ASSERT_EQUAL( Threads * Increments, count );
+  cout << "  " << name << ": " << (Threads * Increments / elapsed) << " locks/sec" << endl;
+}
+
+void MutexBench::testVariants( void )
+{
+  cout << endl << "Contended short critical sections (" << Threads << " threads):" << endl;
+  contend<Mutex>( "Mutex" );
+  contend<SpinMutex>( "SpinMutex" );
+  contend<AdaptiveMutex>( "AdaptiveMutex" );
+  contend<RWMutex>( "RWMutex (writing)" );
+}
@@ -19,10 +19,16 @@
 ** at http://www.gnu.org/copyleft/lesser.html .
 */
 
+#include <sstream>
 #include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Array.h>
+#include <Finagle/LockProfile.h>
 #include <Finagle/Mutex.h>
+#include <Finagle/RWMutex.h>
+#include <Finagle/SpinMutex.h>
 #include <Finagle/ThreadFunc.h>
 #include <Finagle/Util.h>
+#include <Finagle/WaitCondition.h>
 
 using namespace std;
 using namespace Finagle;
@@ -37,6 +43,10 @@ class MutexTest : public CppUnit::TestFixture
   CPPUNIT_TEST( testThreadLock );
   CPPUNIT_TEST( testThreadLock2 );
   CPPUNIT_TEST( testRecursiveLock );
+  CPPUNIT_TEST( testTryLock );
+  CPPUNIT_TEST( testRWMutex );
+  CPPUNIT_TEST( testVariants );
+  CPPUNIT_TEST( testProfile );
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -50,13 +60,46 @@ public:
   void testThreadLock( void );
   void testThreadLock2( void );
   void testRecursiveLock( void );
+  void testTryLock( void );
+  void testRWMutex( void );
+  void testVariants( void );
+  void testProfile( void );
 
 protected:
   void countUp( void );
+  void readRoutes( void );
+
+  //! Increments a shared count under a BasicLock on a \a MutexType
+  template <typename MutexType>
+  class Counter : public Thread {
+  public:
+    Counter( MutexType &m, unsigned &c, unsigned n ) : _mutex( m ), _count( c ), _n( n ) {}
+    ~Counter( void ) {  stop();  }
+
+  protected:
+    int exec( void ) {
+      for ( unsigned i = 0; i < _n; ++i ) {
+        BasicLock<MutexType> _( _mutex );
+        _count++;
+      }
+      return 0;
+    }
+
+    MutexType &_mutex;
+    unsigned &_count;
+    unsigned _n;
+  };
+
+  template <typename MutexType>
+  void contend( void );
 
 protected:
   Mutex *_guard;
   int _count;
+
+  RWMutex _routesGuard;
+  unsigned _routes[2];  //!< Always equal, when not write-locked
+  unsigned _torn;
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( MutexTest );
@@ -177,3 +220,150 @@ void MutexTest::countUp( void )
 }
 
 
+
+
+void MutexTest::testTryLock( void )
+{
+  CPPUNIT_ASSERT( _guard->tryLock() );
+  CPPUNIT_ASSERT( _guard->tryLock() );  // recursive
+  _guard->unlock();
+  _guard->unlock();
+
+  SpinMutex spin;
+  CPPUNIT_ASSERT( spin.tryLock() );
+  CPPUNIT_ASSERT( !spin.tryLock() );
+  spin.unlock();
+
+  AdaptiveMutex adaptive;
+  CPPUNIT_ASSERT( adaptive.tryLock() );
+  CPPUNIT_ASSERT( !adaptive.tryLock() );
+  adaptive.unlock();
+  CPPUNIT_ASSERT( adaptive.tryLock() );
+  adaptive.unlock();
+}
+
+
+void MutexTest::readRoutes( void )
+{
+  for ( unsigned i = 0; i < 10000; ++i ) {
+    ReadLock _( _routesGuard );
+    if ( _routes[0] != _routes[1] )
+      _torn++;
+  }
+}
+
+//! Checks that readers share an RWMutex, and are excluded by writers.
+void MutexTest::testRWMutex( void )
+{
+  {
+    ReadLock r1( _routesGuard );
+    CPPUNIT_ASSERT( _routesGuard.tryLockShared() );  // readers share
+    CPPUNIT_ASSERT( !_routesGuard.tryLock() );       // but exclude writers
+    _routesGuard.unlockShared();
+  }
+  {
+    WriteLock w( _routesGuard );
+    CPPUNIT_ASSERT( !_routesGuard.tryLockShared() );
+  }
+
+  _routes[0] = _routes[1] = 0;
+  _torn = 0;
+  ClassFuncThread<MutexTest> reader( this, &MutexTest::readRoutes );
+  reader.start();
+  for ( unsigned i = 0; i < 10000; ++i ) {
+    WriteLock _( _routesGuard );
+    _routes[0]++;
+    _routes[1]++;
+  }
+  reader.join();
+  CPPUNIT_ASSERT_EQUAL( 0U, _torn );
+}
+
+
+//! Runs 4 threads incrementing a count under a \a MutexType, and checks that no increment was lost.
+template <typename MutexType>
+void MutexTest::contend( void )
+{
+  static const unsigned Threads = 4, Increments = 200000;
+
+  MutexType mutex;
+  unsigned count = 0;
+  Array<Counter<MutexType> *> counters;
+  for ( unsigned i = 0; i < Threads; ++i )
+    counters.push_back( new Counter<MutexType>( mutex, count, Increments ) );
+
+  for ( unsigned i = 0; i < Threads; ++i )
+    counters[i]->start();
+  for ( unsigned i = 0; i < Threads; ++i ) {
+    counters[i]->join();
+    delete counters[i];
+  }
+
+  CPPUNIT_ASSERT_EQUAL( Threads * Increments, count );
+}
+
+void MutexTest::testVariants( void )
+{
+  contend<Mutex>();
+  contend<SpinMutex>();
+  contend<AdaptiveMutex>();
+  contend<RWMutex>();
+}
+
+
+//! Checks the lock profile of a named mutex, and of a lock site (which are only recorded with FINAGLE_PROFILE_LOCKS).
+void MutexTest::testProfile( void )
+{
+  _guard->setName( "MutexTest::guard" );
+
+  // Contended, while this thread holds it
+  ClassFuncThread<MutexTest> t( this, &MutexTest::countUp );
+  _guard->lock();
+  t.start();
+  sleep( 0.01 );
+  _guard->unlock();
+  t.join();
+
+  // Recursive, and released to wait on a condition
+  {
+    Lock _( *_guard );
+    Lock __( *_guard );
+  }
+  {
+    Condition cond;
+    Lock _( *_guard );
+    CPPUNIT_ASSERT( !cond.wait( *_guard, Time::now() + 0.01 ) );
+  }
+
+  SpinMutex spin;
+  {
+    SpinLock _( spin, "MutexTest::site" );
+  }
+
+  LockProfile::Stats stats;
+  if ( !LockProfile::enabled() ) {
+    CPPUNIT_ASSERT( !LockProfile::stats( "MutexTest::guard", stats ) );
+    return;
+  }
+
+  CPPUNIT_ASSERT( LockProfile::stats( "MutexTest::guard", stats ) );
+  CPPUNIT_ASSERT_EQUAL( 104UL, stats.acquisitions );
+  CPPUNIT_ASSERT( stats.contended.count >= 1 );
+  CPPUNIT_ASSERT( stats.contended.max >= 0.005 );
+  CPPUNIT_ASSERT_EQUAL( 104U, stats.hold.count );  // 101 + 1 (recursive) + 2 (either side of the condition wait)
+  CPPUNIT_ASSERT( stats.hold.max >= 0.005 );
+  CPPUNIT_ASSERT_EQUAL( 1U, stats.waits.count );
+  CPPUNIT_ASSERT( stats.waits.total >= 0.005 );
+
+  CPPUNIT_ASSERT( LockProfile::stats( "MutexTest::site", stats ) );
+  CPPUNIT_ASSERT_EQUAL( 1UL, stats.acquisitions );
+  CPPUNIT_ASSERT_EQUAL( 1U, stats.hold.count );
+
+  ostringstream report;
+  LockProfile::report( report );
+  CPPUNIT_ASSERT( report.str().find( "MutexTest::guard" ) != string::npos );
+
+  LockProfile::reset();
+  CPPUNIT_ASSERT( LockProfile::stats( "MutexTest::guard", stats ) );
+  CPPUNIT_ASSERT_EQUAL( 0UL, stats.acquisitions );
+}
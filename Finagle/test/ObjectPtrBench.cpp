@@ -0,0 +1,89 @@
+/*!
+** \file ObjectPtrBench.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Sat Oct 17 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <iostream>
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Array.h>
+#include <Finagle/DateTime.h>
+#include <Finagle/ObjectPtr.h>
+
+using namespace std;
+using namespace Finagle;
+
+//! Times copying and moving ObjectPtrs, with local and atomic reference counts.
+class ObjectPtrBench : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE( ObjectPtrBench );
+  CPPUNIT_TEST( testRotate );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testRotate( void );
+
+protected:
+  template <typename PtrType>
+  double rotate( char const *name, bool moving );
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ObjectPtrBench );
+
+
+//! Rotates a ring of pointers by copying (or moving) each one, and returns the time per rotated pointer.
+template <typename PtrType>
+double ObjectPtrBench::rotate( char const *name, bool moving )
+{
+  static const unsigned Size = 1000, Rounds = 1000;
+
+  Array<PtrType> ring;
+  for ( unsigned i = 0; i < Size; ++i )
+    ring.push_back( PtrType( new typename PtrType::ObjType ) );
+
+  Time start = Time::now();
+  for ( unsigned r = 0; r < Rounds; ++r ) {
+    PtrType first( moving ? PtrType( move( ring[0] ) ) : ring[0] );
+    for ( unsigned i = 1; i < Size; ++i )
+      if ( moving )
+        ring[i - 1] = move( ring[i] );
+      else
+        ring[i - 1] = ring[i];
+    if ( moving )
+      ring[Size - 1] = move( first );
+    else
+      ring[Size - 1] = first;
+  }
+  double ns = (Time::now() - start) * 1e9 / (Size * Rounds);
+
+  for ( unsigned i = 0; i < Size; ++i )
+    CPPUNIT_ASSERT_EQUAL( 1U, ring[i]->refs() );
+
+  cout << "  " << name << (moving ? " move: " : " copy: ") << ns << " ns" << endl;
+  return ns;
+}
+
+void ObjectPtrBench::testRotate( void )
+{
+  cout << endl << "Rotating a ring of 1000 pointers, per pointer:" << endl;
+  rotate<ObjectPtr<ReferenceCount> >( "ReferenceCount", false );
+  rotate<ObjectPtr<ReferenceCount> >( "ReferenceCount", true );
+  double copy = rotate<ObjectPtr<AtomicReferenceCount> >( "AtomicReferenceCount", false );
+  double moving = rotate<ObjectPtr<AtomicReferenceCount> >( "AtomicReferenceCount", true );
+  CPPUNIT_ASSERT( moving < copy );
+}
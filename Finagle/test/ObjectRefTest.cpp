@@ -30,10 +30,18 @@ class ObjectPtrTest : public CppUnit::TestFixture
 {
   CPPUNIT_TEST_SUITE( ObjectPtrTest );
   CPPUNIT_TEST( testDynamicCast );
+  CPPUNIT_TEST( testStaticCast );
+  CPPUNIT_TEST( testAssign );
+  CPPUNIT_TEST( testMove );
+  CPPUNIT_TEST( testRefTraffic );
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testDynamicCast( void );
+  void testStaticCast( void );
+  void testAssign( void );
+  void testMove( void );
+  void testRefTraffic( void );
 };
 
 
@@ -57,6 +65,33 @@ struct Bar : public Base {
   virtual ~Bar( void ) {}
 };
 
+//! Counts the references and releases of all Counted objects
+template <typename RefCount>
+struct Counted : public RefCount {
+  typedef ObjectPtr<Counted> Ptr;
+
+  void ref( void ) const {  referenced++;  RefCount::ref();  }
+  bool deref( void ) const {  released++;  return RefCount::deref();  }
+
+  static void reset( void ) {  referenced = released = 0;  }
+  static unsigned referenced, released;
+};
+
+template <typename RefCount>
+unsigned Counted<RefCount>::referenced = 0;
+
+template <typename RefCount>
+unsigned Counted<RefCount>::released = 0;
+
+//! A singly-linked list
+struct Link : public ReferenceCount {
+  typedef ObjectPtr<Link> Ptr;
+  Ptr next;
+};
+
+typedef Counted<ReferenceCount> Local;
+typedef Counted<AtomicReferenceCount> Shared;
+
 std::ostream &operator <<( std::ostream &out, Base const &b ) {  return out << "Base";  }
 std::ostream &operator <<( std::ostream &out, Foo const &f ) {  return out << "Foo";  }
 std::ostream &operator <<( std::ostream &out, Bar const &b ) {  return out << "Bar";  }
@@ -96,3 +131,96 @@ void ObjectPtrTest::testDynamicCast( void )
   }
 }
 
+
+
+void ObjectPtrTest::testStaticCast( void )
+{
+  Foo::Ptr f( new Foo );
+  Base::Ptr b( f );  // upcast (static)
+  CPPUNIT_ASSERT( b == f.operator Foo *() );
+  CPPUNIT_ASSERT_EQUAL( 2U, f->refs() );
+
+  Foo::Ptr f2 = staticCast<Foo>( b );
+  CPPUNIT_ASSERT( f2 == f );
+  CPPUNIT_ASSERT_EQUAL( 3U, f->refs() );
+
+  Bar::Ptr bar( b );  // not a Bar (dynamic)
+  CPPUNIT_ASSERT( !bar );
+}
+
+
+//! Checks that copy-assignment costs a single reference and release, and is safe when assigning an owner's member to it.
+void ObjectPtrTest::testAssign( void )
+{
+  Local::Ptr a( new Local ), b( new Local );
+  Local::reset();
+  a = b;
+  CPPUNIT_ASSERT_EQUAL( 1U, Local::referenced );
+  CPPUNIT_ASSERT_EQUAL( 1U, Local::released );
+  CPPUNIT_ASSERT( a == b );
+  CPPUNIT_ASSERT_EQUAL( 2U, a->refs() );
+
+  a = a;
+  CPPUNIT_ASSERT_EQUAL( 2U, a->refs() );
+
+  // Replace a list's head with its next link (which only the head references)
+  Link::Ptr head( new Link );
+  head->next = new Link;
+  head = head->next;
+  CPPUNIT_ASSERT( head );
+  CPPUNIT_ASSERT_EQUAL( 1U, head->refs() );
+}
+
+
+//! Checks that moving hands over a reference without touching the count.
+void ObjectPtrTest::testMove( void )
+{
+  Shared::Ptr a( new Shared ), b;
+  Shared::reset();
+
+  Shared::Ptr c( move( a ) );
+  CPPUNIT_ASSERT( !a );
+  CPPUNIT_ASSERT( c );
+  CPPUNIT_ASSERT_EQUAL( 1U, c->refs() );
+
+  b = move( c );
+  CPPUNIT_ASSERT( !c );
+  CPPUNIT_ASSERT_EQUAL( 1U, b->refs() );
+  CPPUNIT_ASSERT_EQUAL( 0U, Shared::referenced );
+  CPPUNIT_ASSERT_EQUAL( 0U, Shared::released );
+
+  b = move( b );
+  CPPUNIT_ASSERT( b );
+  CPPUNIT_ASSERT_EQUAL( 1U, b->refs() );
+
+  // Moving onto a pointer releases what it referenced
+  Shared::Ptr d( new Shared );
+  d = move( b );
+  CPPUNIT_ASSERT_EQUAL( 1U, Shared::released );
+  CPPUNIT_ASSERT_EQUAL( 1U, d->refs() );
+}
+
+
+//! Counts the reference traffic of copying and moving.
+void ObjectPtrTest::testRefTraffic( void )
+{
+  Shared::Ptr a( new Shared ), b( new Shared );
+  Shared::reset();
+  for ( unsigned i = 0; i < 1000; ++i ) {
+    Shared::Ptr t( a );
+    a = b;
+    b = t;
+  }
+  unsigned copied = Shared::referenced + Shared::released;
+
+  Shared::reset();
+  for ( unsigned i = 0; i < 1000; ++i ) {
+    Shared::Ptr t( move( a ) );
+    a = move( b );
+    b = move( t );
+  }
+  unsigned moved = Shared::referenced + Shared::released;
+
+  CPPUNIT_ASSERT_EQUAL( 6000U, copied );  // 3 references and 3 releases per swap (by-value assignment took 5 of each)
+  CPPUNIT_ASSERT_EQUAL( 0U, moved );
+}
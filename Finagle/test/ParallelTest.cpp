@@ -0,0 +1,261 @@
+/*!
+** \file ParallelTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+
+#include <cstdlib>
+#include <functional>
+#include <set>
+#include <stdexcept>
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Parallel.h>
+#include <Finagle/TextString.h>
+
+using namespace std;
+using namespace Finagle;
+
+class ParallelTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE( ParallelTest );
+  CPPUNIT_TEST( testFor );
+  CPPUNIT_TEST( testSerial );
+  CPPUNIT_TEST( testTransform );
+  CPPUNIT_TEST( testReduce );
+  CPPUNIT_TEST( testSort );
+  CPPUNIT_TEST( testFailure );
+  CPPUNIT_TEST( testNested );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  ParallelTest( void );
+
+  void testFor( void );
+  void testSerial( void );
+  void testTransform( void );
+  void testReduce( void );
+  void testSort( void );
+  void testFailure( void );
+  void testNested( void );
+
+protected:
+  //! Counts each visit to an index, and the threads which visit
+  struct Visit {
+    Visit( ParallelTest &t ) : test( t ) {}
+    void operator()( size_t i ) const;
+    ParallelTest &test;
+  };
+
+  //! Doubles an element in place
+  struct Double {
+    void operator()( unsigned &v ) const {  v *= 2;  }
+  };
+
+  //! Fails on one element
+  struct Fail {
+    void operator()( unsigned v ) const {  if ( v == 500 )  throw runtime_error( "Failed on 500" );  }
+  };
+
+  //! Runs an inner parallelFor() for each outer iteration
+  struct Outer {
+    Outer( ParallelTest &t, ThreadPool &p ) : test( t ), pool( p ) {}
+    void operator()( size_t i ) const {  parallelFor( i * 100, (i + 1) * 100, Visit( test ), pool, 10 );  }
+    ParallelTest &test;
+    ThreadPool &pool;
+  };
+
+  static String digits( unsigned v );
+
+protected:
+  Array<int> _visits;
+  Mutex _guard;
+  set<Thread::ID> _threads;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ParallelTest );
+
+
+ParallelTest::ParallelTest( void )
+: _visits( 10000, 0 )
+{}
+
+void ParallelTest::Visit::operator()( size_t i ) const
+{
+  __sync_add_and_fetch( &test._visits[i], 1 );
+
+  Lock _( test._guard );
+  test._threads.insert( Thread::self_id() );
+}
+
+String ParallelTest::digits( unsigned v )
+{
+  return String( v );
+}
+
+
+void ParallelTest::testFor( void )
+{
+  ThreadPool pool( 3 );
+  parallelFor( 0, _visits.size(), Visit( *this ), pool, 100 );
+
+  for ( unsigned i = 0; i < _visits.size(); ++i )
+    CPPUNIT_ASSERT_EQUAL( 1, _visits[i] );
+
+  CPPUNIT_ASSERT( _threads.size() >= 1 );
+  CPPUNIT_ASSERT( _threads.size() <= 4 );
+
+  // Each element, in place
+  Array<unsigned> values;
+  for ( unsigned i = 0; i < 100000; ++i )
+    values.push_back( i );
+
+  parallelFor( values, Double(), pool, 1000 );
+  for ( unsigned i = 0; i < values.size(); ++i )
+    CPPUNIT_ASSERT_EQUAL( 2 * i, values[i] );
+
+  // Empty ranges
+  parallelFor( 5, 5, Visit( *this ), pool );
+  Array<unsigned> none;
+  parallelFor( none, Double(), pool );
+}
+
+
+//! Checks that small inputs are run on the calling thread.
+void ParallelTest::testSerial( void )
+{
+  ThreadPool pool( 3 );
+  parallelFor( 0, Parallel::SerialIterations, Visit( *this ), pool );
+  CPPUNIT_ASSERT_EQUAL( (size_t) 1, _threads.size() );
+  CPPUNIT_ASSERT( _threads.count( Thread::self_id() ) );
+
+  CPPUNIT_ASSERT_EQUAL( (size_t) 100, Parallel::grain( 0, 100, 4, pool ) );
+  CPPUNIT_ASSERT_EQUAL( (size_t) 7, Parallel::grain( 7, 100, 4, pool ) );
+
+  // Large inputs are split into cache-sized chunks, at least a few per thread
+  size_t count = 64 * Parallel::cacheSize();
+  size_t grain = Parallel::grain( 0, count, 8, pool );
+  CPPUNIT_ASSERT( grain * 8 <= Parallel::cacheSize() / 2 );
+  CPPUNIT_ASSERT( count / grain >= Parallel::ChunksPerThread * (pool.size() + 1) );
+}
+
+
+void ParallelTest::testTransform( void )
+{
+  ThreadPool pool( 3 );
+
+  Array<unsigned> in;
+  for ( unsigned i = 0; i < 10000; ++i )
+    in.push_back( i );
+
+  Array<String> out;
+  parallelTransform( in, out, &ParallelTest::digits, pool, 64 );
+  CPPUNIT_ASSERT_EQUAL( in.size(), out.size() );
+  for ( unsigned i = 0; i < in.size(); ++i )
+    CPPUNIT_ASSERT_EQUAL( String( i ), out[i] );
+
+  // In place
+  parallelTransform( in, in, bind2nd( plus<unsigned>(), 1 ), pool, 64 );
+  for ( unsigned i = 0; i < in.size(); ++i )
+    CPPUNIT_ASSERT_EQUAL( i + 1, in[i] );
+}
+
+
+void ParallelTest::testReduce( void )
+{
+  ThreadPool pool( 3 );
+
+  Array<unsigned> values;
+  for ( unsigned i = 1; i <= 10000; ++i )
+    values.push_back( i );
+
+  CPPUNIT_ASSERT_EQUAL( 50005000U, parallelReduce( values, 0U, plus<unsigned>(), pool, 100 ) );
+
+  // Chunks are combined in order, so non-commutative operations are deterministic
+  Array<unsigned> some( values.begin(), values.begin() + 500 );
+  String expected;
+  for ( unsigned i = 0; i < some.size(); ++i )
+    expected += String( some[i] );
+  CPPUNIT_ASSERT_EQUAL( expected, parallelMapReduce( some, String(), &ParallelTest::digits, plus<String>(), pool, 7 ) );
+
+  Array<unsigned> none;
+  CPPUNIT_ASSERT_EQUAL( 42U, parallelReduce( none, 42U, plus<unsigned>(), pool ) );
+}
+
+
+void ParallelTest::testSort( void )
+{
+  ThreadPool pool( 3 );
+
+  srand( 42 );
+  Array<int> values;
+  for ( unsigned i = 0; i < 100000; ++i )
+    values.push_back( rand() % 10000 );
+
+  size_t grains[] = {  0, 1000, 777, 100000  };
+  for ( unsigned g = 0; g < sizeof(grains) / sizeof(grains[0]); ++g ) {
+    Array<int> sorted( values ), expected( values );
+    parallelSort( sorted, pool, grains[g] );
+    std::sort( expected.begin(), expected.end() );
+    CPPUNIT_ASSERT( sorted == expected );
+
+    parallelSort( sorted, greater<int>(), pool, grains[g] );
+    std::sort( expected.begin(), expected.end(), greater<int>() );
+    CPPUNIT_ASSERT( sorted == expected );
+  }
+
+  // With the shared pool
+  Array<int> sorted( values );
+  parallelSort( sorted );
+  CPPUNIT_ASSERT( adjacent_find( sorted.begin(), sorted.end(), greater<int>() ) == sorted.end() );
+}
+
+
+void ParallelTest::testFailure( void )
+{
+  ThreadPool pool( 3 );
+
+  Array<unsigned> values;
+  for ( unsigned i = 0; i < 10000; ++i )
+    values.push_back( i );
+
+  String error;
+  try {
+    parallelFor( values, Fail(), pool, 10 );
+  }
+  catch ( Exception &ex ) {
+    error = ex.what();
+  }
+  CPPUNIT_ASSERT_EQUAL( String( "Failed on 500" ), error );
+
+  // The pool is still usable
+  parallelFor( 0, _visits.size(), Visit( *this ), pool, 100 );
+  for ( unsigned i = 0; i < _visits.size(); ++i )
+    CPPUNIT_ASSERT_EQUAL( 1, _visits[i] );
+}
+
+
+//! Checks that algorithms may run within each other's chunks, on a pool with a single worker.
+void ParallelTest::testNested( void )
+{
+  ThreadPool pool( 1 );
+  parallelFor( 0, 100, Outer( *this, pool ), pool, 1 );
+
+  for ( unsigned i = 0; i < _visits.size(); ++i )
+    CPPUNIT_ASSERT_EQUAL( 1, _visits[i] );
+}
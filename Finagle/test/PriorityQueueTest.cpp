@@ -20,6 +20,7 @@
 */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Array.h>
 #include <Finagle/PriorityQueue.h>
 #include <Finagle/ThreadFunc.h>
 #include <Finagle/Util.h>
@@ -36,6 +37,9 @@ class PriorityQueueTest : public CppUnit::TestFixture
   CPPUNIT_TEST( testPushPop );
   CPPUNIT_TEST( testSynchronize );*/
   CPPUNIT_TEST( testThreadFill );
+  CPPUNIT_TEST( testBatch );
+  CPPUNIT_TEST( testSwap );
+  CPPUNIT_TEST( testHandles );
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -48,6 +52,9 @@ public:
   void testPushPop( void );
   void testSynchronize( void );
   void testThreadFill( void );
+  void testBatch( void );
+  void testSwap( void );
+  void testHandles( void );
 
 protected:
   void enqueue( void );
@@ -219,3 +226,114 @@ void PriorityQueueTest::fillQueue( void )
     d = 0;
   }
 }
+
+
+void PriorityQueueTest::testBatch( void )
+{
+  Array<unsigned> low, high, dest;
+  for ( unsigned i = 0; i < 5; ++i ) {
+    low.push_back( i );
+    high.push_back( i + 5 );
+  }
+
+  _queue->push_range( low.begin(), low.end(), 1.0 );
+  _queue->push_range( high.begin(), high.end(), 2.0 );
+  CPPUNIT_ASSERT_EQUAL( 10U, _queue->size() );
+
+  CPPUNIT_ASSERT_EQUAL( 5U, _queue->pop_up_to( 5, dest ) );
+  CPPUNIT_ASSERT( dest == high );
+
+  dest.clear();
+  CPPUNIT_ASSERT_EQUAL( 5U, _queue->pop_all( dest ) );
+  CPPUNIT_ASSERT( _queue->empty() );
+  CPPUNIT_ASSERT( dest == low );
+}
+
+
+//! Checks that swapping an item into the queue doesn't touch its reference count, and that popping releases the queue's.
+void PriorityQueueTest::testSwap( void )
+{
+  Dummy::Ptr d( new Dummy( 42 ) ), dest;
+  Dummy *obj = d;
+
+  _dummies->push_swap( d, 1.0 );
+  CPPUNIT_ASSERT( !d );
+  CPPUNIT_ASSERT_EQUAL( 1U, obj->refs() );
+
+  CPPUNIT_ASSERT( _dummies->pop( dest ) );
+  CPPUNIT_ASSERT( dest == obj );
+  CPPUNIT_ASSERT_EQUAL( 1U, obj->refs() );
+  CPPUNIT_ASSERT( _dummies->empty() );
+  // Strings are sifted and popped without being copied, so each comes out in the buffer it was pushed in
+  PriorityQueue<String> strings;
+  char const *buffers[32];
+  for ( unsigned i = 0; i < 32; ++i ) {
+    String str( 256U, char( 'a' + i % 26 ) );
+    buffers[i] = str.data();
+    strings.push_swap( str, (i * 7) % 32 );
+  }
+
+  for ( unsigned p = 32; p-- > 0; ) {
+    String str;
+    CPPUNIT_ASSERT( strings.pop( str ) );
+    unsigned i = (p * 23) % 32;  // pushed with priority p, as 23 is 7's inverse (mod 32)
+    CPPUNIT_ASSERT( str.data() == buffers[i] );
+  }
+}
+
+
+//! Checks removing and reprioritizing queued items by handle, and that handles go stale once their items leave.
+void PriorityQueueTest::testHandles( void )
+{
+  PriorityQueue<unsigned>::Handle h[6];
+  for ( unsigned i = 0; i < 6; ++i )
+    h[i] = _queue->push_handle( i, 1.0 );
+
+  CPPUNIT_ASSERT( _queue->contains( h[3] ) );
+  CPPUNIT_ASSERT( _queue->erase( h[3] ) );
+  CPPUNIT_ASSERT( !_queue->contains( h[3] ) );
+  CPPUNIT_ASSERT( !_queue->erase( h[3] ) );
+  CPPUNIT_ASSERT_EQUAL( 5U, _queue->size() );
+
+  CPPUNIT_ASSERT( _queue->reprioritize( h[4], 2.0 ) );  // raised to the front
+  CPPUNIT_ASSERT( _queue->reprioritize( h[0], 1.0 ) );  // same priority, so to the back of its peers
+
+  CPPUNIT_ASSERT_EQUAL( 4U, _queue->pop() );
+  CPPUNIT_ASSERT_EQUAL( 1U, _queue->pop() );
+  CPPUNIT_ASSERT( !_queue->contains( h[1] ) );
+
+  // A handle whose slot has been reused is still stale
+  PriorityQueue<unsigned>::Handle reused = _queue->push_handle( 7, 0.0 );
+  CPPUNIT_ASSERT( !_queue->contains( h[1] ) );
+  CPPUNIT_ASSERT( !_queue->reprioritize( h[1], 3.0 ) );
+  CPPUNIT_ASSERT( _queue->contains( reused ) );
+
+  CPPUNIT_ASSERT_EQUAL( 2U, _queue->pop() );
+  CPPUNIT_ASSERT_EQUAL( 5U, _queue->pop() );
+  CPPUNIT_ASSERT_EQUAL( 0U, _queue->pop() );
+  CPPUNIT_ASSERT_EQUAL( 7U, _queue->pop() );
+  CPPUNIT_ASSERT( _queue->empty() );
+  CPPUNIT_ASSERT( !_queue->contains( reused ) );
+
+  // Ordering holds through a larger mix of pushes, erasures and pops
+  Array<PriorityQueue<unsigned>::Handle> handles;
+  for ( unsigned i = 0; i < 1000; ++i )
+    handles.push_back( _queue->push_handle( i, double( (i * 7919) % 13 ) ) );
+
+  for ( unsigned i = 0; i < 1000; i += 3 )
+    CPPUNIT_ASSERT( _queue->erase( handles[i] ) );
+
+  double lastPri = 13.0;
+  unsigned last = 0;
+  while ( !_queue->empty() ) {
+    unsigned v = _queue->pop();
+    CPPUNIT_ASSERT( v % 3 );
+    double pri = double( (v * 7919) % 13 );
+    CPPUNIT_ASSERT( pri <= lastPri );
+    if ( pri == lastPri )
+      CPPUNIT_ASSERT( v > last );
+
+    lastPri = pri;
+    last = v;
+  }
+}
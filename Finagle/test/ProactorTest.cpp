@@ -0,0 +1,334 @@
+/*!
+** \file ProactorTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <boost/bind.hpp>
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/AppLoop.h>
+#include <Finagle/Proactor.h>
+
+using namespace std;
+using namespace Finagle;
+
+class ProactorTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE( ProactorTest );
+  CPPUNIT_TEST( testRecvSend );
+  CPPUNIT_TEST( testReadWrite );
+  CPPUNIT_TEST( testAccept );
+  CPPUNIT_TEST( testError );
+  CPPUNIT_TEST( testCancel );
+  CPPUNIT_TEST( testDestroy );
+  CPPUNIT_TEST( testThrow );
+  CPPUNIT_TEST( testLoopIO );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testRecvSend( void );
+  void testReadWrite( void );
+  void testAccept( void );
+  void testError( void );
+  void testCancel( void );
+  void testDestroy( void );
+  void testThrow( void );
+  void testLoopIO( void );
+
+protected:
+  void recvSend( bool useRing );
+  void readWrite( bool useRing );
+  void accept( bool useRing );
+
+  void onDone( int res );
+  void onThrow( int res );
+  void run( Proactor &io );
+
+protected:
+  Array<int> _results;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ProactorTest );
+
+
+void ProactorTest::onDone( int res )
+{
+  _results.push_back( res );
+}
+
+
+void ProactorTest::onThrow( int )
+{
+  throw runtime_error( "Handler failed" );
+}
+
+
+//! Runs the loop until every operation has completed (or a second has passed).
+void ProactorTest::run( Proactor &io )
+{
+  Time end = Time::now() + 1.0;
+  while ( io.pending() && (Time::now() < end) )
+    AppLoop::process( 0.01 );
+
+  CPPUNIT_ASSERT_EQUAL( 0U, io.pending() );
+}
+
+
+void ProactorTest::recvSend( bool useRing )
+{
+  _results.clear();
+  Proactor io( AppLoop::Loop::current(), useRing );
+
+  int sock[2];
+  CPPUNIT_ASSERT_EQUAL( 0, socketpair( AF_UNIX, SOCK_STREAM, 0, sock ) );
+
+  // Receive is submitted first, so must wait for the send
+  char buf[16];
+  io.recv( sock[1], buf, sizeof(buf), boost::bind( &ProactorTest::onDone, this, _1 ) );
+  io.send( sock[0], "hello", 5, boost::bind( &ProactorTest::onDone, this, _1 ) );
+  CPPUNIT_ASSERT( _results.empty() );
+
+  run( io );
+  CPPUNIT_ASSERT_EQUAL( (size_t) 2, _results.size() );
+  CPPUNIT_ASSERT_EQUAL( 5, _results[0] );
+  CPPUNIT_ASSERT_EQUAL( 5, _results[1] );
+  CPPUNIT_ASSERT( memcmp( buf, "hello", 5 ) == 0 );
+
+  close( sock[0] );
+  close( sock[1] );
+}
+
+void ProactorTest::testRecvSend( void )
+{
+  recvSend( true );
+  recvSend( false );
+}
+
+
+void ProactorTest::readWrite( bool useRing )
+{
+  _results.clear();
+  Proactor io( AppLoop::Loop::current(), useRing );
+
+  FILE *file = tmpfile();
+  CPPUNIT_ASSERT( file );
+  int fd = fileno( file );
+
+  io.write( fd, "0123456789", 10, 0, boost::bind( &ProactorTest::onDone, this, _1 ) );
+  CPPUNIT_ASSERT( _results.empty() );
+  run( io );
+
+  char buf[4];
+  io.read( fd, buf, sizeof(buf), 3, boost::bind( &ProactorTest::onDone, this, _1 ) );
+  run( io );
+
+  CPPUNIT_ASSERT_EQUAL( (size_t) 2, _results.size() );
+  CPPUNIT_ASSERT_EQUAL( 10, _results[0] );
+  CPPUNIT_ASSERT_EQUAL( 4, _results[1] );
+  CPPUNIT_ASSERT( memcmp( buf, "3456", 4 ) == 0 );
+
+  fclose( file );
+}
+
+void ProactorTest::testReadWrite( void )
+{
+  readWrite( true );
+  readWrite( false );
+}
+
+
+void ProactorTest::accept( bool useRing )
+{
+  _results.clear();
+  Proactor io( AppLoop::Loop::current(), useRing );
+
+  int listener = socket( AF_INET, SOCK_STREAM, 0 );
+  CPPUNIT_ASSERT( listener != -1 );
+
+  sockaddr_in addr;
+  memset( &addr, 0, sizeof(addr) );
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+  socklen_t len = sizeof(addr);
+  CPPUNIT_ASSERT_EQUAL( 0, bind( listener, (sockaddr *) &addr, sizeof(addr) ) );
+  CPPUNIT_ASSERT_EQUAL( 0, listen( listener, 1 ) );
+  CPPUNIT_ASSERT_EQUAL( 0, getsockname( listener, (sockaddr *) &addr, &len ) );
+
+  io.accept( listener, boost::bind( &ProactorTest::onDone, this, _1 ) );
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT( _results.empty() );
+
+  int client = socket( AF_INET, SOCK_STREAM, 0 );
+  CPPUNIT_ASSERT_EQUAL( 0, connect( client, (sockaddr *) &addr, sizeof(addr) ) );
+  run( io );
+
+  CPPUNIT_ASSERT_EQUAL( (size_t) 1, _results.size() );
+  CPPUNIT_ASSERT( _results[0] >= 0 );
+
+  close( _results[0] );
+  close( client );
+  close( listener );
+}
+
+void ProactorTest::testAccept( void )
+{
+  accept( true );
+  accept( false );
+}
+
+
+void ProactorTest::testError( void )
+{
+  for ( unsigned i = 0; i < 2; ++i ) {
+    _results.clear();
+    Proactor io( AppLoop::Loop::current(), i == 0 );
+
+    char buf[4];
+    io.read( -1, buf, sizeof(buf), 0, boost::bind( &ProactorTest::onDone, this, _1 ) );
+    run( io );
+
+    CPPUNIT_ASSERT_EQUAL( (size_t) 1, _results.size() );
+    CPPUNIT_ASSERT_EQUAL( -EBADF, _results[0] );
+  }
+}
+
+
+void ProactorTest::testCancel( void )
+{
+  unsigned watchers = AppLoop::Loop::current().watchers().size();
+
+  for ( unsigned i = 0; i < 2; ++i ) {
+    _results.clear();
+    Proactor io( AppLoop::Loop::current(), i == 0 );
+
+    int sock[2];
+    CPPUNIT_ASSERT_EQUAL( 0, socketpair( AF_UNIX, SOCK_STREAM, 0, sock ) );
+
+    // Nothing is ever sent, so the receive can only complete by being cancelled
+    char buf[4];
+    io.recv( sock[1], buf, sizeof(buf), boost::bind( &ProactorTest::onDone, this, _1 ) );
+    AppLoop::process( 0.01 );
+    CPPUNIT_ASSERT( _results.empty() );
+
+    io.cancel( sock[1] );
+    CPPUNIT_ASSERT( _results.empty() );
+    run( io );
+
+    CPPUNIT_ASSERT_EQUAL( (size_t) 1, _results.size() );
+    CPPUNIT_ASSERT_EQUAL( -ECANCELED, _results[0] );
+
+    // The fallback stops watching a descriptor once nothing's queued on it
+    if ( !io.usingRing() )
+      CPPUNIT_ASSERT_EQUAL( watchers, AppLoop::Loop::current().watchers().size() );
+
+    close( sock[0] );
+    close( sock[1] );
+  }
+}
+
+
+void ProactorTest::testDestroy( void )
+{
+  for ( unsigned i = 0; i < 2; ++i ) {
+    _results.clear();
+
+    int sock[2];
+    CPPUNIT_ASSERT_EQUAL( 0, socketpair( AF_UNIX, SOCK_STREAM, 0, sock ) );
+
+    char buf[4];
+    {
+      Proactor io( AppLoop::Loop::current(), i == 0 );
+      io.recv( sock[1], buf, sizeof(buf), boost::bind( &ProactorTest::onDone, this, _1 ) );
+      io.read( -1, buf, sizeof(buf), 0, boost::bind( &ProactorTest::onDone, this, _1 ) );
+      io.flush();
+      CPPUNIT_ASSERT_EQUAL( 2U, io.pending() );
+    }
+
+    // Neither the outstanding receive, nor the posted delivery of the read, may reach the destroyed proactor
+    AppLoop::process( 0.01 );
+    AppLoop::process( 0.01 );
+    CPPUNIT_ASSERT( _results.empty() );
+
+    close( sock[0] );
+    close( sock[1] );
+  }
+}
+
+
+//! Checks that when a handler throws, the operations completed alongside it are still delivered.
+void ProactorTest::testThrow( void )
+{
+  for ( unsigned i = 0; i < 2; ++i ) {
+    _results.clear();
+    Proactor io( AppLoop::Loop::current(), i == 0 );
+
+    FILE *file = tmpfile();
+    CPPUNIT_ASSERT( file );
+    int fd = fileno( file );
+
+    io.write( fd, "01", 2, 0, boost::bind( &ProactorTest::onThrow, this, _1 ) );
+    io.write( fd, "23", 2, 2, boost::bind( &ProactorTest::onDone, this, _1 ) );
+    io.write( fd, "45", 2, 4, boost::bind( &ProactorTest::onDone, this, _1 ) );
+
+    unsigned thrown = 0;
+    Time end = Time::now() + 1.0;
+    while ( io.pending() && (Time::now() < end) ) {
+      try {
+        AppLoop::process( 0.01 );
+      }
+      catch ( runtime_error & ) {
+        thrown++;
+      }
+    }
+
+    CPPUNIT_ASSERT_EQUAL( 0U, io.pending() );
+    CPPUNIT_ASSERT_EQUAL( 1U, thrown );
+    CPPUNIT_ASSERT_EQUAL( (size_t) 2, _results.size() );
+    CPPUNIT_ASSERT_EQUAL( 2, _results[0] );
+    CPPUNIT_ASSERT_EQUAL( 2, _results[1] );
+
+    fclose( file );
+  }
+}
+
+
+void ProactorTest::testLoopIO( void )
+{
+  _results.clear();
+  Proactor &io = AppLoop::Loop::current().io();
+  CPPUNIT_ASSERT_EQUAL( &io, &AppLoop::Loop::current().io() );
+
+  int sock[2];
+  CPPUNIT_ASSERT_EQUAL( 0, socketpair( AF_UNIX, SOCK_STREAM, 0, sock ) );
+
+  char buf[4];
+  io.send( sock[0], "ping", 4, boost::bind( &ProactorTest::onDone, this, _1 ) );
+  io.recv( sock[1], buf, sizeof(buf), boost::bind( &ProactorTest::onDone, this, _1 ) );
+  run( io );
+
+  CPPUNIT_ASSERT_EQUAL( (size_t) 2, _results.size() );
+  CPPUNIT_ASSERT( memcmp( buf, "ping", 4 ) == 0 );
+
+  close( sock[0] );
+  close( sock[1] );
+}
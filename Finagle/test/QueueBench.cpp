@@ -0,0 +1,218 @@
+/*!
+** \file QueueBench.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Array.h>
+#include <Finagle/PriorityQueue.h>
+#include <Finagle/RingQueue.h>
+#include <Finagle/SPSCQueue.h>
+#include <Finagle/SizedQueue.h>
+#include <Finagle/Thread.h>
+
+using namespace std;
+using namespace Finagle;
+
+/*! \brief Throughput and handoff latency of the queue family, under 1..N producers and consumers.
+**
+** Each item is the time at which it was pushed, so each consumer can record how long it waited in the queue.  Every run
+** also checks that every item is delivered, as a lost wakeup shows up as a consumer stuck with items still queued.
+*/
+class QueueBench : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE( QueueBench );
+  CPPUNIT_TEST( testQueue );
+  CPPUNIT_TEST( testSizedQueue );
+  CPPUNIT_TEST( testPriorityQueue );
+  CPPUNIT_TEST( testRingQueue );
+  CPPUNIT_TEST( testSPSCQueue );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testQueue( void );
+  void testSizedQueue( void );
+  void testPriorityQueue( void );
+  void testRingQueue( void );
+  void testSPSCQueue( void );
+
+protected:
+  static const unsigned Items = 20000;    //!< Items pushed per run (split between the producers)
+  static const unsigned MaxThreads = 4;   //!< Producers and consumers range over 1, 2, ... MaxThreads
+  static const unsigned Capacity = 1024;  //!< Of the bounded queues
+
+  //! Pushes and pops items (push times, or \c -1 to stop a consumer) on each kind of queue
+  template <typename QueueType>
+  struct Ops {
+    static void push( QueueType &q, double item ) {  q.push_back( item );  }
+    static double pop( QueueType &q ) {  return q.pop_front();  }
+  };
+
+  template <typename QueueType>
+  class Producer : public Thread {
+  public:
+    Producer( QueueType &q, unsigned items ) : _queue( q ), _items( items ) {}
+    ~Producer( void ) {  stop();  }
+
+  protected:
+    int exec( void ) {
+      for ( unsigned i = 0; i < _items; ++i )
+        Ops<QueueType>::push( _queue, Time::now() );
+      return 0;
+    }
+
+    QueueType &_queue;
+    unsigned _items;
+  };
+
+  template <typename QueueType>
+  class Consumer : public Thread {
+  public:
+    Consumer( QueueType &q ) : _queue( q ) {}
+    ~Consumer( void ) {  stop();  }
+
+    Array<double> latencies;
+
+  protected:
+    int exec( void ) {
+      double item;
+      while ( (item = Ops<QueueType>::pop( _queue )) >= 0.0 )
+        latencies.push_back( Time::now() - item );
+      return 0;
+    }
+
+    QueueType &_queue;
+  };
+
+  static void header( char const *name );
+
+  template <typename QueueType>
+  void run( char const *name, QueueType &queue );
+
+  template <typename QueueType>
+  void run( char const *name, QueueType &queue, unsigned producers, unsigned consumers );
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( QueueBench );
+
+const unsigned QueueBench::Items;
+
+template <>
+struct QueueBench::Ops< PriorityQueue<double> > {
+  static void push( PriorityQueue<double> &q, double item ) {  q.push( item );  }
+  static double pop( PriorityQueue<double> &q ) {  return q.pop();  }
+};
+
+
+void QueueBench::header( char const *name )
+{
+  cout << endl << name << ": producers x consumers, throughput (items/sec), p50 and p99 handoff latency (usec)" << endl;
+}
+
+//! Runs \a queue through each combination of producers and consumers.
+template <typename QueueType>
+void QueueBench::run( char const *name, QueueType &queue )
+{
+  header( name );
+  for ( unsigned producers = 1; producers <= MaxThreads; producers *= 2 )
+    for ( unsigned consumers = 1; consumers <= MaxThreads; consumers *= 2 )
+      run( name, queue, producers, consumers );
+}
+
+//! Pushes #Items through \a queue from \a producers threads to \a consumers threads, and reports the results.
+template <typename QueueType>
+void QueueBench::run( char const *name, QueueType &queue, unsigned producers, unsigned consumers )
+{
+  Array<Producer<QueueType> *> prods;
+  Array<Consumer<QueueType> *> cons;
+  for ( unsigned i = 0; i < consumers; ++i )
+    cons.push_back( new Consumer<QueueType>( queue ) );
+  for ( unsigned i = 0; i < producers; ++i )
+    prods.push_back( new Producer<QueueType>( queue, (Items / producers) + ((i < (Items % producers)) ? 1 : 0) ) );
+
+  Time start = Time::now();
+  for ( unsigned i = 0; i < consumers; ++i )
+    cons[i]->start();
+  for ( unsigned i = 0; i < producers; ++i )
+    prods[i]->start();
+
+  for ( unsigned i = 0; i < producers; ++i )
+    prods[i]->join();
+  for ( unsigned i = 0; i < consumers; ++i )
+    Ops<QueueType>::push( queue, -1.0 );
+  for ( unsigned i = 0; i < consumers; ++i )
+    cons[i]->join();
+  Time elapsed = Time::now() - start;
+
+  Array<double> latencies;
+  for ( unsigned i = 0; i < consumers; ++i )
+    latencies.insert( latencies.end(), cons[i]->latencies.begin(), cons[i]->latencies.end() );
+
+  for ( unsigned i = 0; i < producers; ++i )
+    delete prods[i];
+  for ( unsigned i = 0; i < consumers; ++i )
+    delete cons[i];
+
+  CPPUNIT_ASSERT_EQUAL( Items, (unsigned) latencies.size() );
+
+  nth_element( latencies.begin(), latencies.begin() + (Items / 2), latencies.end() );
+  double p50 = latencies[Items / 2];
+  nth_element( latencies.begin(), latencies.begin() + (Items * 99 / 100), latencies.end() );
+  double p99 = latencies[Items * 99 / 100];
+
+  cout << "  " << setw( 13 ) << name << "  " << producers << " x " << consumers << "  "
+       << setw( 10 ) << unsigned( Items / elapsed ) << "  "
+       << setw( 8 ) << unsigned( p50 * 1e6 ) << "  " << setw( 8 ) << unsigned( p99 * 1e6 ) << endl;
+}
+
+
+void QueueBench::testQueue( void )
+{
+  Queue<double> queue;
+  run( "Queue", queue );
+}
+
+void QueueBench::testSizedQueue( void )
+{
+  SizedQueue<double> queue( Capacity );
+  run( "SizedQueue", queue );
+}
+
+void QueueBench::testPriorityQueue( void )
+{
+  PriorityQueue<double> queue;
+  run( "PriorityQueue", queue );
+}
+
+void QueueBench::testRingQueue( void )
+{
+  RingQueue<double> queue( Capacity );
+  run( "RingQueue", queue );
+}
+
+//! SPSCQueue only supports one producer and one consumer.
+void QueueBench::testSPSCQueue( void )
+{
+  SPSCQueue<double> queue( Capacity );
+  header( "SPSCQueue" );
+  run( "SPSCQueue", queue, 1, 1 );
+}
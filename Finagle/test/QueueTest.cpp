@@ -19,7 +19,9 @@
 ** at http://www.gnu.org/copyleft/lesser.html .
 */
 
+#include <cstring>
 #include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Array.h>
 #include <Finagle/Queue.h>
 #include <Finagle/ThreadFunc.h>
 #include <Finagle/Util.h>
@@ -27,6 +29,45 @@
 using namespace std;
 using namespace Finagle;
 
+//! A heap buffer, which counts its allocations
+class Buffer {
+public:
+  static unsigned Allocs;
+
+  Buffer( unsigned size = 0 ) : _data( size ? new char[size] : 0 ), _size( size ) {  if ( size ) Allocs++;  }
+  Buffer( Buffer const &b ) : _data( 0 ), _size( 0 ) {  *this = b;  }
+ ~Buffer( void ) {  delete [] _data;  }
+
+  Buffer &operator =( Buffer const &b ) {
+    if ( &b == this )
+      return *this;
+    delete [] _data;
+    _size = b._size;
+    _data = _size ? new char[_size] : 0;
+    if ( _size ) {
+      Allocs++;
+      memcpy( _data, b._data, _size );
+    }
+    return *this;
+  }
+
+  void swap( Buffer &b ) {  std::swap( _data, b._data );  std::swap( _size, b._size );  }
+  unsigned size( void ) const {  return _size;  }
+
+protected:
+  char *_data;
+  unsigned _size;
+};
+
+unsigned Buffer::Allocs = 0;
+
+inline void swap( Buffer &a, Buffer &b ) {  a.swap( b );  }
+
+namespace Finagle {
+  //! Buffers are popped by swapping, rather than copying
+  template <> struct QueueSwaps<Buffer> {  static const bool value = true;  };
+}
+
 class QueueTest : public CppUnit::TestFixture
 {
   CPPUNIT_TEST_SUITE( QueueTest );
@@ -35,6 +76,9 @@ class QueueTest : public CppUnit::TestFixture
   CPPUNIT_TEST( testPushPop );
   CPPUNIT_TEST( testSynchronize );
   CPPUNIT_TEST( testThreadFill );
+  CPPUNIT_TEST( testBatch );
+  CPPUNIT_TEST( testSwap );
+  CPPUNIT_TEST( testSwapString );
 //  CPPUNIT_TEST( testCoprocess );
   CPPUNIT_TEST_SUITE_END();
 
@@ -47,6 +91,9 @@ public:
   void testPushPop( void );
   void testSynchronize( void );
   void testThreadFill( void );
+  void testBatch( void );
+  void testSwap( void );
+  void testSwapString( void );
 
   void testCoprocess( void );
 
@@ -181,3 +228,65 @@ void QueueTest::testCoprocess( void )
   CPPUNIT_ASSERT( _squared->empty() );
 }
 
+
+void QueueTest::testBatch( void )
+{
+  Array<unsigned> src, dest;
+  for ( unsigned i = 0; i < 10; ++i )
+    src.push_back( i );
+
+  _queue->push_range( src.begin(), src.end() );
+  CPPUNIT_ASSERT_EQUAL( 10U, _queue->size() );
+
+  CPPUNIT_ASSERT_EQUAL( 4U, _queue->pop_up_to( 4, dest ) );
+  CPPUNIT_ASSERT_EQUAL( 6U, _queue->pop_all( dest ) );
+  CPPUNIT_ASSERT( _queue->empty() );
+  CPPUNIT_ASSERT( dest == src );
+
+  CPPUNIT_ASSERT_EQUAL( 0U, _queue->pop_all( dest ) );
+  CPPUNIT_ASSERT_EQUAL( 0U, _queue->pop_up_to( 4, dest, 0.01 ) );
+  CPPUNIT_ASSERT_EQUAL( (size_t) 10, dest.size() );
+}
+
+
+//! Checks that swapping items in and out of the queue doesn't copy them.
+void QueueTest::testSwap( void )
+{
+  static const unsigned NumItems = 100000, ItemSize = 1024;
+
+  Queue<Buffer> buffers;
+  Buffer b;
+
+  Buffer::Allocs = 0;
+  for ( unsigned i = 0; i < NumItems; ++i ) {
+    b = Buffer( ItemSize );
+    buffers.push_back( b );
+    CPPUNIT_ASSERT( buffers.pop_front( b ) );
+  }
+  unsigned copyAllocs = Buffer::Allocs;
+
+  Buffer::Allocs = 0;
+  for ( unsigned i = 0; i < NumItems; ++i ) {
+    Buffer fresh( ItemSize );
+    buffers.push_back_swap( fresh );
+    CPPUNIT_ASSERT_EQUAL( 0U, fresh.size() );
+    CPPUNIT_ASSERT( buffers.pop_front( b ) );
+    CPPUNIT_ASSERT_EQUAL( ItemSize, b.size() );
+  }
+  CPPUNIT_ASSERT_EQUAL( NumItems, Buffer::Allocs );
+  CPPUNIT_ASSERT( copyAllocs > Buffer::Allocs );
+}
+
+
+//! Checks that a String is popped by swapping, so the popped string is the very buffer that was queued.
+void QueueTest::testSwapString( void )
+{
+  Queue<String> strings;
+  String item( 256U, 'x' ), dest;
+
+  char const *queued = item.data();
+  strings.push_back_swap( item );
+  CPPUNIT_ASSERT( strings.pop_front( dest ) );
+  CPPUNIT_ASSERT( dest.data() == queued );
+  CPPUNIT_ASSERT_EQUAL( String( 256U, 'x' ), dest );
+}
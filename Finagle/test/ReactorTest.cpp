@@ -0,0 +1,215 @@
+/*!
+** \file ReactorTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include <cstdlib>
+#include <unistd.h>
+#include <boost/bind.hpp>
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/AppLoop.h>
+#include <Finagle/FileDescWatcher.h>
+
+using namespace std;
+using namespace Finagle;
+
+class ReactorTest : public CppUnit::TestFixture, public boost::signals::trackable {
+  CPPUNIT_TEST_SUITE( ReactorTest );
+  CPPUNIT_TEST( testEnable );
+  CPPUNIT_TEST( testReadable );
+  CPPUNIT_TEST( testOnlyReady );
+  CPPUNIT_TEST( testDisconnect );
+  CPPUNIT_TEST( testManyDescriptors );
+  CPPUNIT_TEST( testDuplicate );
+  CPPUNIT_TEST( testRegularFile );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp( void );
+  void tearDown( void );
+
+  void testEnable( void );
+  void testReadable( void );
+  void testOnlyReady( void );
+  void testDisconnect( void );
+  void testManyDescriptors( void );
+  void testDuplicate( void );
+  void testRegularFile( void );
+
+protected:
+  void onReadable( int fd );
+  void onFileReadable( int fd );
+
+protected:
+  static const unsigned NumPipes = 32;
+  int _pipes[NumPipes][2];
+  FileDescWatcher::Ptr _watchers[NumPipes];
+  unsigned _reads;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ReactorTest );
+
+
+void ReactorTest::setUp( void )
+{
+  _reads = 0;
+  for ( unsigned i = 0; i < NumPipes; ++i ) {
+    CPPUNIT_ASSERT_EQUAL( 0, pipe( _pipes[i] ) );
+    _watchers[i] = new FileDescWatcher( _pipes[i][0] );
+  }
+}
+
+void ReactorTest::tearDown( void )
+{
+  for ( unsigned i = 0; i < NumPipes; ++i ) {
+    _watchers[i] = 0;
+    close( _pipes[i][0] );
+    close( _pipes[i][1] );
+  }
+}
+
+
+void ReactorTest::onReadable( int fd )
+{
+  char c;
+  CPPUNIT_ASSERT_EQUAL( 1, (int) read( fd, &c, 1 ) );
+  _reads++;
+}
+
+
+//! Reads a byte (or the end of the file) from a regular file.
+void ReactorTest::onFileReadable( int fd )
+{
+  char c;
+  CPPUNIT_ASSERT( read( fd, &c, 1 ) != -1 );
+  _reads++;
+}
+
+
+void ReactorTest::testEnable( void )
+{
+  CPPUNIT_ASSERT( _watchers[0]->enabled() );
+
+  _watchers[0]->disable();
+  CPPUNIT_ASSERT( !_watchers[0]->enabled() );
+
+  _watchers[0]->enable();
+  CPPUNIT_ASSERT( _watchers[0]->enabled() );
+
+  _watchers[0]->fd( -1 );
+  CPPUNIT_ASSERT( !_watchers[0]->enabled() );
+}
+
+
+void ReactorTest::testReadable( void )
+{
+  _watchers[0]->readable.connect( boost::bind( &ReactorTest::onReadable, this, _pipes[0][0] ) );
+
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT_EQUAL( 0U, _reads );
+
+  CPPUNIT_ASSERT_EQUAL( 1, (int) write( _pipes[0][1], "x", 1 ) );
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT_EQUAL( 1U, _reads );
+}
+
+
+void ReactorTest::testOnlyReady( void )
+{
+  for ( unsigned i = 0; i < NumPipes; ++i )
+    _watchers[i]->readable.connect( boost::bind( &ReactorTest::onReadable, this, _pipes[i][0] ) );
+
+  // Only the written pipe should be notified (a spurious notification would block in read()).
+  CPPUNIT_ASSERT_EQUAL( 1, (int) write( _pipes[NumPipes / 2][1], "x", 1 ) );
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT_EQUAL( 1U, _reads );
+}
+
+
+void ReactorTest::testDisconnect( void )
+{
+  boost::signals::connection conn = _watchers[0]->readable.connect( boost::bind( &ReactorTest::onReadable, this, _pipes[0][0] ) );
+  conn.disconnect();
+
+  // Pipe is readable, but nobody is listening, so it should be dropped from the interest set.
+  CPPUNIT_ASSERT_EQUAL( 1, (int) write( _pipes[0][1], "x", 1 ) );
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT_EQUAL( 0U, _reads );
+
+  _watchers[0]->readable.connect( boost::bind( &ReactorTest::onReadable, this, _pipes[0][0] ) );
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT_EQUAL( 1U, _reads );
+}
+
+
+void ReactorTest::testManyDescriptors( void )
+{
+  for ( unsigned i = 0; i < NumPipes; ++i ) {
+    _watchers[i]->readable.connect( boost::bind( &ReactorTest::onReadable, this, _pipes[i][0] ) );
+    CPPUNIT_ASSERT_EQUAL( 1, (int) write( _pipes[i][1], "x", 1 ) );
+  }
+
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT_EQUAL( (unsigned) NumPipes, _reads );
+}
+
+
+//! Checks that a second watcher for the same descriptor is refused, rather than silently never notified.
+void ReactorTest::testDuplicate( void )
+{
+  _watchers[0]->readable.connect( boost::bind( &ReactorTest::onReadable, this, _pipes[0][0] ) );
+
+  FileDescWatcher::Ptr dup = new FileDescWatcher( _pipes[0][0] );
+  CPPUNIT_ASSERT_THROW( dup->readable.connect( boost::bind( &ReactorTest::onReadable, this, _pipes[0][0] ) ), SystemEx );
+  CPPUNIT_ASSERT( dup->readable.empty() );  // the failed connection was undone
+  dup = 0;
+
+  // The first still works
+  CPPUNIT_ASSERT_EQUAL( 1, (int) write( _pipes[0][1], "x", 1 ) );
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT_EQUAL( 1U, _reads );
+}
+
+
+//! Checks that a regular file (which \c epoll(7) refuses) can be watched, and is always readable, as with \c select(2).
+void ReactorTest::testRegularFile( void )
+{
+  char path[] = "/tmp/ReactorTestXXXXXX";
+  int fd = mkstemp( path );
+  CPPUNIT_ASSERT( fd != -1 );
+  unlink( path );
+  CPPUNIT_ASSERT_EQUAL( 2, (int) write( fd, "xy", 2 ) );
+  CPPUNIT_ASSERT_EQUAL( 0, (int) lseek( fd, 0, SEEK_SET ) );
+
+  {
+    FileDescWatcher::Ptr file = new FileDescWatcher( fd );
+    file->readable.connect( boost::bind( &ReactorTest::onFileReadable, this, fd ) );
+    CPPUNIT_ASSERT( file->enabled() );
+
+    // Notified on every iteration, even at the end of the file
+    AppLoop::process( 0.01 );
+    CPPUNIT_ASSERT( _reads > 2 );
+  }
+
+  // Once it's gone, nothing is notified
+  unsigned reads = _reads;
+  AppLoop::process( 0.01 );
+  CPPUNIT_ASSERT_EQUAL( reads, _reads );
+  close( fd );
+}
@@ -0,0 +1,239 @@
+/*!
+** \file RingQueueTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Array.h>
+#include <Finagle/RingQueue.h>
+#include <Finagle/ThreadFunc.h>
+#include <Finagle/Util.h>
+
+using namespace std;
+using namespace Finagle;
+
+class RingQueueTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE( RingQueueTest );
+  CPPUNIT_TEST( testCapacity );
+  CPPUNIT_TEST( testPushPop );
+  CPPUNIT_TEST( testTimeout );
+  CPPUNIT_TEST( testSynchronize );
+  CPPUNIT_TEST( testContention );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp( void );
+  void tearDown( void );
+
+  void testCapacity( void );
+  void testPushPop( void );
+  void testTimeout( void );
+  void testSynchronize( void );
+  void testContention( void );
+
+protected:
+  void enqueue( void );
+
+  template <typename QueueType>
+  static void pump( QueueType &queue, unsigned producers, unsigned consumers, unsigned items );
+
+protected:
+  static const unsigned QueueSize;
+  RingQueue<unsigned> *_queue;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( RingQueueTest );
+
+const unsigned RingQueueTest::QueueSize = 128;
+
+
+//! Pushes \a items values (from \c 1) onto a queue.
+template <typename QueueType>
+class Producer : public Thread {
+public:
+  Producer( QueueType &queue, unsigned items ) : _queue( queue ), _items( items ) {}
+ ~Producer( void ) {  stop();  }
+
+protected:
+  int exec( void ) {
+    for ( unsigned i = 1; i <= _items; ++i )
+      _queue.push_back( i );
+    return 0;
+  }
+
+protected:
+  QueueType &_queue;
+  unsigned _items;
+};
+
+//! Pops \a items values from a queue, and adds them up (waiting for each with a timeout).
+template <typename QueueType>
+class Consumer : public Thread {
+public:
+  Consumer( QueueType &queue, unsigned items ) : sum( 0 ), _queue( queue ), _items( items ) {}
+ ~Consumer( void ) {  stop();  }
+
+  unsigned long sum;
+
+protected:
+  int exec( void ) {
+    unsigned v;
+    for ( unsigned i = 0; i < _items; ++i ) {
+      while ( !_queue.pop_front( v, 0.01 ) )
+        ;
+      sum += v;
+    }
+    return 0;
+  }
+
+protected:
+  QueueType &_queue;
+  unsigned _items;
+};
+
+
+void RingQueueTest::setUp( void )
+{
+  CPPUNIT_ASSERT_NO_THROW( _queue = new RingQueue<unsigned>( QueueSize ) );
+}
+
+
+void RingQueueTest::tearDown( void )
+{
+  CPPUNIT_ASSERT_NO_THROW( delete _queue );
+  _queue = 0;
+}
+
+
+void RingQueueTest::enqueue( void )
+{
+  sleep( 0.1 ); // Give parent thread a chance to block on the queue before we push to it.
+  CPPUNIT_ASSERT_NO_THROW( _queue->push_back( 42 ) );
+}
+
+
+/*! \brief Runs \a producers threads, each pushing \a items values through \a queue, and \a consumers threads popping them.
+**
+** Checks that every value was popped exactly once.
+*/
+template <typename QueueType>
+void RingQueueTest::pump( QueueType &queue, unsigned producers, unsigned consumers, unsigned items )
+{
+  Array<Thread *> threads;
+  Array<Consumer<QueueType> *> sums;
+  for ( unsigned i = 0; i < consumers; ++i ) {
+    sums.push_back( new Consumer<QueueType>( queue, (producers * items) / consumers ) );
+    threads.push_back( sums.back() );
+  }
+  for ( unsigned i = 0; i < producers; ++i )
+    threads.push_back( new Producer<QueueType>( queue, items ) );
+
+  for ( unsigned i = 0; i < threads.size(); ++i )
+    threads[i]->start();
+  for ( unsigned i = 0; i < threads.size(); ++i )
+    threads[i]->join();
+
+  unsigned long sum = 0;
+  for ( unsigned i = 0; i < consumers; ++i )
+    sum += sums[i]->sum;
+  for ( unsigned i = 0; i < threads.size(); ++i )
+    delete threads[i];
+
+  CPPUNIT_ASSERT_EQUAL( (unsigned long) producers * items * (items + 1) / 2, sum );
+  CPPUNIT_ASSERT( queue.empty() );
+}
+
+
+void RingQueueTest::testCapacity( void )
+{
+  CPPUNIT_ASSERT_EQUAL( QueueSize, _queue->capacity() );
+  CPPUNIT_ASSERT_EQUAL( 128U, RingQueue<unsigned>( 100 ).capacity() );
+  CPPUNIT_ASSERT_EQUAL( 2U, RingQueue<unsigned>( 0 ).capacity() );
+}
+
+
+void RingQueueTest::testPushPop( void )
+{
+  CPPUNIT_ASSERT( _queue->empty() );
+
+  for ( unsigned i = 0; i < QueueSize; ++i ) {
+    CPPUNIT_ASSERT_EQUAL( i, _queue->size() );
+    CPPUNIT_ASSERT( _queue->tryPush( i ) );
+  }
+  CPPUNIT_ASSERT( _queue->full() );
+  CPPUNIT_ASSERT( !_queue->tryPush( QueueSize ) );
+
+  // Wrap around the ring a few times
+  unsigned v;
+  for ( unsigned i = 0; i < QueueSize * 3; ++i ) {
+    CPPUNIT_ASSERT( _queue->tryPop( v ) );
+    CPPUNIT_ASSERT_EQUAL( i, v );
+    CPPUNIT_ASSERT( _queue->tryPush( i + QueueSize ) );
+  }
+
+  for ( unsigned i = QueueSize; i > 0; --i ) {
+    CPPUNIT_ASSERT_EQUAL( i, _queue->size() );
+    CPPUNIT_ASSERT_EQUAL( QueueSize * 4 - i, _queue->pop_front() );
+  }
+
+  CPPUNIT_ASSERT( _queue->empty() );
+  CPPUNIT_ASSERT( !_queue->tryPop( v ) );
+}
+
+
+void RingQueueTest::testTimeout( void )
+{
+  unsigned v;
+  CPPUNIT_ASSERT( !_queue->pop_front( v ) );
+
+  Time start = Time::now();
+  CPPUNIT_ASSERT( !_queue->pop_front( v, 0.05 ) );
+  CPPUNIT_ASSERT( (Time::now() - start) >= 0.05 );
+
+  while ( _queue->tryPush( 0 ) )
+    ;
+
+  start = Time::now();
+  CPPUNIT_ASSERT( !_queue->push_back( 1, 0.05 ) );
+  CPPUNIT_ASSERT( (Time::now() - start) >= 0.05 );
+}
+
+
+void RingQueueTest::testSynchronize( void )
+{
+  ClassFuncThread<RingQueueTest> enqueueThread( this, &RingQueueTest::enqueue );
+  CPPUNIT_ASSERT_NO_THROW( enqueueThread.start() );
+
+  unsigned v;
+  CPPUNIT_ASSERT_NO_THROW( v = _queue->pop_front() );
+  CPPUNIT_ASSERT_EQUAL( 42U, v );
+
+  CPPUNIT_ASSERT_NO_THROW( enqueueThread.join() );
+  CPPUNIT_ASSERT( _queue->empty() );
+}
+
+
+//! Pumps items through the (small) queue, with several producers and consumers contending for it.
+void RingQueueTest::testContention( void )
+{
+  pump( *_queue, 4, 4, 100000 );
+}
+
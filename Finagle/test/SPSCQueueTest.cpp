@@ -0,0 +1,224 @@
+/*!
+** \file SPSCQueueTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Array.h>
+#include <Finagle/SPSCQueue.h>
+#include <Finagle/ThreadFunc.h>
+
+using namespace std;
+using namespace Finagle;
+
+class SPSCQueueTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE( SPSCQueueTest );
+  CPPUNIT_TEST( testPushPop );
+  CPPUNIT_TEST( testStage );
+  CPPUNIT_TEST( testPopAll );
+  CPPUNIT_TEST( testPipeline );
+  CPPUNIT_TEST( testWakeup );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp( void );
+  void tearDown( void );
+
+  void testPushPop( void );
+  void testStage( void );
+  void testPopAll( void );
+  void testPipeline( void );
+  void testWakeup( void );
+
+protected:
+  void produce( void );
+  void echo( void );
+
+protected:
+  static const unsigned QueueSize;
+  static const unsigned Items;
+  static const unsigned BatchSize;
+
+  SPSCQueue<unsigned> *_queue;
+  SPSCQueue<unsigned> *_replies;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SPSCQueueTest );
+
+const unsigned SPSCQueueTest::QueueSize = 1024;
+const unsigned SPSCQueueTest::Items = 1000000;
+const unsigned SPSCQueueTest::BatchSize = 64;
+
+
+void SPSCQueueTest::setUp( void )
+{
+  CPPUNIT_ASSERT_NO_THROW( _queue = new SPSCQueue<unsigned>( QueueSize ) );
+}
+
+
+void SPSCQueueTest::tearDown( void )
+{
+  CPPUNIT_ASSERT_NO_THROW( delete _queue );
+  _queue = 0;
+}
+
+
+//! Pushes #Items values (from \c 0) in batches of #BatchSize.
+void SPSCQueueTest::produce( void )
+{
+  for ( unsigned i = 0; i < Items; ++i ) {
+    if ( !_queue->stage( i ) )
+      _queue->push_back( i );
+    else if ( (i % BatchSize) == (BatchSize - 1) )
+      _queue->publish();
+  }
+  _queue->publish();
+}
+
+
+//! Pops values (until \c 0), and pushes each one back onto #_replies.
+void SPSCQueueTest::echo( void )
+{
+  unsigned v;
+  do {
+    v = _queue->pop_front();
+    _replies->push_back( v );
+  } while ( v );
+}
+
+
+
+void SPSCQueueTest::testPushPop( void )
+{
+  CPPUNIT_ASSERT( _queue->empty() );
+
+  for ( unsigned i = 0; i < QueueSize; ++i )
+    CPPUNIT_ASSERT( _queue->tryPush( i ) );
+  CPPUNIT_ASSERT( _queue->full() );
+  CPPUNIT_ASSERT( !_queue->tryPush( QueueSize ) );
+  CPPUNIT_ASSERT( !_queue->push_back( QueueSize, 0.01 ) );
+
+  // Wrap around the ring a few times
+  unsigned v;
+  for ( unsigned i = 0; i < QueueSize * 3; ++i ) {
+    CPPUNIT_ASSERT( _queue->tryPop( v ) );
+    CPPUNIT_ASSERT_EQUAL( i, v );
+    CPPUNIT_ASSERT( _queue->tryPush( i + QueueSize ) );
+  }
+
+  for ( unsigned i = QueueSize; i > 0; --i ) {
+    CPPUNIT_ASSERT_EQUAL( i, _queue->size() );
+    CPPUNIT_ASSERT_EQUAL( QueueSize * 4 - i, _queue->pop_front() );
+  }
+
+  CPPUNIT_ASSERT( _queue->empty() );
+  CPPUNIT_ASSERT( !_queue->pop_front( v, 0.01 ) );
+}
+
+
+//! Checks that staged items aren't visible until they're published.
+void SPSCQueueTest::testStage( void )
+{
+  unsigned v;
+  CPPUNIT_ASSERT( _queue->stage( 1 ) );
+  CPPUNIT_ASSERT( _queue->stage( 2 ) );
+  CPPUNIT_ASSERT( _queue->empty() );
+  CPPUNIT_ASSERT( !_queue->tryPop( v ) );
+
+  _queue->publish();
+  CPPUNIT_ASSERT_EQUAL( 2U, _queue->size() );
+  CPPUNIT_ASSERT_EQUAL( 1U, _queue->pop_front() );
+  CPPUNIT_ASSERT_EQUAL( 2U, _queue->pop_front() );
+
+  // Staging into a full queue publishes what's already staged
+  for ( unsigned i = 0; i < QueueSize; ++i )
+    CPPUNIT_ASSERT( _queue->stage( i ) );
+  CPPUNIT_ASSERT( !_queue->stage( QueueSize ) );
+  CPPUNIT_ASSERT_EQUAL( QueueSize, _queue->size() );
+}
+
+
+void SPSCQueueTest::testPopAll( void )
+{
+  Array<unsigned> batch;
+  CPPUNIT_ASSERT_EQUAL( 0U, _queue->popAll( batch ) );
+
+  for ( unsigned i = 0; i < 10; ++i )
+    _queue->tryPush( i );
+
+  CPPUNIT_ASSERT_EQUAL( 10U, _queue->popAll( batch ) );
+  CPPUNIT_ASSERT_EQUAL( (size_t) 10, batch.size() );
+  for ( unsigned i = 0; i < 10; ++i )
+    CPPUNIT_ASSERT_EQUAL( i, batch[i] );
+
+  CPPUNIT_ASSERT( _queue->empty() );
+  CPPUNIT_ASSERT( _queue->tryPush( 10 ) );
+  CPPUNIT_ASSERT_EQUAL( 10U, _queue->pop_front() );
+}
+
+
+//! Streams items from a producer thread, in batches, and checks that they arrive in order.
+void SPSCQueueTest::testPipeline( void )
+{
+  Array<unsigned> batch;
+  batch.reserve( QueueSize );
+
+  ClassFuncThread<SPSCQueueTest> producer( this, &SPSCQueueTest::produce );
+  producer.start();
+
+  unsigned next = 0, v;
+  while ( next < Items ) {
+    batch.clear();
+    if ( !_queue->popAll( batch ) ) {
+      CPPUNIT_ASSERT( _queue->pop_front( v, 1.0 ) );
+      batch.push_back( v );
+    }
+
+    for ( unsigned i = 0; i < batch.size(); ++i, ++next )
+      if ( batch[i] != next )
+        CPPUNIT_ASSERT_EQUAL( next, batch[i] );
+  }
+  producer.join();
+  CPPUNIT_ASSERT( _queue->empty() );
+}
+
+
+//! Bounces values between two threads, so that each side parks (and must be woken) on almost every round trip.
+void SPSCQueueTest::testWakeup( void )
+{
+  SPSCQueue<unsigned> replies( QueueSize );
+  _replies = &replies;
+
+  ClassFuncThread<SPSCQueueTest> echoer( this, &SPSCQueueTest::echo );
+  echoer.start();
+
+  unsigned v;
+  for ( unsigned i = 10000; i > 0; --i ) {
+    _queue->push_back( i );
+    CPPUNIT_ASSERT( replies.pop_front( v, 1.0 ) );
+    CPPUNIT_ASSERT_EQUAL( i, v );
+  }
+
+  _queue->push_back( 0 );
+  CPPUNIT_ASSERT( replies.pop_front( v, 1.0 ) );
+  echoer.join();
+  _replies = 0;
+}
@@ -0,0 +1,120 @@
+/*!
+** \file SignalWatcherTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include <pthread.h>
+#include <boost/bind.hpp>
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/SignalWatcher.h>
+#include <Finagle/ThreadFunc.h>
+#include <Finagle/Util.h>
+
+using namespace std;
+using namespace Finagle;
+
+class SignalWatcherTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE( SignalWatcherTest );
+  CPPUNIT_TEST( testReceive );
+  CPPUNIT_TEST( testWakeup );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp( void );
+
+  void testReceive( void );
+  void testWakeup( void );
+
+protected:
+  void onSignal( int signum );
+  void sendLater( void );
+
+protected:
+  Array<int> _received;
+  Time _sentAt, _receivedAt;
+  pthread_t _thread;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SignalWatcherTest );
+
+
+void SignalWatcherTest::setUp( void )
+{
+  _received.clear();
+  _sentAt = _receivedAt = 0.0;
+  _thread = pthread_self();
+}
+
+
+void SignalWatcherTest::onSignal( int signum )
+{
+  _received.push_back( signum );
+  _receivedAt = Time::now();
+}
+
+
+//! Signals the test's thread, after a short delay.
+void SignalWatcherTest::sendLater( void )
+{
+  sleep( 0.02 );
+  _sentAt = Time::now();
+  pthread_kill( _thread, SIGUSR1 );
+}
+
+
+void SignalWatcherTest::testReceive( void )
+{
+  SignalWatcher::Ptr signals = new SignalWatcher;
+  signals->received.connect( boost::bind( &SignalWatcherTest::onSignal, this, _1 ) );
+
+  signals->watch( SIGUSR1 );
+  signals->watch( SIGUSR2 );
+  CPPUNIT_ASSERT( signals->watching( SIGUSR1 ) );
+  CPPUNIT_ASSERT( !signals->watching( SIGHUP ) );
+
+  pthread_kill( pthread_self(), SIGUSR1 );
+  pthread_kill( pthread_self(), SIGUSR2 );
+  AppLoop::process( 0.01 );
+
+  CPPUNIT_ASSERT_EQUAL( (size_t) 2, _received.size() );
+  CPPUNIT_ASSERT_EQUAL( (int) SIGUSR1, _received[0] );
+  CPPUNIT_ASSERT_EQUAL( (int) SIGUSR2, _received[1] );
+
+  signals->unwatch( SIGUSR2 );
+  CPPUNIT_ASSERT( !signals->watching( SIGUSR2 ) );
+}
+
+
+//! A signal wakes a waiting loop immediately, rather than at the end of its wait.
+void SignalWatcherTest::testWakeup( void )
+{
+  SignalWatcher::Ptr signals = new SignalWatcher;
+  signals->received.connect( boost::bind( &SignalWatcherTest::onSignal, this, _1 ) );
+  signals->watch( SIGUSR1 );
+
+  ClassFuncThread<SignalWatcherTest> sender( this, &SignalWatcherTest::sendLater );
+  sender.start();
+
+  Time start = Time::now();
+  while ( _received.empty() && ((Time::now() - start) < 1.0) )
+    AppLoop::process( 0.5 );
+
+  CPPUNIT_ASSERT_EQUAL( (size_t) 1, _received.size() );
+  CPPUNIT_ASSERT( (_receivedAt - _sentAt) < 0.25 );  // well before the 0.5 sec wait would have ended
+}
@@ -21,6 +21,7 @@
 
 #include <iostream>
 #include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Array.h>
 #include <Finagle/SizedQueue.h>
 #include <Finagle/ThreadFunc.h>
 #include <Finagle/Util.h>
@@ -33,6 +34,7 @@ class SizedQueueTest : public CppUnit::TestFixture
   CPPUNIT_TEST_SUITE( SizedQueueTest );
 //  CPPUNIT_TEST( testCreateDestroy );
   CPPUNIT_TEST( testPush );
+  CPPUNIT_TEST( testBatch );
 //  CPPUNIT_TEST( testPushPop );
 //  CPPUNIT_TEST( testSynchronize );
 //  CPPUNIT_TEST( testThreadFill );
@@ -44,6 +46,7 @@ public:
 
   void testCreateDestroy( void );
   void testPush( void );
+  void testBatch( void );
   void testPushPop( void );
   void testSynchronize( void );
   void testThreadFill( void );
@@ -157,3 +160,23 @@ void SizedQueueTest::testThreadFill( void )
   CPPUNIT_ASSERT( _queue->empty() );
 }
 
+
+void SizedQueueTest::testBatch( void )
+{
+  Array<unsigned> src, dest;
+  for ( unsigned i = 0; i < QueueSize / 2; ++i )
+    src.push_back( i );
+
+  _queue->push_range( src.begin(), src.end() );
+  _queue->push_range( src.begin(), src.end() );
+  CPPUNIT_ASSERT( _queue->full() );
+
+  CPPUNIT_ASSERT_EQUAL( QueueSize / 2, _queue->pop_up_to( QueueSize / 2, dest ) );
+  CPPUNIT_ASSERT( !_queue->full() );
+  CPPUNIT_ASSERT( dest == src );
+
+  dest.clear();
+  CPPUNIT_ASSERT_EQUAL( QueueSize / 2, _queue->pop_all( dest ) );
+  CPPUNIT_ASSERT( _queue->empty() );
+  CPPUNIT_ASSERT( dest == src );
+}
@@ -0,0 +1,245 @@
+/*!
+** \file ThreadPoolTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+
+#include <set>
+#include <sched.h>
+#include <stdexcept>
+#include <cppunit/extensions/HelperMacros.h>
+#include <boost/bind.hpp>
+#include <Finagle/ThreadFunc.h>
+#include <Finagle/ThreadPool.h>
+#include <Finagle/Util.h>
+
+using namespace std;
+using namespace Finagle;
+
+class ThreadPoolTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE( ThreadPoolTest );
+  CPPUNIT_TEST( testSubmit );
+  CPPUNIT_TEST( testFailure );
+  CPPUNIT_TEST( testSteal );
+  CPPUNIT_TEST( testShutdown );
+  CPPUNIT_TEST( testShutdownRace );
+  CPPUNIT_TEST( testPinned );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testSubmit( void );
+  void testFailure( void );
+  void testSteal( void );
+  void testShutdown( void );
+  void testShutdownRace( void );
+  void testPinned( void );
+
+protected:
+  static unsigned square( unsigned v );
+  static String placement( void );
+  static unsigned fail( void );
+  void count( void );
+  void record( void );
+  unsigned spawn( ThreadPool *pool, unsigned tasks );
+  void postUntilClosed( void );
+
+protected:
+  Mutex _guard;
+  unsigned _count;
+  ThreadPool *_pool;
+  unsigned _accepted;
+  set<Thread::ID> _threads;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ThreadPoolTest );
+
+
+unsigned ThreadPoolTest::square( unsigned v )
+{
+  return v * v;
+}
+
+//! Returns the calling thread's name and CPU (e.g. \c "pool worker 0@3").
+String ThreadPoolTest::placement( void )
+{
+  char name[16] = "";
+  pthread_getname_np( pthread_self(), name, sizeof(name) );
+  return String( name ) + "@" + String( sched_getcpu() );
+}
+
+unsigned ThreadPoolTest::fail( void )
+{
+  throw runtime_error( "failed" );
+}
+
+void ThreadPoolTest::count( void )
+{
+  Lock _( _guard );
+  _count++;
+}
+
+//! Records the thread running it, after giving other workers time to steal.
+void ThreadPoolTest::record( void )
+{
+  sleep( 0.001 );
+
+  Lock _( _guard );
+  _threads.insert( Thread::self_id() );
+}
+
+//! Submits \a tasks subtasks from within a worker, and waits for them.
+unsigned ThreadPoolTest::spawn( ThreadPool *pool, unsigned tasks )
+{
+  CPPUNIT_ASSERT( ThreadPool::current() == pool );
+
+  Array<Future<void> > subtasks;
+  for ( unsigned i = 0; i < tasks; ++i )
+    subtasks.push_back( pool->submit( boost::bind( &ThreadPoolTest::record, this ) ) );
+
+  for ( unsigned i = 0; i < tasks; ++i )
+    subtasks[i].get();
+
+  return tasks;
+}
+
+
+void ThreadPoolTest::testSubmit( void )
+{
+  ThreadPool pool( 4 );
+  CPPUNIT_ASSERT_EQUAL( 4U, pool.size() );
+  CPPUNIT_ASSERT( !ThreadPool::current() );
+  CPPUNIT_ASSERT( ThreadPool().size() >= 1 );
+
+  Array<Future<unsigned> > results;
+  for ( unsigned i = 0; i < 1000; ++i )
+    results.push_back( pool.submit( boost::bind( &ThreadPoolTest::square, i ) ) );
+
+  for ( unsigned i = 0; i < 1000; ++i ) {
+    CPPUNIT_ASSERT_EQUAL( i * i, results[i].get() );
+    CPPUNIT_ASSERT( results[i].ready() );
+    CPPUNIT_ASSERT( !results[i].failed() );
+  }
+
+  _count = 0;
+  Future<void> done = pool.submit( boost::bind( &ThreadPoolTest::count, this ) );
+  CPPUNIT_ASSERT( done.wait( 5.0 ) );
+  CPPUNIT_ASSERT_EQUAL( 1U, _count );
+}
+
+
+void ThreadPoolTest::testFailure( void )
+{
+  ThreadPool pool( 2 );
+
+  Future<unsigned> failed = pool.submit( &ThreadPoolTest::fail );
+  CPPUNIT_ASSERT_THROW( failed.get(), Exception );
+  CPPUNIT_ASSERT( failed.failed() );
+  CPPUNIT_ASSERT_EQUAL( String( "failed" ), failed.error() );
+
+  // The worker survives
+  CPPUNIT_ASSERT_EQUAL( 49U, pool.submit( boost::bind( &ThreadPoolTest::square, 7 ) ).get() );
+}
+
+
+//! Checks that subtasks submitted from one worker are stolen by the others.
+void ThreadPoolTest::testSteal( void )
+{
+  ThreadPool pool( 4 );
+
+  Future<unsigned> spawned = pool.submit( boost::bind( &ThreadPoolTest::spawn, this, &pool, 200 ) );
+  CPPUNIT_ASSERT_EQUAL( 200U, spawned.get() );
+  CPPUNIT_ASSERT( _threads.size() > 1 );
+}
+
+
+//! Checks that shutting down runs the tasks already submitted, then refuses more.
+void ThreadPoolTest::testShutdown( void )
+{
+  _count = 0;
+  {
+    ThreadPool pool( 3 );
+    for ( unsigned i = 0; i < 10000; ++i )
+      pool.post( boost::bind( &ThreadPoolTest::count, this ) );
+
+    pool.shutdown();
+    CPPUNIT_ASSERT( pool.closed() );
+    CPPUNIT_ASSERT_EQUAL( 10000U, _count );
+    CPPUNIT_ASSERT_THROW( pool.post( boost::bind( &ThreadPoolTest::count, this ) ), ThreadPool::ClosedEx );
+  }
+
+  // Destroying the pool shuts it down too
+  _count = 0;
+  {
+    ThreadPool pool( 2 );
+    for ( unsigned i = 0; i < 1000; ++i )
+      pool.post( boost::bind( &ThreadPoolTest::count, this ) );
+  }
+  CPPUNIT_ASSERT_EQUAL( 1000U, _count );
+}
+
+
+//! Posts counting tasks to #_pool until it's shut down, counting those it accepts.
+void ThreadPoolTest::postUntilClosed( void )
+{
+  try {
+    while ( true ) {
+      _pool->post( boost::bind( &ThreadPoolTest::count, this ) );
+      _accepted++;
+    }
+  }
+  catch ( ThreadPool::ClosedEx & ) {}
+}
+
+//! Checks that every task accepted while the pool is being shut down still runs.
+void ThreadPoolTest::testShutdownRace( void )
+{
+  for ( unsigned i = 0; i < 20; ++i ) {
+    _count = _accepted = 0;
+    ThreadPool pool( 2 );
+    _pool = &pool;
+
+    ClassFuncThread<ThreadPoolTest> poster( this, &ThreadPoolTest::postUntilClosed );
+    poster.start();
+    sleep( 0.001 );
+    pool.shutdown();
+    poster.join();
+
+    CPPUNIT_ASSERT_EQUAL( _accepted, _count );
+  }
+  _pool = 0;
+}
+
+
+//! Checks that a pinned pool's workers are named, and each confined to its own CPU.
+void ThreadPoolTest::testPinned( void )
+{
+  Array<unsigned> cpus = Thread::cpus();
+  ThreadPool pool( 2, true );
+
+  set<String> seen;
+  for ( unsigned i = 0; i < 100; ++i )
+    seen.insert( pool.submit( &ThreadPoolTest::placement ).get() );
+
+  for ( set<String>::const_iterator p = seen.begin(); p != seen.end(); ++p ) {
+    unsigned worker = atoi( p->substr( 12 ).c_str() ), cpu = atoi( p->substr( p->find( '@' ) + 1 ).c_str() );
+    CPPUNIT_ASSERT( p->beginsWith( "pool worker " ) );
+    CPPUNIT_ASSERT( worker < 2 );
+    CPPUNIT_ASSERT_EQUAL( cpus[worker % cpus.size()], cpu );
+  }
+}
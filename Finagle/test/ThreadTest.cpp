@@ -20,6 +20,8 @@
 */
 
 #include <iostream>
+#include <set>
+#include <sched.h>
 #include <cppunit/extensions/HelperMacros.h>
 #include <Finagle/Queue.h>
 #include <Finagle/Thread.h>
@@ -35,6 +37,9 @@ class ThreadTest : public CppUnit::TestFixture
   CPPUNIT_TEST( testCreateDestroy );
   CPPUNIT_TEST( testClassThreadFunc );
   CPPUNIT_TEST( testStop );
+  CPPUNIT_TEST( testCPUs );
+  CPPUNIT_TEST( testOptions );
+  CPPUNIT_TEST( testStartFailure );
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -44,6 +49,9 @@ public:
   void testCreateDestroy( void );
   void testClassThreadFunc( void );
   void testStop( void );
+  void testCPUs( void );
+  void testOptions( void );
+  void testStartFailure( void );
 
 protected:
   int _count;
@@ -57,6 +65,36 @@ protected:
 
 CPPUNIT_TEST_SUITE_REGISTRATION( ThreadTest );
 
+//! Records its name, CPUs and stack size, as seen from inside the thread
+class Inspector : public Thread {
+public:
+  Inspector( Thread::Options const &options ) : Thread( options ), stackSize( 0 ) {}
+
+protected:
+  int exec( void ) {
+    char buf[16] = "";
+    pthread_getname_np( pthread_self(), buf, sizeof(buf) );
+    name = buf;
+
+    cpu_set_t set;
+    sched_getaffinity( 0, sizeof(set), &set );
+    for ( unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+      if ( CPU_ISSET( cpu, &set ) )
+        cpus.push_back( cpu );
+
+    pthread_attr_t attr;
+    pthread_getattr_np( pthread_self(), &attr );
+    pthread_attr_getstacksize( &attr, &stackSize );
+    pthread_attr_destroy( &attr );
+    return 0;
+  }
+
+public:
+  String name;
+  Array<unsigned> cpus;
+  size_t stackSize;
+};
+
 void ThreadTest::setUp( void )
 {
   CPPUNIT_ASSERT_NO_THROW( _wait = new Mutex );
@@ -139,3 +177,59 @@ void ThreadTest::testStop( void )
   CPPUNIT_ASSERT_NO_THROW( delete _wait );
   _wait = 0;
 }
+
+
+void ThreadTest::testCPUs( void )
+{
+  Array<unsigned> cpus = Thread::cpus();
+  CPPUNIT_ASSERT( !cpus.empty() );
+  CPPUNIT_ASSERT_EQUAL( cpus.size(), set<unsigned>( cpus.begin(), cpus.end() ).size() );
+
+  // Each thread of a set gets its own CPU, wrapping around
+  CPPUNIT_ASSERT_EQUAL( cpus[0], Thread::Options::forCore( 0 ).cpus.front() );
+  CPPUNIT_ASSERT_EQUAL( cpus[0], Thread::Options::forCore( cpus.size() ).cpus.front() );
+  CPPUNIT_ASSERT_EQUAL( cpus.back(), Thread::Options::forCore( cpus.size() - 1 ).cpus.front() );
+}
+
+
+void ThreadTest::testOptions( void )
+{
+  Thread::Options opts = Thread::Options::forCore( 0 );
+  opts.name = "finagle test thread";
+  opts.stackSize = 1 << 20;
+  opts.policy = SCHED_OTHER;
+  if ( !Thread::nodeCPUs( 0 ).empty() )
+    opts.numaNode = 0;
+
+  Inspector t( opts );
+  CPPUNIT_ASSERT_NO_THROW( t.start() );
+  t.join();
+
+  CPPUNIT_ASSERT_EQUAL( String( "finagle test th" ), t.name );  // truncated to 15 characters
+  CPPUNIT_ASSERT_EQUAL( size_t( 1 ), t.cpus.size() );
+  CPPUNIT_ASSERT_EQUAL( opts.cpus.front(), t.cpus.front() );
+  CPPUNIT_ASSERT( t.stackSize >= opts.stackSize );
+}
+
+
+void ThreadTest::testStartFailure( void )
+{
+  // Only a CPU which isn't there, so the thread can't be placed anywhere
+  Thread::Options opts;
+  opts.cpus.push_back( CPU_SETSIZE - 1 );
+
+  _count = 0;
+  ClassFuncThread<ThreadTest> t( this, &ThreadTest::eternalWait );
+  t.setOptions( opts );
+  CPPUNIT_ASSERT_THROW( t.start(), PThreadEx );
+  CPPUNIT_ASSERT( !t.running() );
+  CPPUNIT_ASSERT_EQUAL( -1, t.join() );
+  CPPUNIT_ASSERT_NO_THROW( t.stop() );
+
+  // ... and it can still be started, once given somewhere to run
+  t.setOptions( Thread::Options() );
+  CPPUNIT_ASSERT_NO_THROW( t.start() );
+  CPPUNIT_ASSERT( t.running() );
+  CPPUNIT_ASSERT_NO_THROW( t.stop() );
+  CPPUNIT_ASSERT_EQUAL( 1, _count );
+}
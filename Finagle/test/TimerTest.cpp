@@ -0,0 +1,306 @@
+/*!
+** \file TimerTest.cpp
+** \author Steve Sloan <steve@finagle.org>
+** \date Fri Oct 16 2026
+** Copyright (C) 2026 by Steve Sloan
+**
+** This library is free software; you can redistribute it and/or modify it
+** under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; if not, you may access it via the web
+** at http://www.gnu.org/copyleft/lesser.html .
+*/
+
+#include <cmath>
+#include <boost/bind.hpp>
+#include <cppunit/extensions/HelperMacros.h>
+#include <Finagle/Timer.h>
+
+using namespace std;
+using namespace Finagle;
+
+class TimerTest : public CppUnit::TestFixture, public boost::signals::trackable {
+  CPPUNIT_TEST_SUITE( TimerTest );
+  CPPUNIT_TEST( testSingleShot );
+  CPPUNIT_TEST( testRecurring );
+  CPPUNIT_TEST( testStop );
+  CPPUNIT_TEST( testOrder );
+  CPPUNIT_TEST( testWheel );
+  CPPUNIT_TEST( testManyTimers );
+  CPPUNIT_TEST( testSlack );
+  CPPUNIT_TEST( testCoalesced );
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp( void );
+
+  void testSingleShot( void );
+  void testRecurring( void );
+  void testStop( void );
+  void testOrder( void );
+  void testWheel( void );
+  void testManyTimers( void );
+  void testSlack( void );
+  void testCoalesced( void );
+
+protected:
+  void onAlarm( unsigned id );
+  void processUntil( Time end );
+
+protected:
+  Array<unsigned> _fired;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TimerTest );
+
+
+//! A timer with a fixed alarm time, for driving a TimerWheel directly.
+class WheelTimer : public Timer {
+public:
+  typedef ObjectPtr<WheelTimer> Ptr;
+
+  WheelTimer( Time alarm, Time slack = 0.0 ) : Timer( 0.0, false )
+  {
+    // Unschedule from the application loop, without letting it release the last reference.
+    ref();
+    stop();
+    deref();
+    _nextAlarm = alarm;
+    _slack = slack;
+  }
+};
+
+
+void TimerTest::setUp( void )
+{
+  _fired.clear();
+}
+
+
+void TimerTest::onAlarm( unsigned id )
+{
+  _fired.push_back( id );
+}
+
+
+void TimerTest::processUntil( Time end )
+{
+  for ( Time now = Time::now(); now < end; now = Time::now() )
+    AppLoop::process( end - now );
+}
+
+
+void TimerTest::testSingleShot( void )
+{
+  Time start = Time::now();
+  Timer::Ptr timer = Timer::SingleShot( 0.02 );
+  timer->connect( boost::bind( &TimerTest::onAlarm, this, 1 ) );
+  CPPUNIT_ASSERT( timer->isRunning() );
+
+  processUntil( start + 0.01 );
+  CPPUNIT_ASSERT( _fired.empty() );
+
+  processUntil( start + 0.05 );
+  CPPUNIT_ASSERT_EQUAL( 1U, (unsigned) _fired.size() );
+  CPPUNIT_ASSERT( !timer->isRunning() );
+}
+
+
+void TimerTest::testRecurring( void )
+{
+  Time start = Time::now();
+  Timer::Ptr timer = Timer::Recurring( 0.01 );
+  timer->connect( boost::bind( &TimerTest::onAlarm, this, 1 ) );
+
+  processUntil( start + 0.055 );
+  timer->stop();
+  CPPUNIT_ASSERT_EQUAL( 5U, (unsigned) _fired.size() );
+}
+
+
+void TimerTest::testStop( void )
+{
+  Time start = Time::now();
+  Timer::Ptr timer = Timer::SingleShot( 0.01 );
+  timer->connect( boost::bind( &TimerTest::onAlarm, this, 1 ) );
+
+  timer->stop();
+  CPPUNIT_ASSERT( !timer->isRunning() );
+  processUntil( start + 0.02 );
+  CPPUNIT_ASSERT( _fired.empty() );
+
+  timer->start();
+  processUntil( start + 0.04 );
+  CPPUNIT_ASSERT_EQUAL( 1U, (unsigned) _fired.size() );
+}
+
+
+void TimerTest::testOrder( void )
+{
+  static const unsigned NumTimers = 8;
+
+  Time start = Time::now();
+  Timer::Ptr timers[NumTimers];
+  for ( unsigned i = 0; i < NumTimers; ++i ) {
+    // Scheduled in reverse, spanning several wheel levels
+    timers[i] = Timer::SingleShot( 0.001 + 0.0003 * (1 << (NumTimers - i)) );
+    timers[i]->connect( boost::bind( &TimerTest::onAlarm, this, NumTimers - i ) );
+  }
+
+  processUntil( start + 0.1 );
+  CPPUNIT_ASSERT_EQUAL( NumTimers, (unsigned) _fired.size() );
+  for ( unsigned i = 0; i < NumTimers; ++i )
+    CPPUNIT_ASSERT_EQUAL( i + 1, _fired[i] );
+}
+
+
+//! Drives a wheel through simulated time, checking that timers are never early or out of order.
+void TimerTest::testWheel( void )
+{
+  static const unsigned NumTimers = 10000;
+
+  Time base = 1000000.0;
+  TimerWheel wheel( base );
+  Array<WheelTimer::Ptr> timers;
+
+  srand( 1 );
+  for ( unsigned i = 0; i < NumTimers; ++i ) {
+    // Spread out over ~1 day, so that every level of the wheel (and the overflow slot) is used.
+    Time alarm = base + ((rand() % 86400000) / 1000.0) + ((rand() % 1000) / 1e6);
+    timers.push_back( new WheelTimer( alarm ) );
+    wheel.insert( timers.back() );
+  }
+
+  for ( unsigned i = 0; i < NumTimers; i += 2 )
+    wheel.remove( timers[i] );
+  CPPUNIT_ASSERT_EQUAL( NumTimers / 2, wheel.size() );
+
+  Time now = base, last = base;
+  unsigned fired = 0;
+  while ( !wheel.empty() ) {
+    Time next = wheel.nextAlarm();
+    CPPUNIT_ASSERT( next >= now );
+    now = next;
+
+    while ( Timer::Ptr timer = wheel.popExpired( now ) ) {
+      CPPUNIT_ASSERT( timer->nextAlarm() <= now );
+      CPPUNIT_ASSERT( timer->nextAlarm() >= last );
+      last = timer->nextAlarm();
+      fired++;
+    }
+  }
+
+  CPPUNIT_ASSERT_EQUAL( NumTimers / 2, fired );
+}
+
+
+//! Schedules and cancels a large number of timers, as with per-connection timeouts, then fires them, many per slot.
+void TimerTest::testManyTimers( void )
+{
+  static const unsigned NumTimers = 100000;
+
+  Array<Timer::Ptr> timers;
+  timers.reserve( NumTimers );
+
+  for ( unsigned i = 0; i < NumTimers; ++i )
+    timers.push_back( Timer::SingleShot( 1.0 + (i % 1000) * 0.01 ) );
+
+  for ( unsigned i = 0; i < NumTimers; ++i )
+    timers[i]->restart();
+
+  for ( unsigned i = 0; i < NumTimers; ++i )
+    timers[i]->stop();
+
+  CPPUNIT_ASSERT( AppLoop::Timers().empty() );
+  timers.clear();
+
+  // Ten thousand timers in each of ten slots, with different alarms within each slot
+  Time start = Time::now();
+  for ( unsigned i = 0; i < NumTimers; ++i ) {
+    timers.push_back( Timer::SingleShot( 0.002 + (i % 10) * 0.001 + (i % 1000) * 0.0000009 ) );
+    timers.back()->connect( boost::bind( &TimerTest::onAlarm, this, i ) );
+  }
+
+  processUntil( start + 0.5 );
+  CPPUNIT_ASSERT_EQUAL( NumTimers, (unsigned) _fired.size() );
+  CPPUNIT_ASSERT( AppLoop::Timers().empty() );
+}
+
+
+//! Checks that timers with slack fire within their window, in far fewer wakeups, and that others stay precise.
+void TimerTest::testSlack( void )
+{
+  static const unsigned NumTimers = 1000;
+
+  Time base = 1000000.0;
+  TimerWheel wheel( base );
+  Array<WheelTimer::Ptr> timers;
+  Array<Time> alarms;
+
+  srand( 1 );
+  for ( unsigned i = 0; i < NumTimers; ++i ) {
+    // Due over half a second, each with a second's slack (as with connection timeouts)
+    alarms.push_back( base + ((rand() % 500000) / 1e6) );
+    timers.push_back( new WheelTimer( alarms.back(), 1.0 ) );
+    wheel.insert( timers.back() );
+  }
+
+  Time preciseAlarm = base + 0.1234;
+  WheelTimer::Ptr precise = new WheelTimer( preciseAlarm );
+  wheel.insert( precise );
+  CPPUNIT_ASSERT_EQUAL( NumTimers, wheel.stats().deferred );
+
+  Array<char> fired( NumTimers, false );
+  bool stop = false;
+  while ( !wheel.empty() ) {
+    Time now = wheel.nextAlarm();
+    bool preciseDue = wheel.contains( precise );
+    wheel.trigger( now, stop );
+
+    for ( unsigned i = 0; i < NumTimers; ++i ) {
+      if ( fired[i] || wheel.contains( timers[i] ) )
+        continue;
+      fired[i] = true;
+
+      // Fired no earlier than the alarm, and no later than the slack allows
+      CPPUNIT_ASSERT( now >= alarms[i] );
+      CPPUNIT_ASSERT( now <= (alarms[i] + 1.0) );
+    }
+
+    if ( preciseDue && !wheel.contains( precise ) )
+      CPPUNIT_ASSERT( fabs( now - preciseAlarm ) < 1e-6 );
+  }
+
+  CPPUNIT_ASSERT_EQUAL( NumTimers + 1, wheel.stats().fired );
+  CPPUNIT_ASSERT( wheel.stats().wakeups <= 3 );
+}
+
+
+//! Checks that the loop fires a group of timers with slack together.
+void TimerTest::testCoalesced( void )
+{
+  static const unsigned NumTimers = 10;
+
+  AppLoop::Timers().resetStats();
+
+  Time start = Time::now();
+  Timer::Ptr timers[NumTimers];
+  for ( unsigned i = 0; i < NumTimers; ++i ) {
+    timers[i] = Timer::SingleShot( 0.01 + 0.001 * i );
+    timers[i]->setSlack( 0.05 );
+    timers[i]->connect( boost::bind( &TimerTest::onAlarm, this, i ) );
+  }
+
+  processUntil( start + 0.1 );
+  CPPUNIT_ASSERT_EQUAL( NumTimers, (unsigned) _fired.size() );
+  CPPUNIT_ASSERT_EQUAL( NumTimers, AppLoop::Timers().stats().fired );
+  CPPUNIT_ASSERT( AppLoop::Timers().stats().wakeups <= 2 );
+}
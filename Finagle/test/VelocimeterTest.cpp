@@ -32,11 +32,13 @@ class VelocimeterTest : public CppUnit::TestFixture
   CPPUNIT_TEST_SUITE( VelocimeterTest );
 //  CPPUNIT_TEST( testRate );
   CPPUNIT_TEST( testLimit );
+  CPPUNIT_TEST( testVirtualRate );
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testRate( void );
   void testLimit( void );
+  void testVirtualRate( void );
 };
 
 
@@ -66,3 +68,24 @@ void VelocimeterTest::testLimit( void )
 
   CPPUNIT_ASSERT_DOUBLES_EQUAL( limit, v.rate(), 0.1 );
 }
+
+
+//! As testRate(), but in simulated time (so it's both fast and exact).
+void VelocimeterTest::testVirtualRate( void )
+{
+  VirtualClock clock;
+  Velocimeter v( 0.1, clock );
+  for ( unsigned i = 0; i < 10; ++i ) {
+    v += 1;
+    clock.advance( 0.1 );
+  }
+
+  CPPUNIT_ASSERT_DOUBLES_EQUAL( 10.0, v.rate(), 0.1 );
+
+  // An increment at the same instant as the last is counted with the next one
+  v += 1;
+  v += 1;
+  clock.advance( 0.1 );
+  v += 0;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL( 10.0, v.rate(), 0.1 );
+}